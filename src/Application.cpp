@@ -33,11 +33,13 @@
 #include <KLocalizedString>
 
 // Konsole
+#include "Emulation.h"
 #include "SessionManager.h"
 #include "ProfileManager.h"
 #include "MainWindow.h"
 #include "Session.h"
 #include "ShellCommand.h"
+#include "StartupTrace.h"
 #include "KonsoleSettings.h"
 #include "ViewManager.h"
 #include "SessionController.h"
@@ -104,6 +106,9 @@ void Application::populateCommandLineParser(QCommandLineParser *parser)
         { { QStringLiteral("list-profiles") },
             i18nc("@info:shell", "List the available profiles")
         },
+        { { QStringLiteral("startup-trace") },
+            i18nc("@info:shell", "Print the time spent in each phase of starting up once the first session has produced output")
+        },
         { { QStringLiteral("list-profile-properties") },
             i18nc("@info:shell", "List all the profile properties names and their type (for use with -p)")
         },
@@ -209,8 +214,14 @@ int Application::newInstance()
         return 0;
     }
 
+    // read the default profile before the window is created, so that the
+    // time spent on it can be told apart
+    ProfileManager::instance();
+    StartupTrace::phaseFinished("default profile");
+
     // create a new window or use an existing one
     MainWindow *window = processWindowArgs(createdNewMainWindow);
+    StartupTrace::phaseFinished("main window");
 
     if (m_parser->isSet(QStringLiteral("tabs-from-file"))) {
         // create new session(s) as described in file
@@ -226,8 +237,21 @@ int Application::newInstance()
     // selected profile to be changed
     Profile::Ptr newProfile = processProfileChangeArgs(baseProfile);
 
+    StartupTrace::phaseFinished("profile arguments");
+
     // create new session
     Session *session = window->createSession(newProfile, QString());
+    StartupTrace::phaseFinished("session");
+
+    if (StartupTrace::isEnabled()) {
+        auto connection = QSharedPointer<QMetaObject::Connection>::create();
+        *connection = connect(session->emulation(), &Konsole::Emulation::outputChanged, this,
+                              [connection]() {
+                                  QObject::disconnect(*connection);
+                                  StartupTrace::phaseFinished("first output");
+                                  StartupTrace::report();
+                              });
+    }
 
     if (m_parser->isSet(QStringLiteral("noclose"))) {
         session->setAutoClose(false);
@@ -259,6 +283,7 @@ int Application::newInstance()
             window->show();
         }
     }
+    StartupTrace::phaseFinished("window shown");
 
     return 1;
 }
@@ -292,7 +317,7 @@ bool Application::processTabsFromFileArgs(MainWindow *window)
         return false;
     }
 
-    unsigned int sessions = 0;
+    QList<Session *> sessions;
     while (!tabsFile.atEnd()) {
         QString lineString(QString::fromUtf8(tabsFile.readLine()).trimmed());
         if ((lineString.isEmpty()) || (lineString[0] == QLatin1Char('#'))) {
@@ -310,24 +335,31 @@ bool Application::processTabsFromFileArgs(MainWindow *window)
         // should contain at least one of 'command' and 'profile'
         if (lineTokens.contains(QStringLiteral("command"))
             || lineTokens.contains(QStringLiteral("profile"))) {
-            createTabFromArgs(window, lineTokens);
-            sessions++;
+            sessions << createTabFromArgs(window, lineTokens);
         } else {
             qWarning() << "Each line should contain at least one of 'command' and 'profile'.";
         }
     }
     tabsFile.close();
 
-    if (sessions < 1) {
+    if (sessions.isEmpty()) {
         qWarning() << "No valid lines found in "
                    << tabsFileName.toLocal8Bit().data();
         return false;
     }
 
+    if (!window->testAttribute(Qt::WA_Resized)) {
+        window->resize(window->sizeHint());
+    }
+
+    // start the programs of all tabs together once the window is shown,
+    // instead of showing the window for each tab to get its session going
+    window->viewManager()->startSessionsLater(sessions);
+
     return true;
 }
 
-void Application::createTabFromArgs(MainWindow *window, const QHash<QString, QString> &tokens)
+Session *Application::createTabFromArgs(MainWindow *window, const QHash<QString, QString> &tokens)
 {
     const QString &title = tokens[QStringLiteral("title")];
     const QString &command = tokens[QStringLiteral("command")];
@@ -380,16 +412,7 @@ void Application::createTabFromArgs(MainWindow *window, const QHash<QString, QSt
         session->setAutoClose(false);
     }
 
-    if (!window->testAttribute(Qt::WA_Resized)) {
-        window->resize(window->sizeHint());
-    }
-
-    // FIXME: this ugly hack here is to make the session start running, so that
-    // its tab title is displayed as expected.
-    //
-    // This is another side effect of the commit fixing BKO 176902.
-    window->show();
-    window->hide();
+    return session;
 }
 
 // Creates a new Konsole window.
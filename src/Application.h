@@ -87,7 +87,7 @@ private:
     Profile::Ptr processProfileSelectArgs();
     Profile::Ptr processProfileChangeArgs(Profile::Ptr baseProfile);
     bool processTabsFromFileArgs(MainWindow *window);
-    void createTabFromArgs(MainWindow *window, const QHash<QString, QString> &);
+    Session *createTabFromArgs(MainWindow *window, const QHash<QString, QString> &);
     void finalizeNewMainWindow(MainWindow *window);
 
     MainWindow *_backgroundInstance;
@@ -198,6 +198,25 @@ inline bool Character::equalsFormat(const Character &other) const
            && foregroundColor == other.foregroundColor
            && rendition == other.rendition;
 }
+
+/**
+ * The cells and properties of one line of the history or the screen, as
+ * read by HistoryScroll::readLine() and Screen::readLine().
+ *
+ * Lines which are stored as Characters share their cells with the storage
+ * (QVector is implicitly shared), other lines are expanded into @p cells.
+ * Either way the line stays valid when the history or the screen changes
+ * afterwards, and there is no limit on its length.
+ */
+struct TerminalLine {
+    TerminalLine() :
+        properties(LINE_DEFAULT)
+    {
+    }
+
+    QVector<Character> cells;
+    LineProperty properties;
+};
 }
 Q_DECLARE_TYPEINFO(Konsole::Character, Q_MOVABLE_TYPE);
 
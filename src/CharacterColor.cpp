@@ -0,0 +1,65 @@
+/*
+    This file is part of Konsole, KDE's terminal.
+
+    Copyright 2007-2008 by Robert Knight <robertknight@gmail.com>
+    Copyright 1997,1998 by Lars Doelle <lars.doelle@on-line.de>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "CharacterColor.h"
+
+using namespace Konsole;
+
+// The following are almost IBM standard color codes, with some slight
+// gamma correction for the dim colors to compensate for bright X screens.
+// It contains the 8 ansiterm/xterm colors in 2 intensities.
+const ColorEntry Konsole::defaultColorTable[TABLE_COLORS] = {
+    ColorEntry(0x00, 0x00, 0x00), // Dfore
+    ColorEntry(0xFF, 0xFF, 0xFF), // Dback
+    ColorEntry(0x00, 0x00, 0x00), // Black
+    ColorEntry(0xB2, 0x18, 0x18), // Red
+    ColorEntry(0x18, 0xB2, 0x18), // Green
+    ColorEntry(0xB2, 0x68, 0x18), // Yellow
+    ColorEntry(0x18, 0x18, 0xB2), // Blue
+    ColorEntry(0xB2, 0x18, 0xB2), // Magenta
+    ColorEntry(0x18, 0xB2, 0xB2), // Cyan
+    ColorEntry(0xB2, 0xB2, 0xB2), // White
+    // intensive versions
+    ColorEntry(0x00, 0x00, 0x00),
+    ColorEntry(0xFF, 0xFF, 0xFF),
+    ColorEntry(0x68, 0x68, 0x68),
+    ColorEntry(0xFF, 0x54, 0x54),
+    ColorEntry(0x54, 0xFF, 0x54),
+    ColorEntry(0xFF, 0xFF, 0x54),
+    ColorEntry(0x54, 0x54, 0xFF),
+    ColorEntry(0xFF, 0x54, 0xFF),
+    ColorEntry(0x54, 0xFF, 0xFF),
+    ColorEntry(0xFF, 0xFF, 0xFF),
+    // Here are faint intensities, which may not be good.
+    // faint versions
+    ColorEntry(0x00, 0x00, 0x00),
+    ColorEntry(0xFF, 0xFF, 0xFF),
+    ColorEntry(0x00, 0x00, 0x00),
+    ColorEntry(0x65, 0x00, 0x00),
+    ColorEntry(0x00, 0x65, 0x00),
+    ColorEntry(0x65, 0x5E, 0x00),
+    ColorEntry(0x00, 0x00, 0x65),
+    ColorEntry(0x65, 0x00, 0x65),
+    ColorEntry(0x00, 0x65, 0x65),
+    ColorEntry(0x65, 0x65, 0x65)
+};
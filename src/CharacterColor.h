@@ -26,6 +26,9 @@
 // Qt
 #include <QColor>
 
+// Konsole
+#include "konsoleemulation_export.h"
+
 namespace Konsole {
 /**
  * An entry in a terminal display's color palette.
@@ -46,6 +49,16 @@ typedef QColor ColorEntry;
 #define DEFAULT_FORE_COLOR 0
 #define DEFAULT_BACK_COLOR 1
 
+// a palette holds the entries of a color table followed by the 256 indexed colors
+#define PALETTE_COLORS (TABLE_COLORS + 256)
+
+/**
+ * The default palette of TABLE_COLORS entries: black text on a white
+ * background followed by the normal, intense and faint versions of the
+ * eight system colors.
+ */
+KONSOLEEMULATION_EXPORT extern const ColorEntry defaultColorTable[TABLE_COLORS];
+
 /* CharacterColor is a union of the various color spaces.
 
    Assignment is as follows:
@@ -132,6 +145,19 @@ public:
         return _colorSpace != COLOR_SPACE_UNDEFINED;
     }
 
+    /** Returns the color space of this color, one of the COLOR_SPACE_* values */
+    quint8 colorSpace() const
+    {
+        return _colorSpace;
+    }
+
+    /**
+     * Returns the color value of this color in its colorSpace(), in the
+     * form passed to the constructor.  For default and system colors,
+     * bits 3 and 4 hold the intensity: 1 for intensive and 2 for faint.
+     */
+    int value() const;
+
     /**
      * Set this color as an intensive system color.
      *
@@ -156,6 +182,16 @@ public:
      */
     QColor color(const ColorEntry *base) const;
 
+    /**
+     * Returns the color within the specified @p palette, which has been
+     * filled from a color table with fillPalette().
+     *
+     * This gives the same color as color() without constructing a QColor,
+     * which makes it suitable for code which resolves the colors of many
+     * characters.
+     */
+    QRgb rgb(const QRgb *palette) const;
+
     /**
      * Compares two colors and returns true if they represent the same color value and
      * use the same color space.
@@ -215,6 +251,20 @@ inline const QColor color256(quint8 u, const ColorEntry *base)
     return QColor(gray, gray, gray);
 }
 
+/**
+ * Fills @p palette, which must have room for PALETTE_COLORS entries, with
+ * the colors of the color table @p base and the 256 indexed colors.
+ */
+inline void fillPalette(const ColorEntry *base, QRgb *palette)
+{
+    for (int i = 0; i < TABLE_COLORS; i++) {
+        palette[i] = base[i].rgba();
+    }
+    for (int i = 0; i < 256; i++) {
+        palette[TABLE_COLORS + i] = color256(i, base).rgba();
+    }
+}
+
 inline QColor CharacterColor::color(const ColorEntry *base) const
 {
     switch (_colorSpace) {
@@ -235,6 +285,41 @@ inline QColor CharacterColor::color(const ColorEntry *base) const
     return QColor();
 }
 
+inline QRgb CharacterColor::rgb(const QRgb *palette) const
+{
+    switch (_colorSpace) {
+    case COLOR_SPACE_DEFAULT:
+        return palette[_u + 0 + (_v * BASE_COLORS)];
+    case COLOR_SPACE_SYSTEM:
+        return palette[_u + 2 + (_v * BASE_COLORS)];
+    case COLOR_SPACE_256:
+        return palette[TABLE_COLORS + _u];
+    case COLOR_SPACE_RGB:
+        return qRgb(_u, _v, _w);
+    case COLOR_SPACE_UNDEFINED:
+        return 0;
+    }
+
+    Q_ASSERT(false); // invalid color space
+
+    return 0;
+}
+
+inline int CharacterColor::value() const
+{
+    switch (_colorSpace) {
+    case COLOR_SPACE_DEFAULT:
+    case COLOR_SPACE_SYSTEM:
+        return _u | (_v << 3);
+    case COLOR_SPACE_256:
+        return _u;
+    case COLOR_SPACE_RGB:
+        return (_u << 16) | (_v << 8) | _w;
+    }
+
+    return 0;
+}
+
 inline void CharacterColor::setIntensive()
 {
     if (_colorSpace == COLOR_SPACE_SYSTEM || _colorSpace == COLOR_SPACE_DEFAULT) {
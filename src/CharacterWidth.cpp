@@ -30,8 +30,8 @@
 //
 
 #include "CharacterWidth.h"
-#include "konsoledebug.h"
-#include "konsoleprivate_export.h"
+#include "konsoleemulationdebug.h"
+#include "konsoleemulation_export.h"
 
 
 struct Range {
@@ -136,7 +136,7 @@ static constexpr const RangeLut RANGE_LUT_LIST[] = {
 static constexpr const int RANGE_LUT_LIST_SIZE = 4;
 
 
-int KONSOLEPRIVATE_EXPORT characterWidth(uint ucs4) {
+int KONSOLEEMULATION_EXPORT characterWidth(uint ucs4) {
     if(Q_LIKELY(ucs4 < sizeof(DIRECT_LUT))) {
         return DIRECT_LUT[ucs4];
     }
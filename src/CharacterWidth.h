@@ -3,6 +3,8 @@
 
 #include <QtGlobal>
 
-int characterWidth(uint ucs4);
+#include "konsoleemulation_export.h"
+
+KONSOLEEMULATION_EXPORT int characterWidth(uint ucs4);
 
 #endif
@@ -23,6 +23,7 @@
 #include "ColorScheme.h"
 
 // Qt
+#include <QDataStream>
 #include <QPainter>
 
 // KDE
@@ -40,44 +41,9 @@ const int BGCOLOR_INDEX = 1;
 
 using namespace Konsole;
 
-// The following are almost IBM standard color codes, with some slight
-// gamma correction for the dim colors to compensate for bright X screens.
-// It contains the 8 ansiterm/xterm colors in 2 intensities.
-const ColorEntry ColorScheme::defaultTable[TABLE_COLORS] = {
-    ColorEntry(0x00, 0x00, 0x00), // Dfore
-    ColorEntry(0xFF, 0xFF, 0xFF), // Dback
-    ColorEntry(0x00, 0x00, 0x00), // Black
-    ColorEntry(0xB2, 0x18, 0x18), // Red
-    ColorEntry(0x18, 0xB2, 0x18), // Green
-    ColorEntry(0xB2, 0x68, 0x18), // Yellow
-    ColorEntry(0x18, 0x18, 0xB2), // Blue
-    ColorEntry(0xB2, 0x18, 0xB2), // Magenta
-    ColorEntry(0x18, 0xB2, 0xB2), // Cyan
-    ColorEntry(0xB2, 0xB2, 0xB2), // White
-    // intensive versions
-    ColorEntry(0x00, 0x00, 0x00),
-    ColorEntry(0xFF, 0xFF, 0xFF),
-    ColorEntry(0x68, 0x68, 0x68),
-    ColorEntry(0xFF, 0x54, 0x54),
-    ColorEntry(0x54, 0xFF, 0x54),
-    ColorEntry(0xFF, 0xFF, 0x54),
-    ColorEntry(0x54, 0x54, 0xFF),
-    ColorEntry(0xFF, 0x54, 0xFF),
-    ColorEntry(0x54, 0xFF, 0xFF),
-    ColorEntry(0xFF, 0xFF, 0xFF),
-    // Here are faint intensities, which may not be good.
-    // faint versions
-    ColorEntry(0x00, 0x00, 0x00),
-    ColorEntry(0xFF, 0xFF, 0xFF),
-    ColorEntry(0x00, 0x00, 0x00),
-    ColorEntry(0x65, 0x00, 0x00),
-    ColorEntry(0x00, 0x65, 0x00),
-    ColorEntry(0x65, 0x5E, 0x00),
-    ColorEntry(0x00, 0x00, 0x65),
-    ColorEntry(0x65, 0x00, 0x65),
-    ColorEntry(0x00, 0x65, 0x65),
-    ColorEntry(0x65, 0x65, 0x65)
-};
+// the default color table lives with the emulation, so that decoders
+// can use it without depending on color scheme support
+const ColorEntry * const ColorScheme::defaultTable = defaultColorTable;
 
 const char * const ColorScheme::colorNames[TABLE_COLORS] = {
     "Foreground",
@@ -423,6 +389,36 @@ void ColorScheme::write(KConfig &config) const
     }
 }
 
+void ColorScheme::read(QDataStream &stream)
+{
+    QString wallpaper;
+    stream >> _description >> _opacity >> _blur >> wallpaper;
+    setWallpaper(wallpaper);
+
+    for (int i = 0; i < TABLE_COLORS; i++) {
+        ColorEntry entry;
+        quint16 hue = 0;
+        quint8 saturation = 0;
+        quint8 value = 0;
+        stream >> entry >> hue >> saturation >> value;
+
+        setColorTableEntry(i, entry);
+        if (hue != 0 || value != 0 || saturation != 0) {
+            setRandomizationRange(i, qMin(hue, quint16(MAX_HUE)), saturation, value);
+        }
+    }
+}
+
+void ColorScheme::write(QDataStream &stream) const
+{
+    stream << _description << _opacity << _blur << _wallpaper->path();
+
+    for (int i = 0; i < TABLE_COLORS; i++) {
+        const RandomizationRange random = _randomTable != nullptr ? _randomTable[i] : RandomizationRange();
+        stream << colorTable()[i] << random.hue << random.saturation << random.value;
+    }
+}
+
 void ColorScheme::writeColorEntry(KConfig &config, int index) const
 {
     KConfigGroup configGroup = config.group(colorNameForIndex(index));
@@ -30,6 +30,7 @@
 #include "CharacterColor.h"
 
 class KConfig;
+class QDataStream;
 class QPixmap;
 class QPainter;
 
@@ -95,6 +96,17 @@ public:
     /** Writes the color scheme to the specified configuration source */
     void write(KConfig &config) const;
 
+    /**
+     * Reads the color scheme from data written by write(QDataStream &).
+     * The name is not part of the data.
+     */
+    void read(QDataStream &stream);
+    /**
+     * Writes the color scheme in a binary format, which is used to cache
+     * color schemes between sessions.
+     */
+    void write(QDataStream &stream) const;
+
     /** Sets a single entry within the color palette. */
     void setColorTableEntry(int index, const ColorEntry &entry);
 
@@ -179,7 +191,7 @@ public:
     /** Returns true if the background color is randomized. */
     bool randomizedBackgroundColor() const;
 
-    static const ColorEntry defaultTable[]; // table of default color entries
+    static const ColorEntry * const defaultTable; // table of default color entries
 
     static QString colorNameForIndex(int index);
     static QString translatedColorNameForIndex(int index);
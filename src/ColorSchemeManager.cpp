@@ -26,6 +26,7 @@
 #include "konsoledebug.h"
 
 // Qt
+#include <QDataStream>
 #include <QIODevice>
 #include <QFileInfo>
 #include <QFile>
@@ -36,9 +37,13 @@
 
 using namespace Konsole;
 
+// to be increased when the format of the cached color schemes changes
+static const quint32 COLORSCHEME_CACHE_VERSION = 1;
+
 ColorSchemeManager::ColorSchemeManager() :
     _colorSchemes(QHash<QString, const ColorScheme *>()),
-    _haveLoadedAll(false)
+    _haveLoadedAll(false),
+    _cache(QStringLiteral("colorschemes"), COLORSCHEME_CACHE_VERSION)
 {
 }
 
@@ -92,10 +97,8 @@ bool ColorSchemeManager::loadColorScheme(const QString &filePath)
 
     auto name = colorSchemeNameFromPath(filePath);
 
-    KConfig config(filePath, KConfig::NoGlobals);
-    auto scheme = new ColorScheme();
+    ColorScheme *scheme = readColorScheme(filePath);
     scheme->setName(name);
-    scheme->read(config);
 
     if (scheme->name().isEmpty()) {
         qCDebug(KonsoleDebug) << "Color scheme in" << filePath
@@ -116,6 +119,34 @@ bool ColorSchemeManager::loadColorScheme(const QString &filePath)
     return true;
 }
 
+ColorScheme *ColorSchemeManager::readColorScheme(const QString &filePath)
+{
+    const QByteArray cached = _cache.load(filePath);
+    if (!cached.isEmpty()) {
+        QDataStream stream(cached);
+        stream.setVersion(QDataStream::Qt_5_6);
+
+        auto scheme = new ColorScheme();
+        scheme->read(stream);
+        if (stream.status() == QDataStream::Ok) {
+            return scheme;
+        }
+        delete scheme;
+    }
+
+    KConfig config(filePath, KConfig::NoGlobals);
+    auto scheme = new ColorScheme();
+    scheme->read(config);
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+    scheme->write(stream);
+    _cache.save(filePath, data);
+
+    return scheme;
+}
+
 bool ColorSchemeManager::unloadColorScheme(const QString &filePath)
 {
     if (!pathIsColorScheme(filePath)) {
@@ -29,6 +29,7 @@
 
 // Konsole
 #include "ColorScheme.h"
+#include "ConfigCache.h"
 
 namespace Konsole {
 /**
@@ -120,11 +121,16 @@ private:
     QString findColorSchemePath(const QString &name) const;
     // @returns whether a path is a valid color scheme name
     static bool pathIsColorScheme(const QString &path);
+    // reads the color scheme at filePath from the cache if it is
+    // unchanged since it was cached, or parses and caches it otherwise
+    ColorScheme *readColorScheme(const QString &filePath);
 
     QHash<QString, const ColorScheme *> _colorSchemes;
 
     bool _haveLoadedAll;
 
+    ConfigCache _cache;
+
     static const ColorScheme _defaultColorScheme;
 
     Q_DISABLE_COPY(ColorSchemeManager)
@@ -0,0 +1,118 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "ConfigCache.h"
+
+#include "konsoledebug.h"
+
+// Qt
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace Konsole;
+
+namespace {
+// identifies the files written by ConfigCache::save()
+const quint32 CONFIG_CACHE_MAGIC = 0x4b434643;
+}
+
+ConfigCache::ConfigCache(const QString &directory, quint32 version) :
+    _directory(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+               + QStringLiteral("/konsole/") + directory),
+    _version(version)
+{
+}
+
+QString ConfigCache::cachePath(const QString &path) const
+{
+    // files with the same name in different data directories need
+    // separate caches, so the name is derived from the whole path
+    const QByteArray hash = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1);
+    return _directory + QLatin1Char('/') + QString::fromLatin1(hash.toHex()) + QStringLiteral(".cache");
+}
+
+QByteArray ConfigCache::load(const QString &path) const
+{
+    QFile cache(cachePath(path));
+    if (!cache.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString locale;
+    QString sourcePath;
+    qint64 sourceModified = 0;
+    qint64 sourceSize = 0;
+    stream >> magic >> version >> locale >> sourcePath >> sourceModified >> sourceSize;
+
+    const QFileInfo source(path);
+    if (stream.status() != QDataStream::Ok
+            || magic != CONFIG_CACHE_MAGIC || version != _version
+            || locale != QLocale().name()
+            || sourcePath != path
+            || sourceModified != source.lastModified().toMSecsSinceEpoch()
+            || sourceSize != source.size()) {
+        return QByteArray();
+    }
+
+    QByteArray data;
+    stream >> data;
+    if (stream.status() != QDataStream::Ok) {
+        qCDebug(KonsoleDebug) << "Ignoring damaged cache of" << path;
+        return QByteArray();
+    }
+
+    return data;
+}
+
+void ConfigCache::save(const QString &path, const QByteArray &data) const
+{
+    QDir().mkpath(_directory);
+
+    // several Konsole processes may save the same file at once, so the
+    // cache is replaced as a whole
+    QSaveFile cache(cachePath(path));
+    if (!cache.open(QIODevice::WriteOnly)) {
+        qCDebug(KonsoleDebug) << "Unable to cache" << path << cache.errorString();
+        return;
+    }
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    const QFileInfo source(path);
+    stream << CONFIG_CACHE_MAGIC << _version << QLocale().name() << path
+           << source.lastModified().toMSecsSinceEpoch() << source.size() << data;
+
+    if (!cache.commit()) {
+        qCDebug(KonsoleDebug) << "Unable to cache" << path << cache.errorString();
+    }
+}
@@ -0,0 +1,70 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef CONFIGCACHE_H
+#define CONFIGCACHE_H
+
+// Qt
+#include <QByteArray>
+#include <QString>
+
+// Konsole
+#include "konsoleprivate_export.h"
+
+namespace Konsole {
+/**
+ * Keeps binary copies of the settings parsed from configuration files,
+ * such as profiles and color schemes, in the user's cache directory.
+ *
+ * The data cached for a file is only returned while the file has the
+ * same time of last modification and size as when the data was saved,
+ * and while the locale is the same, since translated entries are read
+ * from the files.  What the data contains is up to the caller, who
+ * serializes it with QDataStream.
+ */
+class KONSOLEPRIVATE_EXPORT ConfigCache
+{
+public:
+    /**
+     * Constructs a cache for one kind of file, which is kept in the
+     * @p directory sub-directory of Konsole's cache directory.
+     *
+     * @param version The format of the cached data.  Data saved with a
+     * different version is ignored.
+     */
+    ConfigCache(const QString &directory, quint32 version);
+
+    /**
+     * Returns the data cached for the file at @p path, or an empty byte
+     * array if no data is cached or the file changed since it was saved.
+     */
+    QByteArray load(const QString &path) const;
+
+    /** Caches @p data for the file at @p path, replacing older data. */
+    void save(const QString &path, const QByteArray &data) const;
+
+private:
+    QString cachePath(const QString &path) const;
+
+    QString _directory;
+    quint32 _version;
+};
+}
+
+#endif // CONFIGCACHE_H
@@ -23,6 +23,7 @@
 #include "Emulation.h"
 
 // Qt
+#include <QElapsedTimer>
 #include <QKeyEvent>
 
 // Konsole
@@ -30,20 +31,30 @@
 #include "KeyboardTranslatorManager.h"
 #include "Screen.h"
 #include "ScreenWindow.h"
+#include "Tracer.h"
 
 using namespace Konsole;
 
+// number of lines of the selection passed to selectionChanged()
+static const int MAX_SELECTION_CHANGED_LINES = 1000;
+
 Emulation::Emulation() :
     _windows(QList<ScreenWindow *>()),
     _currentScreen(nullptr),
     _codec(nullptr),
     _decoder(nullptr),
     _keyTranslator(nullptr),
+    _suppressedMouseEvents(0),
     _usesMouseTracking(false),
     _bracketedPasteMode(false),
     _bulkTimer1(new QTimer(this)),
     _bulkTimer2(new QTimer(this)),
-    _imageSizeInitialized(false)
+    _imageSizeInitialized(false),
+    _readOnly(false),
+    _receivedBytes(0),
+    _decodedCodePoints(0),
+    _bulkUpdates(0),
+    _parseTime(0)
 {
     // create screens with a default size
     _screen[0] = new Screen(40, 80);
@@ -75,6 +86,67 @@ bool Emulation::programBracketedPasteMode() const
     return _bracketedPasteMode;
 }
 
+void Emulation::setReadOnly(bool readOnly)
+{
+    _readOnly = readOnly;
+}
+
+bool Emulation::isReadOnly() const
+{
+    return _readOnly;
+}
+
+quint64 Emulation::receivedBytes() const
+{
+    return _receivedBytes;
+}
+
+quint64 Emulation::decodedCodePoints() const
+{
+    return _decodedCodePoints;
+}
+
+quint64 Emulation::bulkUpdates() const
+{
+    return _bulkUpdates;
+}
+
+qint64 Emulation::parseTime() const
+{
+    return _parseTime;
+}
+
+quint64 Emulation::historyLinesAdded() const
+{
+    return _screen[0]->historyLinesAdded() + _screen[1]->historyLinesAdded();
+}
+
+qint64 Emulation::historyMemoryUsage() const
+{
+    return _screen[0]->historyMemoryUsage() + _screen[1]->historyMemoryUsage();
+}
+
+qint64 Emulation::historyDiskUsage() const
+{
+    return _screen[0]->historyDiskUsage() + _screen[1]->historyDiskUsage();
+}
+
+quint64 Emulation::suppressedMouseEvents() const
+{
+    return _suppressedMouseEvents;
+}
+
+void Emulation::resetStatistics()
+{
+    _receivedBytes = 0;
+    _decodedCodePoints = 0;
+    _bulkUpdates = 0;
+    _parseTime = 0;
+    _suppressedMouseEvents = 0;
+    _screen[0]->resetHistoryLinesAdded();
+    _screen[1]->resetHistoryLinesAdded();
+}
+
 void Emulation::bracketedPasteModeChanged(bool bracketedPasteMode)
 {
     _bracketedPasteMode = bracketedPasteMode;
@@ -103,7 +175,9 @@ void Emulation::checkScreenInUse()
 
 void Emulation::checkSelectedText()
 {
-    QString text = _currentScreen->selectedText(Screen::PreserveLineBreaks);
+    // this runs whenever the selection changes, so only the start of very
+    // large selections is decoded
+    QString text = _currentScreen->selectedText(Screen::PreserveLineBreaks, MAX_SELECTION_CHANGED_LINES);
     emit selectionChanged(text);
 }
 
@@ -123,6 +197,10 @@ void Emulation::setScreen(int index)
     Screen *oldScreen = _currentScreen;
     _currentScreen = _screen[index & 1];
     if (_currentScreen != oldScreen) {
+        // the inactive screen is only resized when it becomes active,
+        // see setImageSize()
+        _currentScreen->resizeImage(oldScreen->getLines(), oldScreen->getColumns());
+
         // tell all windows onto this emulation to switch to the newly active screen
         foreach (ScreenWindow *window, _windows) {
             window->setScreen(_currentScreen);
@@ -236,10 +314,15 @@ void Emulation::sendMouseEvent(int /*buttons*/, int /*column*/, int /*row*/, int
 
 void Emulation::receiveData(const char *text, int length)
 {
+    KONSOLE_TRACE_SCOPE("Emulation::receiveData");
+
     emit stateSet(NOTIFYACTIVITY);
 
     bufferedUpdate();
 
+    QElapsedTimer parseTimer;
+    parseTimer.start();
+
     QVector<uint> unicodeText = _decoder->toUnicode(text, length).toUcs4();
 
     //send characters to terminal emulator
@@ -247,6 +330,10 @@ void Emulation::receiveData(const char *text, int length)
         receiveChar(i);
     }
 
+    _receivedBytes += length;
+    _decodedCodePoints += unicodeText.size();
+    _parseTime += parseTimer.nsecsElapsed();
+
     //look for z-modem indicator
     //-- someone who understands more about z-modems that I do may be able to move
     //this check into the above for loop?
@@ -276,9 +363,12 @@ int Emulation::lineCount() const
 
 void Emulation::showBulk()
 {
+    KONSOLE_TRACE_SCOPE("Emulation::showBulk");
+
     _bulkTimer1.stop();
     _bulkTimer2.stop();
 
+    _bulkUpdates++;
     emit outputChanged();
 
     _currentScreen->resetScrolledLines();
@@ -290,6 +380,10 @@ void Emulation::bufferedUpdate()
     static const int BULK_TIMEOUT1 = 10;
     static const int BULK_TIMEOUT2 = 40;
 
+    // the screens changed, the windows have to take new snapshots
+    _screen[0]->discardSharedImages();
+    _screen[1]->discardSharedImages();
+
     _bulkTimer1.setSingleShot(true);
     _bulkTimer1.start(BULK_TIMEOUT1);
     if (!_bulkTimer2.isActive()) {
@@ -309,15 +403,14 @@ void Emulation::setImageSize(int lines, int columns)
         return;
     }
 
-    QSize screenSize[2] = {
-        QSize(_screen[0]->getColumns(),
-              _screen[0]->getLines()),
-        QSize(_screen[1]->getColumns(),
-              _screen[1]->getLines())
-    };
-    QSize newSize(columns, lines);
+    // only the active screen is resized, the other screen is resized when
+    // setScreen() switches to it.  Otherwise the screen which is not shown
+    // would be resized at each intermediate size while the view is resized,
+    // losing lines to the history each time it gets smaller
+    const QSize screenSize(_currentScreen->getColumns(), _currentScreen->getLines());
+    const QSize newSize(columns, lines);
 
-    if (newSize == screenSize[0] && newSize == screenSize[1]) {
+    if (newSize == screenSize) {
         // If this method is called for the first time, always emit
         // SIGNAL(imageSizeChange()), even if the new size is the same as the
         // current size.  See #176902
@@ -325,8 +418,7 @@ void Emulation::setImageSize(int lines, int columns)
             emit imageSizeChanged(lines, columns);
         }
     } else {
-        _screen[0]->resizeImage(lines, columns);
-        _screen[1]->resizeImage(lines, columns);
+        _currentScreen->resizeImage(lines, columns);
 
         emit imageSizeChanged(lines, columns);
 
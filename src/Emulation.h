@@ -30,7 +30,7 @@
 
 // Konsole
 #include "Enumeration.h"
-#include "konsoleprivate_export.h"
+#include "konsoleemulation_export.h"
 
 class QKeyEvent;
 
@@ -114,7 +114,7 @@ enum {
  * how long the emulation has been active/idle for and also respond to
  * a 'bell' event in different ways.
  */
-class KONSOLEPRIVATE_EXPORT Emulation : public QObject
+class KONSOLEEMULATION_EXPORT Emulation : public QObject
 {
     Q_OBJECT
 
@@ -221,9 +221,47 @@ public:
 
     bool programBracketedPasteMode() const;
 
+    /**
+     * Sets whether key presses are discarded instead of being
+     * translated and sent to the terminal program.
+     */
+    void setReadOnly(bool readOnly);
+
+    /** See setReadOnly() */
+    bool isReadOnly() const;
+
+    // Performance counters, covering the work done since the emulation
+    // was created or resetStatistics() was last called.
+
+    /** Returns the number of bytes passed to receiveData() */
+    quint64 receivedBytes() const;
+    /** Returns the number of unicode code points decoded from the received bytes */
+    quint64 decodedCodePoints() const;
+    /** Returns the number of times the views were told that the output changed */
+    quint64 bulkUpdates() const;
+    /** Returns the time spent in receiveData() decoding and parsing, in nanoseconds */
+    qint64 parseTime() const;
+    /** Returns the number of lines added to the history */
+    quint64 historyLinesAdded() const;
+    /** Returns the number of bytes of memory currently used by the history */
+    qint64 historyMemoryUsage() const;
+    /** Returns the number of bytes of disk space currently used by the history */
+    qint64 historyDiskUsage() const;
+    /**
+     * Returns the number of mouse motion events which were not reported
+     * to the terminal program, because the mouse did not move to another
+     * character cell or another motion followed within the same frame
+     */
+    quint64 suppressedMouseEvents() const;
+    /** Resets the performance counters to zero. */
+    void resetStatistics();
+
 public Q_SLOTS:
 
-    /** Change the size of the emulation's image */
+    /**
+     * Change the size of the emulation's image.  Only the active screen is
+     * resized right away, the other screen is resized when it becomes active.
+     */
     virtual void setImageSize(int lines, int columns);
 
     /**
@@ -424,7 +462,8 @@ Q_SIGNALS:
     void primaryScreenInUse(bool use);
 
     /**
-     * Emitted when the text selection is changed
+     * Emitted when the text selection is changed.  For very large
+     * selections, @p text only contains the first lines of the selection.
      */
     void selectionChanged(const QString &text);
 
@@ -488,6 +527,9 @@ protected:
     QTextDecoder *_decoder;
     const KeyboardTranslator *_keyTranslator; // the keyboard layout
 
+    // see suppressedMouseEvents()
+    quint64 _suppressedMouseEvents;
+
 protected Q_SLOTS:
     /**
      * Schedules an update of attached views.
@@ -519,6 +561,12 @@ private:
     QTimer _bulkTimer1;
     QTimer _bulkTimer2;
     bool _imageSizeInitialized;
+    bool _readOnly;
+
+    quint64 _receivedBytes;
+    quint64 _decodedCodePoints;
+    quint64 _bulkUpdates;
+    qint64 _parseTime;
 };
 }
 
@@ -22,18 +22,16 @@
 // Own
 #include "ExtendedCharTable.h"
 
-#include "konsoledebug.h"
+#include "konsoleemulationdebug.h"
 
 // Konsole
-#include "TerminalDisplay.h"
-#include "SessionManager.h"
-#include "Session.h"
 #include "Screen.h"
 
 using namespace Konsole;
 
 ExtendedCharTable::ExtendedCharTable() :
-    _extendedCharTable(QHash<uint, uint *>())
+    _extendedCharTable(QHash<uint, uint *>()),
+    _screens(QSet<Screen *>())
 {
 }
 
@@ -74,11 +72,8 @@ uint ExtendedCharTable::createExtendedChar(const uint *unicodePoints, ushort len
                     // All the hashes are full, go to all Screens and try to free any
                     // This is slow but should happen very rarely
                     QSet<uint> usedExtendedChars;
-                    const SessionManager *sm = SessionManager::instance();
-                    foreach (const Session *s, sm->sessions()) {
-                        foreach (const TerminalDisplay *td, s->views()) {
-                            usedExtendedChars += td->screenWindow()->screen()->usedExtendedChars();
-                        }
+                    foreach (const Screen *screen, _screens) {
+                        usedExtendedChars += screen->usedExtendedChars();
                     }
 
                     QHash<uint, uint *>::iterator it = _extendedCharTable.begin();
@@ -91,7 +86,7 @@ uint ExtendedCharTable::createExtendedChar(const uint *unicodePoints, ushort len
                         }
                     }
                 } else {
-                    qCDebug(KonsoleDebug) << "Using all the extended char hashes, going to miss this extended character";
+                    qCDebug(KonsoleEmulationDebug) << "Using all the extended char hashes, going to miss this extended character";
                     return 0;
                 }
             }
@@ -126,6 +121,16 @@ uint *ExtendedCharTable::lookupExtendedChar(uint hash, ushort &length) const
     }
 }
 
+void ExtendedCharTable::addScreen(Screen *screen)
+{
+    _screens.insert(screen);
+}
+
+void ExtendedCharTable::removeScreen(Screen *screen)
+{
+    _screens.remove(screen);
+}
+
 uint ExtendedCharTable::extendedCharHash(const uint *unicodePoints, ushort length) const
 {
     uint hash = 0;
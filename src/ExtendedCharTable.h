@@ -24,15 +24,21 @@
 
 // Qt
 #include <QHash>
+#include <QSet>
+
+// Konsole
+#include "konsoleemulation_export.h"
 
 namespace Konsole {
+class Screen;
+
 /**
  * A table which stores sequences of unicode characters, referenced
  * by hash keys.  The hash key itself is the same size as a unicode
  * character ( uint ) so that it can occupy the same space in
  * a structure.
  */
-class ExtendedCharTable
+class KONSOLEEMULATION_EXPORT ExtendedCharTable
 {
 public:
     /** Constructs a new character table. */
@@ -63,6 +69,15 @@ public:
      */
     uint *lookupExtendedChar(uint hash, ushort &length) const;
 
+    /**
+     * Registers a screen whose characters may reference entries in the
+     * table.  When the table runs out of hash keys, entries which are
+     * not used by any registered screen are discarded.
+     */
+    void addScreen(Screen *screen);
+    /** Unregisters a screen added with addScreen() */
+    void removeScreen(Screen *screen);
+
     /** The global ExtendedCharTable instance. */
     static ExtendedCharTable instance;
 private:
@@ -75,6 +90,8 @@ private:
     // in each value is the length of the buffer, followed by the uints in the buffer
     // themselves.
     QHash<uint, uint *> _extendedCharTable;
+    // the screens which are checked for used entries before discarding any
+    QSet<Screen *> _screens;
 };
 }
 #endif  // end of EXTENDEDCHARTABLE_H
@@ -30,7 +30,6 @@
 #include <QFile>
 #include <QMimeDatabase>
 #include <QString>
-#include <QTextStream>
 #include <QUrl>
 
 // KDE
@@ -39,7 +38,6 @@
 
 // Konsole
 #include "Session.h"
-#include "TerminalCharacterDecoder.h"
 
 using namespace Konsole;
 
@@ -118,20 +116,15 @@ QList<Filter::HotSpot *> FilterChain::hotSpots() const
     return list;
 }
 
-TerminalImageFilterChain::TerminalImageFilterChain() :
-    _buffer(nullptr),
-    _linePositions(nullptr)
+TerminalImageFilterChain::TerminalImageFilterChain()
 {
 }
 
 TerminalImageFilterChain::~TerminalImageFilterChain()
 {
-    delete _buffer;
-    delete _linePositions;
 }
 
-void TerminalImageFilterChain::setImage(const Character * const image, int lines, int columns,
-                                        const QVector<LineProperty> &lineProperties)
+void TerminalImageFilterChain::setImage(const ScreenImagePtr &image)
 {
     if (empty()) {
         return;
@@ -140,44 +133,10 @@ void TerminalImageFilterChain::setImage(const Character * const image, int lines
     // reset all filters and hotspots
     reset();
 
-    PlainTextDecoder decoder;
-    decoder.setLeadingWhitespace(true);
-    decoder.setTrailingWhitespace(true);
-
-    // setup new shared buffers for the filters to process on
-    auto newBuffer = new QString();
-    auto newLinePositions = new QList<int>();
-    setBuffer(newBuffer, newLinePositions);
-
-    // free the old buffers
-    delete _buffer;
-    delete _linePositions;
-
-    _buffer = newBuffer;
-    _linePositions = newLinePositions;
-
-    QTextStream lineStream(_buffer);
-    decoder.begin(&lineStream);
-
-    for (int i = 0; i < lines; i++) {
-        _linePositions->append(_buffer->length());
-        decoder.decodeLine(image + i * columns, columns, LINE_DEFAULT);
-
-        // pretend that each line ends with a newline character.
-        // this prevents a link that occurs at the end of one line
-        // being treated as part of a link that occurs at the start of the next line
-        //
-        // the downside is that links which are spread over more than one line are not
-        // highlighted.
-        //
-        // TODO - Use the "line wrapped" attribute associated with lines in a
-        // terminal image to avoid adding this imaginary character for wrapped
-        // lines
-        if ((lineProperties.value(i, LINE_DEFAULT) & LINE_WRAPPED) == 0) {
-            lineStream << QLatin1Char('\n');
-        }
-    }
-    decoder.end();
+    // the filters process the text of the snapshot, which is kept
+    // alive until the next image is set
+    _image = image;
+    setBuffer(&_image->text(), &_image->linePositions());
 }
 
 Filter::Filter() :
@@ -31,6 +31,7 @@
 
 // Konsole
 #include "Character.h"
+#include "ScreenImage.h"
 
 class QAction;
 
@@ -396,21 +397,18 @@ public:
     ~TerminalImageFilterChain() Q_DECL_OVERRIDE;
 
     /**
-     * Set the current terminal image to @p image.
+     * Set the current terminal image to @p image.  The filters process
+     * the text of the snapshot, which is decoded only once for all the
+     * views sharing the snapshot.
      *
      * @param image The terminal image
-     * @param lines The number of lines in the terminal image
-     * @param columns The number of columns in the terminal image
-     * @param lineProperties The line properties to set for image
      */
-    void setImage(const Character * const image, int lines, int columns,
-                  const QVector<LineProperty> &lineProperties);
+    void setImage(const ScreenImagePtr &image);
 
 private:
     Q_DISABLE_COPY(TerminalImageFilterChain)
 
-    QString *_buffer;
-    QList<int> *_linePositions;
+    ScreenImagePtr _image;
 };
 }
 #endif //FILTER_H
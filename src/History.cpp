@@ -21,8 +21,7 @@
 // Own
 #include "History.h"
 
-#include "konsoledebug.h"
-#include "KonsoleSettings.h"
+#include "konsoleemulationdebug.h"
 
 // System
 #include <cerrno>
@@ -32,10 +31,9 @@
 
 // KDE
 #include <QDir>
+#include <QMutexLocker>
 #include <qplatformdefs.h>
 #include <QStandardPaths>
-#include <KConfigGroup>
-#include <KSharedConfig>
 
 // Reasonable line size
 static const int LINE_SIZE = 1024;
@@ -44,6 +42,8 @@ using namespace Konsole;
 
 Q_GLOBAL_STATIC(QString, historyFileLocation)
 
+HistoryFile::LocationResolver HistoryFile::_locationResolver = nullptr;
+
 /*
    An arbitrary long scroll.
 
@@ -70,37 +70,19 @@ HistoryFile::HistoryFile() :
     // This has the down-side that users must restart to
     // load changes.
     if (!historyFileLocation.exists()) {
-        QString fileLocation;
-        KSharedConfigPtr appConfig = KSharedConfig::openConfig();
-        if (qApp->applicationName() != QLatin1String("konsole")) {
-            // Check if "kpart"rc has "FileLocation" group; AFAIK
-            // only possible if user manually added it. If not
-            // found, use konsole's config.
-            if (!appConfig->hasGroup("FileLocation")) {
-                appConfig = KSharedConfig::openConfig(QStringLiteral("konsolerc"));
-            }
-        }
-
-        KConfigGroup configGroup = appConfig->group("FileLocation");
-        if (configGroup.readEntry("scrollbackUseCacheLocation", false)) {
-            fileLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
-        } else if (configGroup.readEntry("scrollbackUseSpecifiedLocation", false)) {
-            const QUrl specifiedUrl = KonsoleSettings::scrollbackUseSpecifiedLocationDirectory();
-            fileLocation = specifiedUrl.path();
-        } else {
-            fileLocation = QDir::tempPath();
-        }
+        QString fileLocation = _locationResolver != nullptr ? _locationResolver()
+                                                            : QDir::tempPath();
         // Validate file location
         const QFileInfo fi(fileLocation);
         if (fileLocation.isEmpty() || !fi.exists() || !fi.isDir() || !fi.isWritable()) {
-            qCWarning(KonsoleDebug)<<"Invalid scrollback folder "<<fileLocation<<"; using " << QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+            qCWarning(KonsoleEmulationDebug)<<"Invalid scrollback folder "<<fileLocation<<"; using " << QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
             // Per Qt docs, this path is never empty; not sure if that
             // means it always exists.
             fileLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
             const QFileInfo fi2(fileLocation);
             if (!fi2.exists()) {
                 if (!QDir().mkpath(fileLocation)) {
-                    qCWarning(KonsoleDebug)<<"Unable to create scrollback folder "<<fileLocation;
+                    qCWarning(KonsoleEmulationDebug)<<"Unable to create scrollback folder "<<fileLocation;
                 }
             }
         }
@@ -119,6 +101,11 @@ HistoryFile::HistoryFile() :
     Q_UNUSED(_tmpFile.fileName());
 }
 
+void HistoryFile::setLocationResolver(LocationResolver resolver)
+{
+    _locationResolver = resolver;
+}
+
 HistoryFile::~HistoryFile()
 {
     if (_fileMap != nullptr) {
@@ -141,7 +128,7 @@ void HistoryFile::map()
     //if mmap'ing fails, fall back to the read-lseek combination
     if (_fileMap == nullptr) {
         _readWriteBalance = 0;
-        qCDebug(KonsoleDebug) << "mmap'ing history failed.  errno = " << errno;
+        qCDebug(KonsoleEmulationDebug) << "mmap'ing history failed.  errno = " << errno;
     }
 }
 
@@ -164,6 +151,8 @@ bool HistoryFile::isMapped() const
 
 void HistoryFile::add(const char *buffer, qint64 count)
 {
+    QMutexLocker locker(&_mutex);
+
     if (_fileMap != nullptr) {
         unmap();
     }
@@ -188,6 +177,8 @@ void HistoryFile::add(const char *buffer, qint64 count)
 
 void HistoryFile::get(char *buffer, qint64 size, qint64 loc)
 {
+    // reads move the file position and may map the file
+    QMutexLocker locker(&_mutex);
 
     if (loc < 0 || size < 0 || loc + size > _length) {
         fprintf(stderr, "getHist(...,%lld,%lld): invalid args.\n", size, loc);
@@ -244,6 +235,13 @@ bool HistoryScroll::hasScroll()
     return true;
 }
 
+void HistoryScroll::readLine(int lineno, TerminalLine &line)
+{
+    line.cells.resize(getLineLen(lineno));
+    getCells(lineno, 0, line.cells.size(), line.cells.data());
+    line.properties = isWrappedLine(lineno) ? LINE_WRAPPED : LINE_DEFAULT;
+}
+
 // History Scroll File //////////////////////////////////////
 
 /*
@@ -303,6 +301,14 @@ void HistoryScrollFile::getCells(int lineno, int colno, int count, Character res
     _cells.get(reinterpret_cast<char*>(res), count * sizeof(Character), startOfLine(lineno) + colno * sizeof(Character));
 }
 
+void HistoryScrollFile::readLine(int lineno, TerminalLine &line)
+{
+    const qint64 start = startOfLine(lineno);
+    line.cells.resize((startOfLine(lineno + 1) - start) / sizeof(Character));
+    _cells.get(reinterpret_cast<char*>(line.cells.data()), line.cells.size() * sizeof(Character), start);
+    line.properties = isWrappedLine(lineno) ? LINE_WRAPPED : LINE_DEFAULT;
+}
+
 void HistoryScrollFile::addCells(const Character text[], int count)
 {
     _cells.add(reinterpret_cast<const char*>(text), count * sizeof(Character));
@@ -316,6 +322,11 @@ void HistoryScrollFile::addLine(bool previousWrapped)
     _lineflags.add(reinterpret_cast<char *>(&flags), sizeof(char));
 }
 
+qint64 HistoryScrollFile::diskUsage() const
+{
+    return _index.len() + _cells.len() + _lineflags.len();
+}
+
 // History Scroll None //////////////////////////////////////
 
 HistoryScrollNone::HistoryScrollNone() :
@@ -422,6 +433,15 @@ CompactHistoryBlockList::~CompactHistoryBlockList()
     list.clear();
 }
 
+qint64 CompactHistoryBlockList::size() const
+{
+    qint64 total = 0;
+    foreach (CompactHistoryBlock *block, list) {
+        total += block->length();
+    }
+    return total;
+}
+
 void *CompactHistoryLine::operator new(size_t size, CompactHistoryBlockList &blockList)
 {
     return blockList.allocate(size);
@@ -515,8 +535,20 @@ void CompactHistoryLine::getCharacters(Character *array, int size, int startColu
     Q_ASSERT(startColumn >= 0 && size >= 0);
     Q_ASSERT(startColumn + size <= static_cast<int>(getLength()));
 
+    // walk through the format runs once instead of looking up the run
+    // of every character
+    int formatPos = 0;
     for (int i = startColumn; i < size + startColumn; i++) {
-        getCharacter(i, array[i - startColumn]);
+        while ((formatPos + 1) < _formatLength && i >= _formatArray[formatPos + 1].startPos) {
+            formatPos++;
+        }
+
+        Character &r = array[i - startColumn];
+        r.character = _text[i];
+        r.rendition = _formatArray[formatPos].rendition;
+        r.foregroundColor = _formatArray[formatPos].fgColor;
+        r.backgroundColor = _formatArray[formatPos].bgColor;
+        r.isRealCharacter = _formatArray[formatPos].isRealCharacter;
     }
 }
 
@@ -599,6 +631,11 @@ void CompactHistoryScroll::setMaxNbLines(unsigned int lineCount)
     ////qDebug() << "set max lines to: " << _maxLineCount;
 }
 
+qint64 CompactHistoryScroll::memoryUsage() const
+{
+    return _blockList.size() + _lines.size() * static_cast<qint64>(sizeof(CompactHistoryLine *));
+}
+
 bool CompactHistoryScroll::isWrappedLine(int lineNumber)
 {
     Q_ASSERT(lineNumber < _lines.size());
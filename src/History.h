@@ -26,10 +26,11 @@
 
 // Qt
 #include <QList>
+#include <QMutex>
 #include <QVector>
 #include <QTemporaryFile>
 
-#include "konsoleprivate_export.h"
+#include "konsoleemulation_export.h"
 
 // Konsole
 #include "Character.h"
@@ -39,12 +40,22 @@ namespace Konsole {
    An extendable tmpfile(1) based buffer.
 */
 
-class HistoryFile
+class KONSOLEEMULATION_EXPORT HistoryFile
 {
 public:
     HistoryFile();
     virtual ~HistoryFile();
 
+    typedef QString (*LocationResolver)();
+
+    /**
+     * Sets the function which returns the folder to create history files
+     * in.  It is called once, when the first history file is created; if
+     * no resolver is set or the folder it returns is not usable, the
+     * temporary or cache folder is used.
+     */
+    static void setLocationResolver(LocationResolver resolver);
+
     virtual void add(const char *buffer, qint64 count);
     virtual void get(char *buffer, qint64 size, qint64 loc);
     virtual qint64 len() const;
@@ -71,6 +82,11 @@ private:
 
     //when _readWriteBalance goes below this threshold, the file will be mmap'ed automatically
     static const int MAP_THRESHOLD = -1000;
+
+    // serializes reads and writes, which share the file position and map
+    QMutex _mutex;
+
+    static LocationResolver _locationResolver;
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -80,7 +96,7 @@ private:
 //////////////////////////////////////////////////////////////////////
 class HistoryType;
 
-class KONSOLEPRIVATE_EXPORT HistoryScroll
+class KONSOLEEMULATION_EXPORT HistoryScroll
 {
 public:
     explicit HistoryScroll(HistoryType *);
@@ -94,6 +110,11 @@ public:
     virtual void getCells(int lineno, int colno, int count, Character res[]) = 0;
     virtual bool isWrappedLine(int lineNumber) = 0;
 
+    // reads all cells and the properties of a line.  reading lines does not
+    // use any shared buffers, so different threads may read lines at the
+    // same time as long as no lines are added meanwhile
+    virtual void readLine(int lineno, TerminalLine &line);
+
     // adding lines.
     virtual void addCells(const Character a[], int count) = 0;
     // convenience method - this is virtual so that subclasses can take advantage
@@ -105,6 +126,17 @@ public:
 
     virtual void addLine(bool previousWrapped = false) = 0;
 
+    // resource usage, in bytes
+    virtual qint64 memoryUsage() const
+    {
+        return 0;
+    }
+
+    virtual qint64 diskUsage() const
+    {
+        return 0;
+    }
+
     //
     // FIXME:  Passing around constant references to HistoryType instances
     // is very unsafe, because those references will no longer
@@ -123,7 +155,7 @@ protected:
 // File-based history (e.g. file log, no limitation in length)
 //////////////////////////////////////////////////////////////////////
 
-class KONSOLEPRIVATE_EXPORT HistoryScrollFile : public HistoryScroll
+class KONSOLEEMULATION_EXPORT HistoryScrollFile : public HistoryScroll
 {
 public:
     explicit HistoryScrollFile(const QString &logFileName);
@@ -133,10 +165,13 @@ public:
     int  getLineLen(int lineno) Q_DECL_OVERRIDE;
     void getCells(int lineno, int colno, int count, Character res[]) Q_DECL_OVERRIDE;
     bool isWrappedLine(int lineno) Q_DECL_OVERRIDE;
+    void readLine(int lineno, TerminalLine &line) Q_DECL_OVERRIDE;
 
     void addCells(const Character text[], int count) Q_DECL_OVERRIDE;
     void addLine(bool previousWrapped = false) Q_DECL_OVERRIDE;
 
+    qint64 diskUsage() const Q_DECL_OVERRIDE;
+
 private:
     qint64 startOfLine(int lineno);
 
@@ -148,7 +183,7 @@ private:
 //////////////////////////////////////////////////////////////////////
 // Nothing-based history (no history :-)
 //////////////////////////////////////////////////////////////////////
-class KONSOLEPRIVATE_EXPORT HistoryScrollNone : public HistoryScroll
+class KONSOLEEMULATION_EXPORT HistoryScrollNone : public HistoryScroll
 {
 public:
     HistoryScrollNone();
@@ -268,6 +303,9 @@ public:
         return list.size();
     }
 
+    // total size of the allocated blocks in bytes
+    qint64 size() const;
+
 private:
     QList<CompactHistoryBlock *> list;
 };
@@ -311,7 +349,7 @@ protected:
     bool _wrapped;
 };
 
-class KONSOLEPRIVATE_EXPORT CompactHistoryScroll : public HistoryScroll
+class KONSOLEEMULATION_EXPORT CompactHistoryScroll : public HistoryScroll
 {
     typedef QList<CompactHistoryLine *> HistoryArray;
 
@@ -330,6 +368,8 @@ public:
 
     void setMaxNbLines(unsigned int lineCount);
 
+    qint64 memoryUsage() const Q_DECL_OVERRIDE;
+
 private:
     bool hasDifferentColors(const TextLine &line) const;
     HistoryArray _lines;
@@ -342,7 +382,7 @@ private:
 // History type
 //////////////////////////////////////////////////////////////////////
 
-class KONSOLEPRIVATE_EXPORT HistoryType
+class KONSOLEEMULATION_EXPORT HistoryType
 {
 public:
     HistoryType();
@@ -372,7 +412,7 @@ public:
     }
 };
 
-class KONSOLEPRIVATE_EXPORT HistoryTypeNone : public HistoryType
+class KONSOLEEMULATION_EXPORT HistoryTypeNone : public HistoryType
 {
 public:
     HistoryTypeNone();
@@ -383,7 +423,7 @@ public:
     HistoryScroll *scroll(HistoryScroll *) const Q_DECL_OVERRIDE;
 };
 
-class KONSOLEPRIVATE_EXPORT HistoryTypeFile : public HistoryType
+class KONSOLEEMULATION_EXPORT HistoryTypeFile : public HistoryType
 {
 public:
     explicit HistoryTypeFile(const QString &fileName = QString());
@@ -397,7 +437,7 @@ protected:
     QString _fileName;
 };
 
-class KONSOLEPRIVATE_EXPORT CompactHistoryType : public HistoryType
+class KONSOLEEMULATION_EXPORT CompactHistoryType : public HistoryType
 {
 public:
     explicit CompactHistoryType(unsigned int nbLines);
@@ -22,12 +22,15 @@
 // Own
 #include "KeyboardTranslator.h"
 
-#include "konsoledebug.h"
+#include "konsoleemulationdebug.h"
 
 // System
 #include <cctype>
 #include <cstdio>
 
+// C++
+#include <algorithm>
+
 // Qt
 #include <QBuffer>
 #include <QTextStream>
@@ -39,6 +42,22 @@
 
 using namespace Konsole;
 
+// number of slots in the direct index of key ranges: the Latin-1 keys
+// and as many special keys from Qt::Key_Escape on
+static const int KEY_RANGE_SLOTS = 0x200;
+
+// returns the slot of @p keyCode in the direct index of key ranges, or -1
+static inline int keyRangeSlot(int keyCode)
+{
+    if (keyCode >= 0 && keyCode < 0x100) {
+        return keyCode;
+    }
+    if (keyCode >= Qt::Key_Escape && keyCode < Qt::Key_Escape + 0x100) {
+        return 0x100 + keyCode - Qt::Key_Escape;
+    }
+    return -1;
+}
+
 KeyboardTranslatorWriter::KeyboardTranslatorWriter(QIODevice *destination) :
     _destination(destination),
     _writer(nullptr)
@@ -137,7 +156,7 @@ void KeyboardTranslatorReader::readNext()
             } else if (tokens[2].type == Token::Command) {
                 // identify command
                 if (!parseAsCommand(tokens[2].text, command)) {
-                    qCDebug(KonsoleDebug) << "Key" << tokens[1].text << ", Command"
+                    qCDebug(KonsoleEmulationDebug) << "Key" << tokens[1].text << ", Command"
                                           << tokens[2].text << "not understood. ";
                 }
             }
@@ -232,7 +251,7 @@ bool KeyboardTranslatorReader::decodeSequence(const QString &text, int &keyCode,
             } else if (parseAsKeyCode(buffer, itemKeyCode)) {
                 keyCode = itemKeyCode;
             } else {
-                qCDebug(KonsoleDebug) << "Unable to parse key binding item:" << buffer;
+                qCDebug(KonsoleEmulationDebug) << "Unable to parse key binding item:" << buffer;
             }
 
             buffer.clear();
@@ -303,7 +322,7 @@ bool KeyboardTranslatorReader::parseAsKeyCode(const QString &item, int &keyCode)
         keyCode = sequence[0];
 
         if (sequence.count() > 1) {
-            qCDebug(KonsoleDebug) << "Unhandled key codes in sequence: " << item;
+            qCDebug(KonsoleEmulationDebug) << "Unhandled key codes in sequence: " << item;
         }
     } else {
         return false;
@@ -411,7 +430,7 @@ QList<KeyboardTranslatorReader::Token> KeyboardTranslatorReader::tokenize(const
 
     QRegularExpressionMatch keyMatch(key.match(text));
     if (!keyMatch.hasMatch()) {
-        qCDebug(KonsoleDebug) << "Line in keyboard translator file could not be understood:"
+        qCDebug(KonsoleEmulationDebug) << "Line in keyboard translator file could not be understood:"
                               << text;
         return list;
     }
@@ -702,6 +721,7 @@ QString KeyboardTranslator::Entry::conditionToString() const
 
 KeyboardTranslator::KeyboardTranslator(const QString &name) :
     _entries(QMultiHash<int, Entry>()),
+    _compiled(false),
     _name(name),
     _description(QString())
 {
@@ -748,6 +768,7 @@ void KeyboardTranslator::addEntry(const Entry &entry)
 {
     const int keyCode = entry.keyCode();
     _entries.insert(keyCode, entry);
+    _compiled = false;
 }
 
 void KeyboardTranslator::replaceEntry(const Entry &existing, const Entry &replacement)
@@ -757,23 +778,102 @@ void KeyboardTranslator::replaceEntry(const Entry &existing, const Entry &replac
     }
 
     _entries.insert(replacement.keyCode(), replacement);
+    _compiled = false;
 }
 
 void KeyboardTranslator::removeEntry(const Entry &entry)
 {
     _entries.remove(entry.keyCode(), entry);
+    _compiled = false;
+}
+
+void KeyboardTranslator::compile() const
+{
+    _compiledEntries.clear();
+    _compiledEntries.reserve(_entries.count());
+    _keyRanges.clear();
+    _keyRangeIndex.fill(0, KEY_RANGE_SLOTS);
+
+    QList<int> keyCodes = _entries.uniqueKeys();
+    std::sort(keyCodes.begin(), keyCodes.end());
+
+    foreach (int keyCode, keyCodes) {
+        KeyRange range;
+        range.keyCode = keyCode;
+        range.first = _compiledEntries.count();
+
+        // values() returns the entries in the order in which find() visits them
+        foreach (const Entry &entry, _entries.values(keyCode)) {
+            CompiledEntry compiled;
+            compiled.modifierMask = entry.modifierMask();
+            compiled.modifiers = entry.modifiers() & entry.modifierMask();
+            compiled.stateMask = entry.stateMask();
+            compiled.state = entry.state() & entry.stateMask();
+            compiled.entry = entry;
+            _compiledEntries.append(compiled);
+        }
+
+        range.count = _compiledEntries.count() - range.first;
+        _keyRanges.append(range);
+
+        const int slot = keyRangeSlot(keyCode);
+        if (slot >= 0) {
+            _keyRangeIndex[slot] = _keyRanges.count();
+        }
+    }
+
+    _compiled = true;
 }
 
 KeyboardTranslator::Entry KeyboardTranslator::findEntry(int keyCode,
                                                         Qt::KeyboardModifiers modifiers,
                                                         States state) const
 {
-    QHash<int, KeyboardTranslator::Entry>::const_iterator i = _entries.find(keyCode);
-    while (i != _entries.constEnd() && i.key() == keyCode) {
-        if (i.value().matches(keyCode, modifiers, state)) {
-            return i.value();
+    if (!_compiled) {
+        compile();
+    }
+
+    const KeyRange *range = nullptr;
+    const int slot = keyRangeSlot(keyCode);
+    if (slot >= 0) {
+        if (_keyRangeIndex.at(slot) != 0) {
+            range = &_keyRanges.at(_keyRangeIndex.at(slot) - 1);
+        }
+    } else {
+        auto found = std::lower_bound(_keyRanges.constBegin(), _keyRanges.constEnd(), keyCode,
+                                      [](const KeyRange &a, int code) {
+                                          return a.keyCode < code;
+                                      });
+        if (found != _keyRanges.constEnd() && found->keyCode == keyCode) {
+            range = found;
+        }
+    }
+
+    if (range == nullptr) {
+        return Entry(); // No matching entry
+    }
+
+    // the same tests as Entry::matches(), on the masked values
+    const int testModifiers = modifiers;
+    int testState = state;
+    // if modifiers are pressed, the 'any modifier' state is implicit
+    if (testModifiers != 0) {
+        testState |= AnyModifierState;
+    }
+    // in the 'any modifier' state, the 'keypad' modifier does not count
+    const bool anyModifiersSet = testModifiers != 0 && testModifiers != Qt::KeypadModifier;
+
+    const CompiledEntry *compiled = _compiledEntries.constData() + range->first;
+    for (int i = 0; i < range->count; i++, compiled++) {
+        if ((testModifiers & compiled->modifierMask) != compiled->modifiers
+                || (testState & compiled->stateMask) != compiled->state) {
+            continue;
+        }
+        if ((compiled->stateMask & AnyModifierState) != 0
+                && ((compiled->state & AnyModifierState) != 0) != anyModifiersSet) {
+            continue;
         }
-        ++i;
+        return compiled->entry;
     }
 
     return Entry(); // No matching entry
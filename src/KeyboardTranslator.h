@@ -26,10 +26,11 @@
 #include <QHash>
 #include <QList>
 #include <QString>
+#include <QVector>
 #include <QMetaType>
 
 // Konsole
-#include "konsoleprivate_export.h"
+#include "konsoleemulation_export.h"
 
 class QIODevice;
 class QTextStream;
@@ -48,7 +49,7 @@ namespace Konsole {
  * (Shift,Ctrl,Alt,Meta etc.) and state flags which indicate the state
  * which the terminal must be in for the key sequence to apply.
  */
-class KONSOLEPRIVATE_EXPORT KeyboardTranslator
+class KONSOLEEMULATION_EXPORT KeyboardTranslator
 {
 public:
     /**
@@ -303,9 +304,36 @@ public:
     QList<Entry> entries() const;
 
 private:
+    // builds the tables searched by findEntry()
+    void compile() const;
+
     // All entries in this translator, indexed by their keycode
     QMultiHash<int, Entry> _entries;
 
+    // A flat copy of _entries which findEntry() searches without hashing.
+    // The entries of each key are stored next to each other, in the order
+    // in which _entries returns them, with their modifiers and states
+    // already masked.  Rebuilt on the first search after a change.
+    struct CompiledEntry {
+        int modifiers;
+        int modifierMask;
+        int state;
+        int stateMask;
+        Entry entry;
+    };
+    struct KeyRange {
+        int keyCode;
+        int first;
+        int count;
+    };
+    mutable QVector<CompiledEntry> _compiledEntries;
+    // the entries of each key, sorted by key code
+    mutable QVector<KeyRange> _keyRanges;
+    // index + 1 of the key range of the Latin-1 keys and of the keys from
+    // Qt::Key_Escape on, or 0 if the key has no entries
+    mutable QVector<quint16> _keyRangeIndex;
+    mutable bool _compiled;
+
     QString _name;
     QString _description;
 };
@@ -346,7 +374,7 @@ public:
  *  }
  * @endcode
  */
-class KeyboardTranslatorReader
+class KONSOLEEMULATION_EXPORT KeyboardTranslatorReader
 {
 public:
     /** Constructs a new reader which parses the given @p source */
@@ -411,7 +439,7 @@ private:
 };
 
 /** Writes a keyboard translation to disk. */
-class KeyboardTranslatorWriter
+class KONSOLEEMULATION_EXPORT KeyboardTranslatorWriter
 {
 public:
     /**
@@ -22,9 +22,11 @@
 // Own
 #include "KeyboardTranslatorManager.h"
 
-#include "konsoledebug.h"
+#include "konsoleemulationdebug.h"
 
 // Qt
+#include <QDataStream>
+#include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
@@ -32,6 +34,17 @@
 
 using namespace Konsole;
 
+// identifies the files written by saveCachedTranslator()
+static const quint32 KEYTAB_CACHE_MAGIC = 0x4b4b5443;
+// to be increased when the format of the cached translators changes
+static const quint32 KEYTAB_CACHE_VERSION = 1;
+
+static QString cachedTranslatorPath(const QString &name)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+           + QStringLiteral("/konsole/keytabs/") + name + QStringLiteral(".cache");
+}
+
 KeyboardTranslatorManager::KeyboardTranslatorManager() :
     _haveLoadedAll(false),
     _fallbackTranslator(nullptr),
@@ -57,7 +70,7 @@ void KeyboardTranslatorManager::addTranslator(KeyboardTranslator *translator)
     _translators.insert(translator->name(), translator);
 
     if (!saveTranslator(translator)) {
-        qCDebug(KonsoleDebug) << "Unable to save translator" << translator->name()
+        qCDebug(KonsoleEmulationDebug) << "Unable to save translator" << translator->name()
                               << "to disk.";
     }
 }
@@ -72,7 +85,7 @@ bool KeyboardTranslatorManager::deleteTranslator(const QString &name)
         _translators.remove(name);
         return true;
     } else {
-        qCDebug(KonsoleDebug) << "Failed to remove translator - " << path;
+        qCDebug(KonsoleEmulationDebug) << "Failed to remove translator - " << path;
         return false;
     }
 }
@@ -138,7 +151,7 @@ const KeyboardTranslator *KeyboardTranslatorManager::findTranslator(const QStrin
     if (translator != nullptr) {
         _translators[name] = translator;
     } else if (!name.isEmpty()) {
-        qCDebug(KonsoleDebug) << "Unable to load translator" << name;
+        qCDebug(KonsoleEmulationDebug) << "Unable to load translator" << name;
     }
 
     return translator;
@@ -155,7 +168,7 @@ bool KeyboardTranslatorManager::saveTranslator(const KeyboardTranslator *transla
 
     QFile destination(path);
     if (!destination.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qCDebug(KonsoleDebug) << "Unable to save keyboard translation:"
+        qCDebug(KonsoleEmulationDebug) << "Unable to save keyboard translation:"
                               << destination.errorString();
         return false;
     }
@@ -183,7 +196,112 @@ KeyboardTranslator *KeyboardTranslatorManager::loadTranslator(const QString &nam
         return nullptr;
     }
 
-    return loadTranslator(&source, name);
+    const QFileInfo sourceInfo(path);
+    KeyboardTranslator *translator = loadCachedTranslator(name, sourceInfo);
+    if (translator != nullptr) {
+        return translator;
+    }
+
+    translator = loadTranslator(&source, name);
+    if (translator != nullptr) {
+        saveCachedTranslator(translator, sourceInfo);
+    }
+    return translator;
+}
+
+KeyboardTranslator *KeyboardTranslatorManager::loadCachedTranslator(const QString &name,
+                                                                    const QFileInfo &source)
+{
+    QFile cache(cachedTranslatorPath(name));
+    if (!cache.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != KEYTAB_CACHE_MAGIC || version != KEYTAB_CACHE_VERSION) {
+        return nullptr;
+    }
+
+    // the cache is only used while the .keytab file is unchanged
+    QString sourcePath;
+    qint64 sourceModified = 0;
+    qint64 sourceSize = 0;
+    stream >> sourcePath >> sourceModified >> sourceSize;
+    if (sourcePath != source.absoluteFilePath()
+            || sourceModified != source.lastModified().toMSecsSinceEpoch()
+            || sourceSize != source.size()) {
+        return nullptr;
+    }
+
+    QString description;
+    qint32 count = 0;
+    stream >> description >> count;
+
+    auto translator = new KeyboardTranslator(name);
+    translator->setDescription(description);
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        qint32 keyCode = 0;
+        quint32 modifiers = 0;
+        quint32 modifierMask = 0;
+        quint32 state = 0;
+        quint32 stateMask = 0;
+        quint32 command = 0;
+        QByteArray text;
+        stream >> keyCode >> modifiers >> modifierMask >> state >> stateMask >> command >> text;
+
+        KeyboardTranslator::Entry entry;
+        entry.setKeyCode(keyCode);
+        entry.setModifiers(Qt::KeyboardModifiers(modifiers));
+        entry.setModifierMask(Qt::KeyboardModifiers(modifierMask));
+        entry.setState(KeyboardTranslator::States(state));
+        entry.setStateMask(KeyboardTranslator::States(stateMask));
+        entry.setCommand(static_cast<KeyboardTranslator::Command>(command));
+        entry.setText(text);
+        translator->addEntry(entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCDebug(KonsoleEmulationDebug) << "Ignoring damaged cache of translator" << name;
+        delete translator;
+        return nullptr;
+    }
+
+    return translator;
+}
+
+void KeyboardTranslatorManager::saveCachedTranslator(const KeyboardTranslator *translator,
+                                                     const QFileInfo &source)
+{
+    const QString path = cachedTranslatorPath(translator->name());
+    QDir().mkpath(QFileInfo(path).path());
+
+    QFile cache(path);
+    if (!cache.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCDebug(KonsoleEmulationDebug) << "Unable to cache translator" << translator->name()
+                                       << cache.errorString();
+        return;
+    }
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    const QList<KeyboardTranslator::Entry> entries = translator->entries();
+    stream << KEYTAB_CACHE_MAGIC << KEYTAB_CACHE_VERSION
+           << source.absoluteFilePath() << source.lastModified().toMSecsSinceEpoch() << source.size()
+           << translator->description() << qint32(entries.count());
+
+    // the text is stored escaped, like in the .keytab file
+    foreach (const KeyboardTranslator::Entry &entry, entries) {
+        stream << qint32(entry.keyCode())
+               << quint32(entry.modifiers()) << quint32(entry.modifierMask())
+               << quint32(entry.state()) << quint32(entry.stateMask())
+               << quint32(entry.command()) << entry.escapedText();
+    }
 }
 
 KeyboardTranslator *KeyboardTranslatorManager::loadTranslator(QIODevice *source,
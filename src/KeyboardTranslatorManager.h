@@ -27,9 +27,10 @@
 #include <QStringList>
 
 // Konsole
-#include "konsoleprivate_export.h"
+#include "konsoleemulation_export.h"
 #include "KeyboardTranslator.h"
 
+class QFileInfo;
 class QIODevice;
 
 namespace Konsole {
@@ -37,7 +38,7 @@ namespace Konsole {
  * Manages the keyboard translations available for use by terminal sessions,
  * see KeyboardTranslator.
  */
-class KeyboardTranslatorManager
+class KONSOLEEMULATION_EXPORT KeyboardTranslatorManager
 {
 public:
     /**
@@ -123,6 +124,12 @@ private:
     KeyboardTranslator *loadTranslator(const QString &name);
     KeyboardTranslator *loadTranslator(QIODevice *source, const QString &name);
 
+    // Parsing a .keytab file is skipped while a binary copy of the translator,
+    // cached when the file was last parsed, records the same time of last
+    // modification and size as the file
+    KeyboardTranslator *loadCachedTranslator(const QString &name, const QFileInfo &source);
+    void saveCachedTranslator(const KeyboardTranslator *translator, const QFileInfo &source);
+
     bool saveTranslator(const KeyboardTranslator *translator);
 
     bool _haveLoadedAll;
@@ -0,0 +1,123 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "LatencyProbe.h"
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+using namespace Konsole;
+
+namespace {
+// number of samples the percentiles are computed from
+const int MAX_SAMPLES = 1000;
+// key presses are dropped if nothing changes on screen within this time
+const qint64 MAX_PENDING_TIME = Q_INT64_C(1000000000);
+// limit for the number of key presses waiting for an answer, in case
+// a key is held down while the terminal does not echo
+const int MAX_PENDING_KEYS = 256;
+}
+
+LatencyProbe::LatencyProbe() :
+    _nextSample(0)
+{
+    _clock.start();
+}
+
+qint64 LatencyProbe::now() const
+{
+    return _clock.nsecsElapsed();
+}
+
+void LatencyProbe::keyPressed(qint64 time)
+{
+    if (_pendingKeys.size() >= MAX_PENDING_KEYS) {
+        _pendingKeys.removeFirst();
+    }
+    _pendingKeys.append(time);
+}
+
+void LatencyProbe::contentChanged(qint64 time)
+{
+    foreach (qint64 keyTime, _pendingKeys) {
+        if (time - keyTime <= MAX_PENDING_TIME) {
+            _answeredKeys.append(keyTime);
+        }
+    }
+    _pendingKeys.clear();
+}
+
+bool LatencyProbe::painted(qint64 time)
+{
+    if (_answeredKeys.isEmpty()) {
+        return false;
+    }
+
+    foreach (qint64 keyTime, _answeredKeys) {
+        addSample(time - keyTime);
+    }
+    _answeredKeys.clear();
+    return true;
+}
+
+void LatencyProbe::addSample(qint64 latency)
+{
+    if (_samples.size() < MAX_SAMPLES) {
+        _samples.append(latency);
+    } else {
+        _samples[_nextSample] = latency;
+    }
+    _nextSample = (_nextSample + 1) % MAX_SAMPLES;
+}
+
+QVector<qint64> LatencyProbe::samples() const
+{
+    if (_samples.size() < MAX_SAMPLES) {
+        return _samples;
+    }
+
+    QVector<qint64> ordered;
+    ordered.reserve(MAX_SAMPLES);
+    for (int i = 0; i < MAX_SAMPLES; i++) {
+        ordered.append(_samples.at((_nextSample + i) % MAX_SAMPLES));
+    }
+    return ordered;
+}
+
+void LatencyProbe::reset()
+{
+    _pendingKeys.clear();
+    _answeredKeys.clear();
+    _samples.clear();
+    _nextSample = 0;
+}
+
+qint64 LatencyProbe::percentile(QVector<qint64> samples, double percentile)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+
+    const int rank = qBound(1, static_cast<int>(std::ceil(percentile / 100.0 * samples.size())), samples.size());
+    auto nth = samples.begin() + (rank - 1);
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
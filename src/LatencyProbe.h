@@ -0,0 +1,94 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+// Qt
+#include <QElapsedTimer>
+#include <QVector>
+
+// Konsole
+#include "konsoleprivate_export.h"
+
+namespace Konsole {
+/**
+ * Measures the time from a key press to the end of the first repaint
+ * which shows the terminal's response to it.
+ *
+ * The terminal display reports key presses with keyPressed(), changes of
+ * its image with contentChanged() and completed paint events with
+ * painted().  A key press is matched to the first paint which follows a
+ * change of the image made after the key was pressed.  Output which is
+ * unrelated to the key press (a clock in the status line, for example)
+ * can therefore end a measurement early; key presses which are not
+ * answered within a second are discarded.
+ *
+ * The end of the paint event is the last point Konsole can observe, the
+ * compositor and the display add their own latency on top of it.
+ *
+ * All times are in nanoseconds, as returned by now().
+ */
+class KONSOLEPRIVATE_EXPORT LatencyProbe
+{
+public:
+    LatencyProbe();
+
+    /** Returns the current time of the probe's clock */
+    qint64 now() const;
+
+    /** Records a key press at @p time */
+    void keyPressed(qint64 time);
+
+    /** Records that the displayed image changed at @p time */
+    void contentChanged(qint64 time);
+
+    /**
+     * Records the end of a paint event at @p time.  Returns true if a new
+     * latency sample was recorded.
+     */
+    bool painted(qint64 time);
+
+    /** Returns the most recent latency samples, oldest first */
+    QVector<qint64> samples() const;
+
+    /** Discards all samples and pending key presses */
+    void reset();
+
+    /**
+     * Returns the @p percentile (between 0 and 100) of @p samples using
+     * the nearest-rank method, or 0 if @p samples is empty.
+     */
+    static qint64 percentile(QVector<qint64> samples, double percentile);
+
+private:
+    void addSample(qint64 latency);
+
+    QElapsedTimer _clock;
+    // key presses which have not been answered yet
+    QVector<qint64> _pendingKeys;
+    // key presses which have been answered and wait for the next paint
+    QVector<qint64> _answeredKeys;
+    // ring buffer of the latest samples
+    QVector<qint64> _samples;
+    int _nextSample;
+};
+}
+
+#endif // LATENCYPROBE_H
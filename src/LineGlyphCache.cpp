@@ -0,0 +1,424 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "LineGlyphCache.h"
+
+// Qt
+#include <QPainter>
+#include <QRect>
+
+// Konsole
+#include "Character.h"
+#include "LineFont.h"
+
+using namespace Konsole;
+
+namespace {
+// the cache is emptied when it holds this many glyphs, which is far more
+// than a screen of box drawing characters in a few colors needs
+const int MAX_GLYPHS = 2048;
+}
+
+/**
+ A table for emulating the simple (single width) unicode drawing chars.
+ It represents the 250x - 257x glyphs. If it's zero, we can't use it.
+ if it's not, it's encoded as follows: imagine a 5x5 grid where the points are numbered
+ 0 to 24 left to top, top to bottom. Each point is represented by the corresponding bit.
+
+ Then, the pixels basically have the following interpretation:
+ _|||_
+ -...-
+ -...-
+ -...-
+ _|||_
+
+where _ = none
+      | = vertical line.
+      - = horizontal line.
+ */
+
+enum LineEncode {
+    TopL  = (1 << 1),
+    TopC  = (1 << 2),
+    TopR  = (1 << 3),
+
+    LeftT = (1 << 5),
+    Int11 = (1 << 6),
+    Int12 = (1 << 7),
+    Int13 = (1 << 8),
+    RightT = (1 << 9),
+
+    LeftC = (1 << 10),
+    Int21 = (1 << 11),
+    Int22 = (1 << 12),
+    Int23 = (1 << 13),
+    RightC = (1 << 14),
+
+    LeftB = (1 << 15),
+    Int31 = (1 << 16),
+    Int32 = (1 << 17),
+    Int33 = (1 << 18),
+    RightB = (1 << 19),
+
+    BotL  = (1 << 21),
+    BotC  = (1 << 22),
+    BotR  = (1 << 23)
+};
+
+static void drawLineChar(QPainter& paint, int x, int y, int w, int h, uchar code)
+{
+    //Calculate cell midpoints, end points.
+    const int cx = x + w / 2;
+    const int cy = y + h / 2;
+    const int ex = x + w - 1;
+    const int ey = y + h - 1;
+
+    const quint32 toDraw = LineChars[code];
+
+    //Top _lines:
+    if ((toDraw & TopL) != 0u) {
+        paint.drawLine(cx - 1, y, cx - 1, cy - 2);
+    }
+    if ((toDraw & TopC) != 0u) {
+        paint.drawLine(cx, y, cx, cy - 2);
+    }
+    if ((toDraw & TopR) != 0u) {
+        paint.drawLine(cx + 1, y, cx + 1, cy - 2);
+    }
+
+    //Bot _lines:
+    if ((toDraw & BotL) != 0u) {
+        paint.drawLine(cx - 1, cy + 2, cx - 1, ey);
+    }
+    if ((toDraw & BotC) != 0u) {
+        paint.drawLine(cx, cy + 2, cx, ey);
+    }
+    if ((toDraw & BotR) != 0u) {
+        paint.drawLine(cx + 1, cy + 2, cx + 1, ey);
+    }
+
+    //Left _lines:
+    if ((toDraw & LeftT) != 0u) {
+        paint.drawLine(x, cy - 1, cx - 2, cy - 1);
+    }
+    if ((toDraw & LeftC) != 0u) {
+        paint.drawLine(x, cy, cx - 2, cy);
+    }
+    if ((toDraw & LeftB) != 0u) {
+        paint.drawLine(x, cy + 1, cx - 2, cy + 1);
+    }
+
+    //Right _lines:
+    if ((toDraw & RightT) != 0u) {
+        paint.drawLine(cx + 2, cy - 1, ex, cy - 1);
+    }
+    if ((toDraw & RightC) != 0u) {
+        paint.drawLine(cx + 2, cy, ex, cy);
+    }
+    if ((toDraw & RightB) != 0u) {
+        paint.drawLine(cx + 2, cy + 1, ex, cy + 1);
+    }
+
+    //Intersection points.
+    if ((toDraw & Int11) != 0u) {
+        paint.drawPoint(cx - 1, cy - 1);
+    }
+    if ((toDraw & Int12) != 0u) {
+        paint.drawPoint(cx, cy - 1);
+    }
+    if ((toDraw & Int13) != 0u) {
+        paint.drawPoint(cx + 1, cy - 1);
+    }
+
+    if ((toDraw & Int21) != 0u) {
+        paint.drawPoint(cx - 1, cy);
+    }
+    if ((toDraw & Int22) != 0u) {
+        paint.drawPoint(cx, cy);
+    }
+    if ((toDraw & Int23) != 0u) {
+        paint.drawPoint(cx + 1, cy);
+    }
+
+    if ((toDraw & Int31) != 0u) {
+        paint.drawPoint(cx - 1, cy + 1);
+    }
+    if ((toDraw & Int32) != 0u) {
+        paint.drawPoint(cx, cy + 1);
+    }
+    if ((toDraw & Int33) != 0u) {
+        paint.drawPoint(cx + 1, cy + 1);
+    }
+}
+
+static void drawOtherChar(QPainter& paint, int x, int y, int w, int h, uchar code)
+{
+    //Calculate cell midpoints, end points.
+    const int cx = x + w / 2;
+    const int cy = y + h / 2;
+    const int ex = x + w - 1;
+    const int ey = y + h - 1;
+
+    // Double dashes
+    if (0x4C <= code && code <= 0x4F) {
+        const int xHalfGap = qMax(w / 15, 1);
+        const int yHalfGap = qMax(h / 15, 1);
+        switch (code) {
+        case 0x4D: // BOX DRAWINGS HEAVY DOUBLE DASH HORIZONTAL
+            paint.drawLine(x, cy - 1, cx - xHalfGap - 1, cy - 1);
+            paint.drawLine(x, cy + 1, cx - xHalfGap - 1, cy + 1);
+            paint.drawLine(cx + xHalfGap, cy - 1, ex, cy - 1);
+            paint.drawLine(cx + xHalfGap, cy + 1, ex, cy + 1);
+            // No break!
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 8, 0))
+            Q_FALLTHROUGH();
+#endif
+        case 0x4C: // BOX DRAWINGS LIGHT DOUBLE DASH HORIZONTAL
+            paint.drawLine(x, cy, cx - xHalfGap - 1, cy);
+            paint.drawLine(cx + xHalfGap, cy, ex, cy);
+            break;
+        case 0x4F: // BOX DRAWINGS HEAVY DOUBLE DASH VERTICAL
+            paint.drawLine(cx - 1, y, cx - 1, cy - yHalfGap - 1);
+            paint.drawLine(cx + 1, y, cx + 1, cy - yHalfGap - 1);
+            paint.drawLine(cx - 1, cy + yHalfGap, cx - 1, ey);
+            paint.drawLine(cx + 1, cy + yHalfGap, cx + 1, ey);
+            // No break!
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 8, 0))
+            Q_FALLTHROUGH();
+#endif
+        case 0x4E: // BOX DRAWINGS LIGHT DOUBLE DASH VERTICAL
+            paint.drawLine(cx, y, cx, cy - yHalfGap - 1);
+            paint.drawLine(cx, cy + yHalfGap, cx, ey);
+            break;
+        }
+    }
+
+    // Rounded corner characters
+    else if (0x6D <= code && code <= 0x70) {
+        const int r = w * 3 / 8;
+        const int d = 2 * r;
+        switch (code) {
+        case 0x6D: // BOX DRAWINGS LIGHT ARC DOWN AND RIGHT
+            paint.drawLine(cx, cy + r, cx, ey);
+            paint.drawLine(cx + r, cy, ex, cy);
+            paint.drawArc(cx, cy, d, d, 90 * 16, 90 * 16);
+            break;
+        case 0x6E: // BOX DRAWINGS LIGHT ARC DOWN AND LEFT
+            paint.drawLine(cx, cy + r, cx, ey);
+            paint.drawLine(x, cy, cx - r, cy);
+            paint.drawArc(cx - d, cy, d, d, 0 * 16, 90 * 16);
+            break;
+        case 0x6F: // BOX DRAWINGS LIGHT ARC UP AND LEFT
+            paint.drawLine(cx, y, cx, cy - r);
+            paint.drawLine(x, cy, cx - r, cy);
+            paint.drawArc(cx - d, cy - d, d, d, 270 * 16, 90 * 16);
+            break;
+        case 0x70: // BOX DRAWINGS LIGHT ARC UP AND RIGHT
+            paint.drawLine(cx, y, cx, cy - r);
+            paint.drawLine(cx + r, cy, ex, cy);
+            paint.drawArc(cx, cy - d, d, d, 180 * 16, 90 * 16);
+            break;
+        }
+    }
+
+    // Diagonals
+    else if (0x71 <= code && code <= 0x73) {
+        switch (code) {
+        case 0x71: // BOX DRAWINGS LIGHT DIAGONAL UPPER RIGHT TO LOWER LEFT
+            paint.drawLine(ex, y, x, ey);
+            break;
+        case 0x72: // BOX DRAWINGS LIGHT DIAGONAL UPPER LEFT TO LOWER RIGHT
+            paint.drawLine(x, y, ex, ey);
+            break;
+        case 0x73: // BOX DRAWINGS LIGHT DIAGONAL CROSS
+            paint.drawLine(ex, y, x, ey);
+            paint.drawLine(x, y, ex, ey);
+            break;
+        }
+    }
+}
+
+
+// Block elements (U+2580 - U+259F)
+static void drawBlockChar(QPainter& paint, int x, int y, int w, int h, uchar code)
+{
+    const QColor color = paint.pen().color();
+    const qreal eighthWidth = w / 8.0;
+    const qreal eighthHeight = h / 8.0;
+
+    if (code == 0x80) { // UPPER HALF BLOCK
+        paint.fillRect(QRectF(x, y, w, h / 2.0), color);
+    } else if (0x81 <= code && code <= 0x88) { // LOWER ONE EIGHTH BLOCK - FULL BLOCK
+        const qreal height = (code - 0x80) * eighthHeight;
+        paint.fillRect(QRectF(x, y + h - height, w, height), color);
+    } else if (0x89 <= code && code <= 0x8F) { // LEFT SEVEN EIGHTHS BLOCK - LEFT ONE EIGHTH BLOCK
+        paint.fillRect(QRectF(x, y, (0x90 - code) * eighthWidth, h), color);
+    } else if (code == 0x90) { // RIGHT HALF BLOCK
+        paint.fillRect(QRectF(x + w / 2.0, y, w / 2.0, h), color);
+    } else if (0x91 <= code && code <= 0x93) { // LIGHT SHADE - DARK SHADE
+        QColor shade(color);
+        shade.setAlphaF(shade.alphaF() * (code - 0x90) / 4.0);
+        paint.fillRect(QRect(x, y, w, h), shade);
+    } else if (code == 0x94) { // UPPER ONE EIGHTH BLOCK
+        paint.fillRect(QRectF(x, y, w, eighthHeight), color);
+    } else if (code == 0x95) { // RIGHT ONE EIGHTH BLOCK
+        paint.fillRect(QRectF(x + w - eighthWidth, y, eighthWidth, h), color);
+    } else if (0x96 <= code && code <= 0x9F) { // QUADRANTS
+        enum { UpperLeft = 1, UpperRight = 2, LowerLeft = 4, LowerRight = 8 };
+        static const uchar quadrants[] = {
+            LowerLeft,
+            LowerRight,
+            UpperLeft,
+            UpperLeft | LowerLeft | LowerRight,
+            UpperLeft | LowerRight,
+            UpperLeft | UpperRight | LowerLeft,
+            UpperLeft | UpperRight | LowerRight,
+            UpperRight,
+            UpperRight | LowerLeft,
+            UpperRight | LowerLeft | LowerRight
+        };
+        const uchar toDraw = quadrants[code - 0x96];
+        const qreal halfWidth = w / 2.0;
+        const qreal halfHeight = h / 2.0;
+        if ((toDraw & UpperLeft) != 0) {
+            paint.fillRect(QRectF(x, y, halfWidth, halfHeight), color);
+        }
+        if ((toDraw & UpperRight) != 0) {
+            paint.fillRect(QRectF(x + halfWidth, y, halfWidth, halfHeight), color);
+        }
+        if ((toDraw & LowerLeft) != 0) {
+            paint.fillRect(QRectF(x, y + halfHeight, halfWidth, halfHeight), color);
+        }
+        if ((toDraw & LowerRight) != 0) {
+            paint.fillRect(QRectF(x + halfWidth, y + halfHeight, halfWidth, halfHeight), color);
+        }
+    }
+}
+
+// Braille patterns (U+2800 - U+28FF), the bits of 'code' are the dots
+// 1 to 8 of the pattern
+static void drawBrailleChar(QPainter& paint, int x, int y, int w, int h, uchar code)
+{
+    // column and row of the dots 1 to 8 in the 2x4 grid
+    static const int dotColumn[] = { 0, 0, 0, 1, 1, 1, 0, 1 };
+    static const int dotRow[] = { 0, 1, 2, 0, 1, 2, 3, 3 };
+
+    const qreal columnWidth = w / 2.0;
+    const qreal rowHeight = h / 4.0;
+    const qreal diameter = qMax(1.0, qMin(columnWidth, rowHeight) * 0.7);
+
+    paint.setPen(Qt::NoPen);
+    for (int dot = 0; dot < 8; dot++) {
+        if ((code & (1 << dot)) != 0) {
+            const QPointF center(x + (dotColumn[dot] + 0.5) * columnWidth,
+                                 y + (dotRow[dot] + 0.5) * rowHeight);
+            paint.drawEllipse(center, diameter / 2, diameter / 2);
+        }
+    }
+}
+
+LineGlyphCache::LineGlyphCache() :
+    _devicePixelRatio(1.0)
+{
+}
+
+bool LineGlyphCache::canDraw(uint codePoint)
+{
+    return isSupportedLineChar(codePoint)
+           || (0x2580 <= codePoint && codePoint <= 0x259F)
+           || (0x2800 <= codePoint && codePoint <= 0x28FF);
+}
+
+void LineGlyphCache::drawGlyph(QPainter &painter, const QRect &rect, uint codePoint, bool bold)
+{
+    const uchar code = codePoint & 0xFF;
+
+    painter.save();
+
+    if (isSupportedLineChar(codePoint)) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        if (bold) {
+            QPen boldPen(painter.pen());
+            boldPen.setWidth(3);
+            painter.setPen(boldPen);
+        }
+
+        if (LineChars[code] != 0u) {
+            drawLineChar(painter, rect.x(), rect.y(), rect.width(), rect.height(), code);
+        } else {
+            drawOtherChar(painter, rect.x(), rect.y(), rect.width(), rect.height(), code);
+        }
+    } else if (0x2580 <= codePoint && codePoint <= 0x259F) {
+        drawBlockChar(painter, rect.x(), rect.y(), rect.width(), rect.height(), code);
+    } else if (0x2800 <= codePoint && codePoint <= 0x28FF) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setBrush(painter.pen().color());
+        drawBrailleChar(painter, rect.x(), rect.y(), rect.width(), rect.height(), code);
+    }
+
+    painter.restore();
+}
+
+QPixmap LineGlyphCache::glyph(uint codePoint, const QSize &cellSize, qreal devicePixelRatio,
+                              QRgb color, bool bold)
+{
+    if (cellSize != _cellSize || devicePixelRatio != _devicePixelRatio) {
+        clear();
+        _cellSize = cellSize;
+        _devicePixelRatio = devicePixelRatio;
+    }
+
+    // only the lines of box drawing characters are drawn bold
+    if (!isSupportedLineChar(codePoint)) {
+        bold = false;
+    }
+
+    const quint64 key = (quint64(color) << 32) | (quint64(codePoint) << 1) | (bold ? 1 : 0);
+    QHash<quint64, QPixmap>::const_iterator cached = _glyphs.constFind(key);
+    if (cached != _glyphs.constEnd()) {
+        return cached.value();
+    }
+
+    if (_glyphs.size() >= MAX_GLYPHS) {
+        _glyphs.clear();
+    }
+
+    QPixmap pixmap(cellSize * devicePixelRatio);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setPen(QColor::fromRgba(color));
+    drawGlyph(painter, QRect(QPoint(0, 0), cellSize), codePoint, bold);
+    painter.end();
+
+    _glyphs.insert(key, pixmap);
+    return pixmap;
+}
+
+int LineGlyphCache::size() const
+{
+    return _glyphs.size();
+}
+
+void LineGlyphCache::clear()
+{
+    _glyphs.clear();
+}
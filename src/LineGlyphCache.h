@@ -0,0 +1,83 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef LINEGLYPHCACHE_H
+#define LINEGLYPHCACHE_H
+
+// Qt
+#include <QColor>
+#include <QHash>
+#include <QPixmap>
+#include <QSize>
+
+// Konsole
+#include "konsoleprivate_export.h"
+
+class QPainter;
+class QRect;
+
+namespace Konsole {
+/**
+ * Draws box drawing characters, block elements and braille patterns
+ * to fill their character cell exactly, and keeps the drawn glyphs.
+ *
+ * Terminal programs draw their frames, bars and graphs from these
+ * characters, often thousands of them per screen.  Instead of drawing
+ * the lines and rectangles of each character again, glyph() draws a
+ * character once per color and cell size into a pixmap which is then
+ * copied to the display.
+ *
+ * All glyphs of the cache have the same cell size and device pixel
+ * ratio; asking for a different one drops the cached glyphs.
+ */
+class KONSOLEPRIVATE_EXPORT LineGlyphCache
+{
+public:
+    LineGlyphCache();
+
+    /** Returns true if @p codePoint is drawn by drawGlyph() instead of the font */
+    static bool canDraw(uint codePoint);
+
+    /**
+     * Draws @p codePoint into @p rect with the color of @p painter's pen.
+     * The lines of box drawing characters are drawn thicker if @p bold is true.
+     */
+    static void drawGlyph(QPainter &painter, const QRect &rect, uint codePoint, bool bold);
+
+    /**
+     * Returns a pixmap of @p codePoint drawn by drawGlyph() into a cell of
+     * @p cellSize with @p color, drawing it first if it is not cached.
+     */
+    QPixmap glyph(uint codePoint, const QSize &cellSize, qreal devicePixelRatio,
+                  QRgb color, bool bold);
+
+    /** Returns the number of cached glyphs */
+    int size() const;
+
+    /** Drops all cached glyphs */
+    void clear();
+
+private:
+    QHash<quint64, QPixmap> _glyphs;
+    QSize _cellSize;
+    qreal _devicePixelRatio;
+};
+}
+
+#endif // LINEGLYPHCACHE_H
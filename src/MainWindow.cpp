@@ -52,6 +52,7 @@
 #include "Session.h"
 #include "ViewManager.h"
 #include "SessionManager.h"
+#include "SessionPool.h"
 #include "ProfileManager.h"
 #include "KonsoleSettings.h"
 #include "WindowSystemInfo.h"
@@ -509,13 +510,18 @@ Session *MainWindow::createSession(Profile::Ptr profile, const QString &director
         profile = ProfileManager::instance()->defaultProfile();
     }
 
-    Session *session = SessionManager::instance()->createSession(profile);
+    // adopt an idle session which has been started in the background
+    // if there is one, otherwise start a new one
+    Session *session = _viewManager->sessionPool()->takeSession(profile, directory);
+    if (session == nullptr) {
+        session = SessionManager::instance()->createSession(profile);
 
-    if (!directory.isEmpty() && profile->startInCurrentSessionDir()) {
-        session->setInitialWorkingDirectory(directory);
-    }
+        if (!directory.isEmpty() && profile->startInCurrentSessionDir()) {
+            session->setInitialWorkingDirectory(directory);
+        }
 
-    session->addEnvironmentEntry(QStringLiteral("KONSOLE_DBUS_WINDOW=/Windows/%1").arg(_viewManager->managerId()));
+        session->addEnvironmentEntry(QStringLiteral("KONSOLE_DBUS_WINDOW=/Windows/%1").arg(_viewManager->managerId()));
+    }
 
     // create view before starting the session process so that the session
     // doesn't suffer a change in terminal size right after the session
@@ -783,6 +789,7 @@ void MainWindow::applyKonsoleSettings()
     }
 
     _viewManager->setNavigationBehavior(KonsoleSettings::newTabBehavior());
+    _viewManager->sessionPool()->setSize(KonsoleSettings::shellPoolSize());
     setAutoSaveSettings(QStringLiteral("MainWindow"), KonsoleSettings::saveGeometryOnExit());
     updateWindowCaption();
 }
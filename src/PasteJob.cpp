@@ -0,0 +1,129 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "PasteJob.h"
+
+// Qt
+#include <QTextCodec>
+#include <QTextEncoder>
+
+// Konsole
+#include "Emulation.h"
+#include "Pty.h"
+
+using namespace Konsole;
+
+namespace {
+// number of characters encoded and sent at a time
+const int CHUNK_SIZE = 16 * 1024;
+// no more chunks are sent while the teletype has more than this number
+// of bytes left to write
+const qint64 MAX_PENDING_INPUT = 64 * 1024;
+}
+
+PasteJob::PasteJob(Emulation *emulation, Pty *pty, const QString &text, bool bracketed,
+                   QObject *parent) :
+    QObject(parent),
+    _emulation(emulation),
+    _pty(pty),
+    _text(text),
+    _position(0),
+    _bracketed(bracketed),
+    _running(false),
+    _encoder(emulation->codec()->makeEncoder(QTextCodec::IgnoreHeader))
+{
+}
+
+PasteJob::~PasteJob()
+{
+    delete _encoder;
+}
+
+void PasteJob::start()
+{
+    Q_ASSERT(!_running);
+
+    _running = true;
+    if (_bracketed) {
+        _emulation->sendString(QByteArrayLiteral("\033[200~"));
+    }
+
+    connect(_pty.data(), &Konsole::Pty::inputWritten, this, &Konsole::PasteJob::sendChunks);
+    sendChunks();
+}
+
+bool PasteJob::isRunning() const
+{
+    return _running;
+}
+
+int PasteJob::percent() const
+{
+    return _text.isEmpty() ? 100 : static_cast<int>(qint64(_position) * 100 / _text.length());
+}
+
+void PasteJob::sendChunks()
+{
+    if (!_running) {
+        return;
+    }
+
+    if (_emulation.isNull() || _pty.isNull()) {
+        finish(true);
+        return;
+    }
+
+    const int oldPercent = percent();
+    while (_position < _text.length() && _pty->pendingInput() < MAX_PENDING_INPUT) {
+        int length = qMin(CHUNK_SIZE, _text.length() - _position);
+        // do not separate the halves of a surrogate pair
+        if (_position + length < _text.length() && _text.at(_position + length - 1).isHighSurrogate()) {
+            length--;
+        }
+
+        const QChar *chunk = _text.constData() + _position;
+        _emulation->sendString(_encoder->fromUnicode(chunk, length));
+        _position += length;
+    }
+
+    if (_position == _text.length()) {
+        finish(false);
+    } else if (percent() != oldPercent) {
+        emit progress(percent());
+    }
+}
+
+void PasteJob::cancel()
+{
+    if (_running) {
+        finish(true);
+    }
+}
+
+void PasteJob::finish(bool canceled)
+{
+    _running = false;
+    if (_bracketed && !_emulation.isNull()) {
+        _emulation->sendString(QByteArrayLiteral("\033[201~"));
+    }
+
+    emit finished(canceled);
+    deleteLater();
+}
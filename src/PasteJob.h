@@ -0,0 +1,108 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef PASTEJOB_H
+#define PASTEJOB_H
+
+// Qt
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+// Konsole
+#include "konsoleprivate_export.h"
+
+class QTextEncoder;
+
+namespace Konsole {
+class Emulation;
+class Pty;
+
+/**
+ * Sends pasted text to the terminal in chunks.
+ *
+ * Instead of handing the whole text to the teletype at once, the text is
+ * encoded and sent a chunk at a time, and the next chunk is only sent
+ * once the teletype has accepted most of the previous ones.  A program
+ * which reads its input slowly therefore holds up the paste instead of
+ * the user interface, and the paste can be canceled half-way.
+ *
+ * The chunks are sent with Emulation::sendString(), so they reach the
+ * other sessions of a session group as well.
+ *
+ * If the paste is bracketed, the text is preceded by the start of paste
+ * sequence and always followed by the end of paste sequence, even if
+ * the paste is canceled.
+ */
+class KONSOLEPRIVATE_EXPORT PasteJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Constructs a job which pastes @p text into @p emulation, waiting
+     * for @p pty to write the data sent to it.
+     */
+    PasteJob(Emulation *emulation, Pty *pty, const QString &text, bool bracketed,
+             QObject *parent = nullptr);
+    ~PasteJob() Q_DECL_OVERRIDE;
+
+    /**
+     * Sends the first chunks of the text.  If the whole text fits into
+     * the teletype's buffer, the job has finished when this returns.
+     */
+    void start();
+
+    /** Returns true if the job has been started and not finished yet */
+    bool isRunning() const;
+
+    /** Returns the percentage of the text sent so far */
+    int percent() const;
+
+public Q_SLOTS:
+    /** Stops sending the text and emits finished() */
+    void cancel();
+
+Q_SIGNALS:
+    /** Emitted when the percentage of the text sent so far changes */
+    void progress(int percent);
+
+    /**
+     * Emitted when all text has been sent or the job was canceled.
+     * The job deletes itself afterwards.
+     */
+    void finished(bool canceled);
+
+private Q_SLOTS:
+    void sendChunks();
+
+private:
+    void finish(bool canceled);
+
+    QPointer<Emulation> _emulation;
+    QPointer<Pty> _pty;
+    QString _text;
+    int _position;
+    bool _bracketed;
+    bool _running;
+    QTextEncoder *_encoder;
+};
+}
+
+#endif // PASTEJOB_H
@@ -144,6 +144,7 @@ void Profile::fillTableWithDefaultNames()
 
     const PropertyInfo* iter = DefaultPropertyNames;
     while (iter->name != nullptr) {
+        Q_ASSERT(iter->property < PropertyCount);
         registerProperty(*iter);
         iter++;
     }
@@ -224,7 +225,7 @@ void Profile::useFallback()
     setHidden(true);
 }
 Profile::Profile(Profile::Ptr parent)
-    : _propertyValues(QHash<Property, QVariant>())
+    : _propertySet()
     , _parent(parent)
     , _hidden(false)
 {
@@ -271,19 +272,41 @@ const Profile::Ptr Profile::parent() const
 
 bool Profile::isEmpty() const
 {
-    return _propertyValues.isEmpty();
+    return _propertySet.none();
 }
 QHash<Profile::Property, QVariant> Profile::setProperties() const
 {
-    return _propertyValues;
+    QHash<Property, QVariant> values;
+    for (int i = 0; i < PropertyCount; i++) {
+        if (_propertySet[i]) {
+            values.insert(static_cast<Property>(i), _propertyValues[i]);
+        }
+    }
+    return values;
 }
 void Profile::setProperty(Property p, const QVariant& value)
 {
-    _propertyValues.insert(p, value);
+    _propertyValues[p] = typedValue(p, value);
+    _propertySet[p] = true;
 }
 bool Profile::isPropertySet(Property p) const
 {
-    return _propertyValues.contains(p);
+    return _propertySet[p];
+}
+
+QVariant Profile::typedValue(Property p, const QVariant& value)
+{
+    fillTableWithDefaultNames();
+
+    // values which cannot be converted are kept as they are, reading
+    // them gives the same result as before
+    const QVariant::Type type = PropertyInfoByProperty.value(p).type;
+    if (!value.isValid() || type == QVariant::Invalid || value.type() == type) {
+        return value;
+    }
+
+    QVariant converted = value;
+    return converted.convert(type) ? converted : value;
 }
 
 Profile::Property Profile::lookupByName(const QString& name)
@@ -29,6 +29,9 @@
 #include <QFont>
 #include <QColor>
 
+// C++
+#include <bitset>
+
 // Konsole
 #include "konsoleprivate_export.h"
 
@@ -343,7 +346,8 @@ public:
     /**
      * Returns the current value of the specified @p property, cast to type T.
      * Internally properties are stored using the QVariant type and cast to T
-     * using QVariant::value<T>();
+     * using QVariant::value<T>();  values are converted to the type of the
+     * property when they are set, so the cast only copies the value.
      *
      * If the specified @p property has not been set in this profile,
      * and a non-null parent was specified in the Profile's constructor,
@@ -645,7 +649,18 @@ private:
     // returns true if the property can be inherited
     static bool canInheritProperty(Property p);
 
-    QHash<Property, QVariant> _propertyValues;
+    // returns value converted to the type property p is declared with,
+    // so that property<T>() can return a copy instead of converting
+    // the value on each call
+    static QVariant typedValue(Property p, const QVariant &value);
+
+    // number of properties, the values of which are stored in an array
+    // indexed by the property.  Must follow the last entry of Property.
+    static const int PropertyCount = ReverseUrlHints + 1;
+
+    QVariant _propertyValues[PropertyCount];
+    // the properties which have been set in this profile
+    std::bitset<PropertyCount> _propertySet;
     Ptr _parent;
 
     bool _hidden;
@@ -678,7 +693,7 @@ inline T Profile::property(Property p) const
 template<>
 inline QVariant Profile::property(Property p) const
 {
-    if (_propertyValues.contains(p)) {
+    if (_propertySet[p]) {
         return _propertyValues[p];
     } else if (_parent && canInheritProperty(p)) {
         return _parent->property<QVariant>(p);
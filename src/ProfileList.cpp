@@ -49,10 +49,12 @@ ProfileList::ProfileList(bool addShortcuts , QObject* parent)
 
     // TODO - Handle re-sorts when user changes profile names
     ProfileManager* manager = ProfileManager::instance();
-    QList<Profile::Ptr> favoriteProfiles = manager->sortedFavorites();
-
-    foreach(const Profile::Ptr& profile, favoriteProfiles) {
-        favoriteChanged(profile, true);
+    if (manager->areFavoritesLoaded()) {
+        addFavorites();
+    } else {
+        // the favorites are read after the first window has been set up
+        connect(manager, &Konsole::ProfileManager::favoritesLoaded, this, &Konsole::ProfileList::addFavorites);
+        manager->loadFavoritesLater();
     }
 
     connect(_group, &QActionGroup::triggered, this, &Konsole::ProfileList::triggered);
@@ -62,6 +64,17 @@ ProfileList::ProfileList(bool addShortcuts , QObject* parent)
     connect(manager, &Konsole::ProfileManager::shortcutChanged, this, &Konsole::ProfileList::shortcutChanged);
     connect(manager, &Konsole::ProfileManager::profileChanged, this, &Konsole::ProfileList::profileChanged);
 }
+void ProfileList::addFavorites()
+{
+    const QList<Profile::Ptr> favoriteProfiles = ProfileManager::instance()->sortedFavorites();
+
+    foreach(const Profile::Ptr& profile, favoriteProfiles) {
+        if (actionForProfile(profile) == nullptr) {
+            favoriteChanged(profile, true);
+        }
+    }
+}
+
 void ProfileList::updateEmptyAction()
 {
     Q_ASSERT(_group);
@@ -88,6 +88,7 @@ private Q_SLOTS:
     void shortcutChanged(Profile::Ptr profile, const QKeySequence &sequence);
     void addShortcutAction(Profile::Ptr profile);
     void removeShortcutAction(Profile::Ptr profile);
+    void addFavorites();
 
 private:
     Q_DISABLE_COPY(ProfileList)
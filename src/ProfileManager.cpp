@@ -29,6 +29,7 @@
 #include <QFileInfo>
 #include <QList>
 #include <QString>
+#include <QTimer>
 
 // KDE
 #include <KSharedConfig>
@@ -400,24 +401,39 @@ void ProfileManager::changeProfile(Profile::Ptr profile,
         newProfile = profile;
     };
 
-    // insert the changes into the existing Profile instance
-    QListIterator<Profile::Property> iter(propertyMap.keys());
-    while (iter.hasNext()) {
-        const Profile::Property property = iter.next();
-        newProfile->setProperty(property, propertyMap[property]);
-    }
-
     // when changing a group, iterate through the profiles
     // in the group and call changeProfile() on each of them
     //
     // this is so that each profile in the group, the profile is
     // applied, a change notification is emitted and the profile
     // is saved to disk
+    //
+    // the profiles are changed before the group, which would otherwise
+    // pass the new values on to them and leave nothing to notify about
     ProfileGroup::Ptr group = newProfile->asGroup();
     if (group) {
         foreach(const Profile::Ptr & groupProfile, group->profiles()) {
             changeProfile(groupProfile, propertyMap, persistent);
         }
+    }
+
+    // insert the changes into the existing Profile instance, noting
+    // which properties get a new value
+    QSet<Profile::Property> changedProperties;
+    QHashIterator<Profile::Property, QVariant> iter(propertyMap);
+    while (iter.hasNext()) {
+        iter.next();
+        const Profile::Property property = iter.key();
+        const QVariant oldValue = newProfile->property<QVariant>(property);
+        newProfile->setProperty(property, iter.value());
+
+        if (property == Profile::ColorScheme || property == Profile::KeyBindings
+                || newProfile->property<QVariant>(property) != oldValue) {
+            changedProperties.insert(property);
+        }
+    }
+
+    if (group) {
         return;
     }
 
@@ -449,6 +465,9 @@ void ProfileManager::changeProfile(Profile::Ptr profile,
     }
 
     // notify the world about the change
+    if (!changedProperties.isEmpty()) {
+        emit profilePropertiesChanged(newProfile, changedProperties);
+    }
     emit profileChanged(newProfile);
 }
 
@@ -529,6 +548,17 @@ QSet<Profile::Ptr> ProfileManager::findFavorites()
 
     return _favorites;
 }
+
+bool ProfileManager::areFavoritesLoaded() const
+{
+    return _loadedFavorites;
+}
+
+void ProfileManager::loadFavoritesLater()
+{
+    QTimer::singleShot(0, this, &Konsole::ProfileManager::loadFavorites);
+}
+
 void ProfileManager::setFavorite(Profile::Ptr profile , bool favorite)
 {
     if (!_profiles.contains(profile)) {
@@ -659,6 +689,7 @@ void ProfileManager::loadFavorites()
     }
 
     _loadedFavorites = true;
+    emit favoritesLoaded();
 }
 
 QList<QKeySequence> ProfileManager::shortcuts()
@@ -137,7 +137,9 @@ public:
      *
      * All sessions currently using the profile will be updated to reflect the new settings.
      *
-     * After the profile is updated, the profileChanged() signal will be emitted.
+     * After the profile is updated, the profilePropertiesChanged() signal will
+     * be emitted with the properties which got a new value, followed by the
+     * profileChanged() signal.
      *
      * @param profile The profile to change
      * @param propertyMap A map between profile properties and values describing the changes
@@ -178,6 +180,16 @@ public:
 
     QList<Profile::Ptr> sortedFavorites();
 
+    /** Returns true if the set of favorite profiles has been read */
+    bool areFavoritesLoaded() const;
+
+    /**
+     * Reads the set of favorite profiles once control returns to the
+     * event loop, so that the favorites do not hold up the creation of
+     * the first window.  favoritesLoaded() is emitted afterwards.
+     */
+    void loadFavoritesLater();
+
     /**
      * Sorts the profile list by menuindex; those without an menuindex, sort by name.
      *  The menuindex list is first and then the non-menuindex list.
@@ -220,6 +232,17 @@ Q_SIGNALS:
     /** Emitted when a profile's properties are modified. */
     void profileChanged(Profile::Ptr ptr);
 
+    /**
+     * Emitted before profileChanged() with the @p properties of @p profile
+     * which changeProfile() gave a new value, so that only these need to be
+     * applied to the sessions and views using the profile.
+     *
+     * The color scheme and key bindings properties are included whenever
+     * they are changed, even to the same name, because the scheme or the
+     * key bindings of that name may have been edited.
+     */
+    void profilePropertiesChanged(Profile::Ptr profile, const QSet<Profile::Property> &properties);
+
     /**
      * Emitted when the favorite status of a profile changes.
      *
@@ -228,6 +251,9 @@ Q_SIGNALS:
      */
     void favoriteStatusChanged(Profile::Ptr profile, bool favorite);
 
+    /** Emitted when the set of favorite profiles has been read. */
+    void favoritesLoaded();
+
     /**
      * Emitted when the shortcut for a profile is changed.
      *
@@ -24,6 +24,7 @@
 
 // Qt
 #include <QFile>
+#include <QDataStream>
 #include <QDir>
 
 // KDE
@@ -41,7 +42,14 @@ static const char FEATURES_GROUP[]        = "Terminal Features";
 static const char URLHINTS_KEY[]          = "EnableUrlHints";
 static const char URLHINTSMODIFIERS_KEY[] = "UrlHintsModifiers";
 
-ProfileReader::ProfileReader() = default;
+// to be increased when the format of the cached profiles changes
+static const quint32 PROFILE_CACHE_VERSION = 1;
+
+ProfileReader::ProfileReader() :
+    _cache(QStringLiteral("profiles"), PROFILE_CACHE_VERSION)
+{
+}
+
 ProfileReader::~ProfileReader() = default;
 
 QStringList ProfileReader::findProfiles()
@@ -58,7 +66,7 @@ QStringList ProfileReader::findProfiles()
     }
     return profiles;
 }
-void ProfileReader::readProperties(const KConfig& config, Profile::Ptr profile,
+void ProfileReader::readProperties(const KConfig& config, QHash<Profile::Property, QVariant>& values,
                                        const Profile::PropertyInfo* properties)
 {
     const char* groupName = nullptr;
@@ -74,8 +82,8 @@ void ProfileReader::readProperties(const KConfig& config, Profile::Ptr profile,
             QString name(QLatin1String(properties->name));
 
             if (group.hasKey(name)) {
-                profile->setProperty(properties->property,
-                                     group.readEntry(name, QVariant(properties->type)));
+                values.insert(properties->property,
+                              group.readEntry(name, QVariant(properties->type)));
             }
         }
 
@@ -89,6 +97,24 @@ bool ProfileReader::readProfile(const QString& path , Profile::Ptr profile , QSt
         return false;
     }
 
+    QHash<Profile::Property, QVariant> values;
+    if (!loadCachedProfile(path, values, parentProfile)) {
+        parseProfile(path, values, parentProfile);
+        saveCachedProfile(path, values, parentProfile);
+    }
+
+    QHashIterator<Profile::Property, QVariant> iter(values);
+    while (iter.hasNext()) {
+        iter.next();
+        profile->setProperty(iter.key(), iter.value());
+    }
+
+    return true;
+}
+
+void ProfileReader::parseProfile(const QString& path, QHash<Profile::Property, QVariant>& values,
+                                 QString& parentProfile)
+{
     KConfig config(path, KConfig::NoGlobals);
 
     KConfigGroup general = config.group(GENERAL_GROUP);
@@ -99,8 +125,8 @@ bool ProfileReader::readProfile(const QString& path , Profile::Ptr profile , QSt
     if (general.hasKey("Command")) {
         ShellCommand shellCommand(general.readEntry("Command"));
 
-        profile->setProperty(Profile::Command, shellCommand.command());
-        profile->setProperty(Profile::Arguments, shellCommand.arguments());
+        values.insert(Profile::Command, shellCommand.command());
+        values.insert(Profile::Arguments, shellCommand.arguments());
     }
 
     // Check if the user earlier had set the URL hints option, and in that case set the default
@@ -116,11 +142,63 @@ bool ProfileReader::readProfile(const QString& path , Profile::Ptr profile , QSt
         }
     }
 
-    profile->setProperty(Profile::UntranslatedName, general.readEntryUntranslated("Name"));
+    values.insert(Profile::UntranslatedName, general.readEntryUntranslated("Name"));
 
     // Read remaining properties
-    readProperties(config, profile, Profile::DefaultPropertyNames);
+    readProperties(config, values, Profile::DefaultPropertyNames);
+
+    // write the migrated URL hints settings now, so that the cache
+    // records the file as it is afterwards
+    config.sync();
+}
+
+bool ProfileReader::loadCachedProfile(const QString& path, QHash<Profile::Property, QVariant>& values,
+                                      QString& parentProfile)
+{
+    const QByteArray data = _cache.load(path);
+    if (data.isEmpty()) {
+        return false;
+    }
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_6);
 
+    QString parent;
+    qint32 count = 0;
+    stream >> parent >> count;
+
+    QHash<Profile::Property, QVariant> cachedValues;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        qint32 property = 0;
+        QVariant value;
+        stream >> property >> value;
+        cachedValues.insert(static_cast<Profile::Property>(property), value);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    if (!parent.isEmpty()) {
+        parentProfile = parent;
+    }
+    values = cachedValues;
     return true;
 }
 
+void ProfileReader::saveCachedProfile(const QString& path, const QHash<Profile::Property, QVariant>& values,
+                                      const QString& parentProfile)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    stream << parentProfile << qint32(values.count());
+    QHashIterator<Profile::Property, QVariant> iter(values);
+    while (iter.hasNext()) {
+        iter.next();
+        stream << qint32(iter.key()) << iter.value();
+    }
+
+    _cache.save(path, data);
+}
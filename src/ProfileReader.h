@@ -23,6 +23,7 @@
 #define PROFILEREADER_H
 
 #include "Profile.h"
+#include "ConfigCache.h"
 
 class KConfig;
 
@@ -50,8 +51,20 @@ public:
     bool readProfile(const QString &path, Profile::Ptr profile, QString &parentProfile);
 
 private:
-    void readProperties(const KConfig &config, Profile::Ptr profile,
+    // reads the properties from the profile file itself
+    void parseProfile(const QString &path, QHash<Profile::Property, QVariant> &values,
+                      QString &parentProfile);
+    void readProperties(const KConfig &config, QHash<Profile::Property, QVariant> &values,
                         const Profile::PropertyInfo *properties);
+
+    // Parsing a profile is skipped while the properties read from it
+    // the last time are cached and the file has not changed since
+    bool loadCachedProfile(const QString &path, QHash<Profile::Property, QVariant> &values,
+                           QString &parentProfile);
+    void saveCachedProfile(const QString &path, const QHash<Profile::Property, QVariant> &values,
+                           const QString &parentProfile);
+
+    ConfigCache _cache;
 };
 }
 
@@ -22,6 +22,7 @@
 #include "Pty.h"
 
 #include "konsoledebug.h"
+#include "Tracer.h"
 
 // System
 #include <termios.h>
@@ -66,6 +67,7 @@ void Pty::init()
     setPtyChannels(KPtyProcess::AllChannels);
 
     connect(pty(), &KPtyDevice::readyRead, this, &Konsole::Pty::dataReceived);
+    connect(pty(), &KPtyDevice::bytesWritten, this, &Konsole::Pty::inputWritten);
 }
 
 Pty::~Pty() = default;
@@ -82,8 +84,15 @@ void Pty::sendData(const QByteArray &data)
     }
 }
 
+qint64 Pty::pendingInput() const
+{
+    return pty()->bytesToWrite();
+}
+
 void Pty::dataReceived()
 {
+    KONSOLE_TRACE_SCOPE("Pty::dataReceived");
+
     QByteArray data = pty()->readAll();
     if (data.isEmpty()) {
         return;
@@ -262,11 +271,10 @@ int Pty::start(const QString &programName, const QStringList &programArguments,
 
     KProcess::start();
 
-    if (waitForStarted()) {
-        return 0;
-    } else {
-        return -1;
-    }
+    // do not wait for the program to be executed, so that several sessions
+    // can be started at once.  If it can not be executed, errorOccurred()
+    // is emitted later on.
+    return state() == QProcess::NotRunning ? -1 : 0;
 }
 
 void Pty::setWriteable(bool writeable)
@@ -76,7 +76,8 @@ public:
      * Starts the terminal process.
      *
      * Returns 0 if the process was started successfully or non-zero
-     * otherwise.
+     * otherwise.  This does not wait for the program to be executed; if
+     * that fails, errorOccurred() is emitted with QProcess::FailedToStart.
      *
      * @param program Path to the program to start
      * @param arguments Arguments to pass to the program being started
@@ -142,6 +143,12 @@ public:
      */
     void sendEof();
 
+    /**
+     * Returns the number of bytes passed to sendData() which have not
+     * been written to the teletype yet.
+     */
+    qint64 pendingInput() const;
+
 public Q_SLOTS:
     /**
      * Put the pty into UTF-8 mode on systems which support it.
@@ -166,6 +173,14 @@ Q_SIGNALS:
      */
     void receivedData(const char *buffer, int length);
 
+    /**
+     * Emitted when data passed to sendData() has been written to
+     * the teletype.  See pendingInput()
+     *
+     * @param bytes The number of bytes written
+     */
+    void inputWritten(qint64 bytes);
+
 protected:
     void setupChildProcess() Q_DECL_OVERRIDE;
 
@@ -23,6 +23,9 @@
 // Own
 #include "Screen.h"
 
+// C++
+#include <algorithm>
+
 // Qt
 #include <QTextStream>
 
@@ -46,6 +49,11 @@ using namespace Konsole;
 #define loc(X,Y) ((Y)*_columns+(X))
 #endif
 
+//Positions which include the lines in the history, such as the selection,
+//can exceed the range of an int with a large history, so they are 64-bit.
+//This macro converts from an X,Y position into such an offset.
+#define globalLoc(X,Y) (qint64(Y)*_columns+(X))
+
 const Character Screen::DefaultChar = Character(' ',
                                       CharacterColor(COLOR_SPACE_DEFAULT, DEFAULT_FORE_COLOR),
                                       CharacterColor(COLOR_SPACE_DEFAULT, DEFAULT_BACK_COLOR),
@@ -61,6 +69,7 @@ Screen::Screen(int lines, int columns):
     _scrolledLines(0),
     _lastScrolledRegion(QRect()),
     _droppedLines(0),
+    _historyLinesAdded(0),
     _lineProperties(QVarLengthArray<LineProperty, 64>()),
     _history(new HistoryScrollNone()),
     _cuX(0),
@@ -89,10 +98,13 @@ Screen::Screen(int lines, int columns):
     initTabStops();
     clearSelection();
     reset();
+
+    ExtendedCharTable::instance.addScreen(this);
 }
 
 Screen::~Screen()
 {
+    ExtendedCharTable::instance.removeScreen(this);
     delete[] _screenLines;
     delete _history;
 }
@@ -534,6 +546,43 @@ void Screen::getImage(Character* dest, int size, int startLine, int endLine) con
     }
 }
 
+ScreenImagePtr Screen::sharedImage(int startLine, int lines)
+{
+    Q_ASSERT(startLine >= 0 && lines > 0);
+
+    for (int i = _sharedImages.count() - 1; i >= 0; i--) {
+        const ScreenImagePtr image = _sharedImages.at(i).toStrongRef();
+        if (image.isNull()) {
+            _sharedImages.removeAt(i);
+        } else if (image->startLine() == startLine && image->lines() == lines
+                   && image->columns() == _columns) {
+            return image;
+        }
+    }
+
+    QSharedPointer<ScreenImage> image(new ScreenImage(startLine, lines, _columns));
+    const int endLine = qMin(startLine + lines - 1, _history->getLines() + _lines - 1);
+    const int size = lines * _columns;
+    getImage(image->_characters.data(), size, startLine, endLine);
+
+    // the snapshot may look beyond the end of the screen, in which
+    // case there will be an unused area which needs to be filled
+    // with blank characters
+    const int usedSize = (endLine - startLine + 1) * _columns;
+    fillWithDefaultChar(image->_characters.data() + usedSize, size - usedSize);
+
+    image->_lineProperties = getLineProperties(startLine, endLine);
+    image->_lineProperties.resize(lines);
+
+    _sharedImages.append(image);
+    return image;
+}
+
+void Screen::discardSharedImages()
+{
+    _sharedImages.clear();
+}
+
 QVector<LineProperty> Screen::getLineProperties(int startLine , int endLine) const
 {
     Q_ASSERT(startLine >= 0);
@@ -676,7 +725,7 @@ void Screen::checkSelection(int from, int to)
     if (_selBegin == -1) {
         return;
     }
-    const int scr_TL = loc(0, _history->getLines());
+    const qint64 scr_TL = globalLoc(0, _history->getLines());
     //Clear entire selection if it overlaps region [from, to]
     if ((_selBottomRight >= (from + scr_TL)) && (_selTopLeft <= (to + scr_TL))) {
         clearSelection();
@@ -813,6 +862,16 @@ void Screen::resetScrolledLines()
     _scrolledLines = 0;
 }
 
+qint64 Screen::historyMemoryUsage() const
+{
+    return _history->memoryUsage();
+}
+
+qint64 Screen::historyDiskUsage() const
+{
+    return _history->diskUsage();
+}
+
 void Screen::scrollUp(int n)
 {
     if (n == 0) {
@@ -916,7 +975,7 @@ int Screen::getCursorY() const
 
 void Screen::clearImage(int loca, int loce, char c)
 {
-    const int scr_TL = loc(0, _history->getLines());
+    const qint64 scr_TL = globalLoc(0, _history->getLines());
     //FIXME: check positions
 
     //Clear entire selection if it overlaps region to be moved...
@@ -991,11 +1050,11 @@ void Screen::moveImage(int dest, int sourceBegin, int sourceEnd)
     if (_selBegin != -1) {
         const bool beginIsTL = (_selBegin == _selTopLeft);
         const int diff = dest - sourceBegin; // Scroll by this amount
-        const int scr_TL = loc(0, _history->getLines());
-        const int srca = sourceBegin + scr_TL; // Translate index from screen to global
-        const int srce = sourceEnd + scr_TL; // Translate index from screen to global
-        const int desta = srca + diff;
-        const int deste = srce + diff;
+        const qint64 scr_TL = globalLoc(0, _history->getLines());
+        const qint64 srca = sourceBegin + scr_TL; // Translate index from screen to global
+        const qint64 srce = sourceEnd + scr_TL; // Translate index from screen to global
+        const qint64 desta = srca + diff;
+        const qint64 deste = srce + diff;
 
         if ((_selTopLeft >= srca) && (_selTopLeft <= srce)) {
             _selTopLeft += diff;
@@ -1114,6 +1173,8 @@ void Screen::setBackColor(int space, int color)
 
 void Screen::clearSelection()
 {
+    discardSharedImages();
+
     _selBottomRight = -1;
     _selTopLeft = -1;
     _selBegin = -1;
@@ -1122,8 +1183,8 @@ void Screen::clearSelection()
 void Screen::getSelectionStart(int& column , int& line) const
 {
     if (_selTopLeft != -1) {
-        column = _selTopLeft % _columns;
-        line = _selTopLeft / _columns;
+        column = static_cast<int>(_selTopLeft % _columns);
+        line = static_cast<int>(_selTopLeft / _columns);
     } else {
         column = _cuX + getHistLines();
         line = _cuY + getHistLines();
@@ -1132,8 +1193,8 @@ void Screen::getSelectionStart(int& column , int& line) const
 void Screen::getSelectionEnd(int& column , int& line) const
 {
     if (_selBottomRight != -1) {
-        column = _selBottomRight % _columns;
-        line = _selBottomRight / _columns;
+        column = static_cast<int>(_selBottomRight % _columns);
+        line = static_cast<int>(_selBottomRight / _columns);
     } else {
         column = _cuX + getHistLines();
         line = _cuY + getHistLines();
@@ -1141,7 +1202,9 @@ void Screen::getSelectionEnd(int& column , int& line) const
 }
 void Screen::setSelectionStart(const int x, const int y, const bool blockSelectionMode)
 {
-    _selBegin = loc(x, y);
+    discardSharedImages();
+
+    _selBegin = globalLoc(x, y);
     /* FIXME, HACK to correct for x too far to the right... */
     if (x == _columns) {
         _selBegin--;
@@ -1158,7 +1221,9 @@ void Screen::setSelectionEnd(const int x, const int y)
         return;
     }
 
-    int endPos =  loc(x, y);
+    discardSharedImages();
+
+    qint64 endPos = globalLoc(x, y);
 
     if (endPos < _selBegin) {
         _selTopLeft = endPos;
@@ -1175,13 +1240,13 @@ void Screen::setSelectionEnd(const int x, const int y)
 
     // Normalize the selection in column mode
     if (_blockSelectionMode) {
-        const int topRow = _selTopLeft / _columns;
-        const int topColumn = _selTopLeft % _columns;
-        const int bottomRow = _selBottomRight / _columns;
-        const int bottomColumn = _selBottomRight % _columns;
+        const qint64 topRow = _selTopLeft / _columns;
+        const int topColumn = static_cast<int>(_selTopLeft % _columns);
+        const qint64 bottomRow = _selBottomRight / _columns;
+        const int bottomColumn = static_cast<int>(_selBottomRight % _columns);
 
-        _selTopLeft = loc(qMin(topColumn, bottomColumn), topRow);
-        _selBottomRight = loc(qMax(topColumn, bottomColumn), bottomRow);
+        _selTopLeft = globalLoc(qMin(topColumn, bottomColumn), topRow);
+        _selBottomRight = globalLoc(qMax(topColumn, bottomColumn), bottomRow);
     }
 }
 
@@ -1193,7 +1258,7 @@ bool Screen::isSelected(const int x, const int y) const
                             x <= (_selBottomRight % _columns);
     }
 
-    const int pos = loc(x, y);
+    const qint64 pos = globalLoc(x, y);
     return pos >= _selTopLeft && pos <= _selBottomRight && columnInSelection;
 }
 
@@ -1206,7 +1271,25 @@ QString Screen::selectedText(const DecodingOptions options) const
     return text(_selTopLeft, _selBottomRight, options);
 }
 
-QString Screen::text(int startIndex, int endIndex, const DecodingOptions options) const
+QString Screen::selectedText(const DecodingOptions options, int maxLines) const
+{
+    if (!isSelectionValid()) {
+        return QString();
+    }
+
+    const int top = static_cast<int>(_selTopLeft / _columns);
+
+    QString result;
+    QTextStream stream(&result, QIODevice::ReadWrite);
+    PlainTextDecoder decoder;
+    decoder.begin(&stream);
+    writeToStream(&decoder, _selTopLeft, _selBottomRight, options, top, top + maxLines - 1);
+    decoder.end();
+
+    return result;
+}
+
+QString Screen::text(qint64 startIndex, qint64 endIndex, const DecodingOptions options) const
 {
     QString result;
     QTextStream stream(&result, QIODevice::ReadWrite);
@@ -1242,19 +1325,40 @@ void Screen::writeSelectionToStream(TerminalCharacterDecoder* decoder ,
     writeToStream(decoder, _selTopLeft, _selBottomRight, options);
 }
 
+void Screen::writeSelectionToStream(TerminalCharacterDecoder* decoder,
+                                    const DecodingOptions options,
+                                    int fromLine, int toLine) const
+{
+    if (!isSelectionValid()) {
+        return;
+    }
+    writeToStream(decoder, _selTopLeft, _selBottomRight, options, fromLine, toLine);
+}
+
 void Screen::writeToStream(TerminalCharacterDecoder* decoder,
-                           int startIndex, int endIndex,
+                           qint64 startIndex, qint64 endIndex,
                            const DecodingOptions options) const
 {
-    const int top = startIndex / _columns;
-    const int left = startIndex % _columns;
+    writeToStream(decoder, startIndex, endIndex, options,
+                  0, static_cast<int>(endIndex / _columns));
+}
+
+void Screen::writeToStream(TerminalCharacterDecoder* decoder,
+                           qint64 startIndex, qint64 endIndex,
+                           const DecodingOptions options,
+                           int fromLine, int toLine) const
+{
+    const int top = static_cast<int>(startIndex / _columns);
+    const int left = static_cast<int>(startIndex % _columns);
 
-    const int bottom = endIndex / _columns;
-    const int right = endIndex % _columns;
+    const int bottom = static_cast<int>(endIndex / _columns);
+    const int right = static_cast<int>(endIndex % _columns);
 
     Q_ASSERT(top >= 0 && left >= 0 && bottom >= 0 && right >= 0);
 
-    for (int y = top; y <= bottom; y++) {
+    const int firstLine = qMax(top, fromLine);
+    const int lastLine = qMin(bottom, toLine);
+    for (int y = firstLine; y <= lastLine; y++) {
         int start = 0;
         if (y == top || _blockSelectionMode) {
             start = left;
@@ -1287,6 +1391,18 @@ void Screen::writeToStream(TerminalCharacterDecoder* decoder,
     }
 }
 
+void Screen::readLine(int line, TerminalLine &result) const
+{
+    if (line < _history->getLines()) {
+        _history->readLine(line, result);
+    } else {
+        const int screenLine = qMin(line - _history->getLines(), _screenLinesSize - 1);
+        // shares the cells with the screen line
+        result.cells = _screenLines[screenLine];
+        result.properties = _lineProperties[screenLine];
+    }
+}
+
 int Screen::copyLineToStream(int line ,
                              int start,
                              int count,
@@ -1294,43 +1410,31 @@ int Screen::copyLineToStream(int line ,
                              bool appendNewLine,
                              const DecodingOptions options) const
 {
-    //buffer to hold characters for decoding
-    //the buffer is static to avoid initializing every
-    //element on each call to copyLineToStream
-    //(which is unnecessary since all elements will be overwritten anyway)
-    static const int MAX_CHARS = 1024;
-    static Character characterBuffer[MAX_CHARS];
-
-    Q_ASSERT(count < MAX_CHARS);
+    TerminalLine lineData;
+    readLine(line, lineData);
 
-    LineProperty currentLineProperties = 0;
+    const LineProperty currentLineProperties = lineData.properties;
+    int length = lineData.cells.size();
+    const Character* data = lineData.cells.constData();
 
     //determine if the line is in the history buffer or the screen image
     if (line < _history->getLines()) {
-        const int lineLength = _history->getLineLen(line);
-
         // ensure that start position is before end of line
-        start = qMin(start, qMax(0, lineLength - 1));
+        start = qMin(start, qMax(0, length - 1));
 
         // retrieve line from history buffer.  It is assumed
         // that the history buffer does not store trailing white space
         // at the end of the line, so it does not need to be trimmed here
         if (count == -1) {
-            count = lineLength - start;
+            count = length - start;
         } else {
-            count = qMin(start + count, lineLength) - start;
+            count = qMin(start + count, length) - start;
         }
 
         // safety checks
         Q_ASSERT(start >= 0);
         Q_ASSERT(count >= 0);
-        Q_ASSERT((start + count) <= _history->getLineLen(line));
-
-        _history->getCells(line, start, count, characterBuffer);
-
-        if (_history->isWrappedLine(line)) {
-            currentLineProperties |= LINE_WRAPPED;
-        }
+        Q_ASSERT((start + count) <= length);
     } else {
         if (count == -1) {
             count = _columns - start;
@@ -1338,17 +1442,8 @@ int Screen::copyLineToStream(int line ,
 
         Q_ASSERT(count >= 0);
 
-        int screenLine = line - _history->getLines();
-
-        Q_ASSERT(screenLine <= _screenLinesSize);
-
-        screenLine = qMin(screenLine, _screenLinesSize);
-
-        Character* data = _screenLines[screenLine].data();
-        int length = _screenLines[screenLine].count();
-
         // Don't remove end spaces in lines that wrap
-        if (options.testFlag(TrimTrailingWhitespace) && ((_lineProperties[screenLine] & LINE_WRAPPED) == 0))
+        if (options.testFlag(TrimTrailingWhitespace) && ((currentLineProperties & LINE_WRAPPED) == 0))
         {
             // ignore trailing white space at the end of the line
             for (int i = length-1; i >= 0; i--)
@@ -1361,59 +1456,53 @@ int Screen::copyLineToStream(int line ,
             }
         }
 
-        //retrieve line from screen image
-        for (int i = start; i < qMin(start + count, length); i++) {
-            characterBuffer[i - start] = data[i];
-        }
-
         // count cannot be any greater than length
         count = qBound(0, count, length - start);
-
-        Q_ASSERT(screenLine < _lineProperties.count());
-        currentLineProperties |= _lineProperties[screenLine];
     }
 
-    if (appendNewLine && (count + 1 < MAX_CHARS)) {
-        if ((currentLineProperties & LINE_WRAPPED) != 0) {
-            // do nothing extra when this line is wrapped.
-        } else {
-            // When users ask not to preserve the linebreaks, they usually mean:
-            // `treat LINEBREAK as SPACE, thus joining multiple _lines into
-            // single line in the same way as 'J' does in VIM.`
-            characterBuffer[count] = options.testFlag(PreserveLineBreaks) ? Character('\n') : Character(' ');
-            count++;
-        }
-    }
+    // When users ask not to preserve the linebreaks, they usually mean:
+    // `treat LINEBREAK as SPACE, thus joining multiple _lines into
+    // single line in the same way as 'J' does in VIM.`
+    // Nothing extra is added when this line is wrapped.
+    const bool addNewLineChar = appendNewLine && ((currentLineProperties & LINE_WRAPPED) == 0);
+    const Character newLineChar = options.testFlag(PreserveLineBreaks) ? Character('\n') : Character(' ');
 
     if ((options & TrimLeadingWhitespace) != 0u) {
         int spacesCount = 0;
         for (spacesCount = 0; spacesCount < count; spacesCount++) {
-            if (!QChar(characterBuffer[spacesCount].character).isSpace()) {
+            if (!QChar(data[start + spacesCount].character).isSpace()) {
                 break;
             }
         }
 
+        // the new line character is white space as well
         if (spacesCount >= count) {
             return 0;
         }
 
-        for (int i=0; i < count - spacesCount; i++) {
-            characterBuffer[i] = characterBuffer[i + spacesCount];
-        }
-
+        start += spacesCount;
         count -= spacesCount;
     }
 
     //decode line and write to text stream
-    decoder->decodeLine(characterBuffer,
-                        count, currentLineProperties);
+    if (!addNewLineChar) {
+        decoder->decodeLine(data + start, count, currentLineProperties);
+        return count;
+    }
+
+    // the decoder expects the new line character to be part of the line
+    QVarLengthArray<Character, 256> characterBuffer(count + 1);
+    std::copy(data + start, data + start + count, characterBuffer.data());
+    characterBuffer[count] = newLineChar;
+
+    decoder->decodeLine(characterBuffer.constData(), count + 1, currentLineProperties);
 
-    return count;
+    return count + 1;
 }
 
 void Screen::writeLinesToStream(TerminalCharacterDecoder* decoder, int fromLine, int toLine) const
 {
-    writeToStream(decoder, loc(0, fromLine), loc(_columns - 1, toLine), PreserveLineBreaks);
+    writeToStream(decoder, globalLoc(0, fromLine), globalLoc(_columns - 1, toLine), PreserveLineBreaks);
 }
 
 void Screen::addHistLine()
@@ -1426,6 +1515,7 @@ void Screen::addHistLine()
 
         _history->addCellsVector(_screenLines[0]);
         _history->addLine((_lineProperties[0] & LINE_WRAPPED) != 0);
+        _historyLinesAdded++;
 
         const int newHistLines = _history->getLines();
 
@@ -1447,7 +1537,7 @@ void Screen::addHistLine()
 
         if (_selBegin != -1) {
             // Scroll selection in history up
-            const int top_BR = loc(0, 1 + newHistLines);
+            const qint64 top_BR = globalLoc(0, 1 + newHistLines);
 
             if (_selTopLeft < top_BR) {
                 _selTopLeft -= _columns;
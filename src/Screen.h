@@ -32,6 +32,8 @@
 
 // Konsole
 #include "Character.h"
+#include "ScreenImage.h"
+#include "konsoleemulation_export.h"
 
 #define MODE_Origin    0
 #define MODE_Wrap      1
@@ -70,7 +72,7 @@ class HistoryScroll;
     using selectedText().  When getImage() is used to retrieve the visible image,
     characters which are part of the selection have their colors inverted.
 */
-class Screen
+class KONSOLEEMULATION_EXPORT Screen
 {
 public:
     /* PlainText: Return plain text (default)
@@ -394,6 +396,23 @@ public:
      */
     QVector<LineProperty> getLineProperties(int startLine, int endLine) const;
 
+    /**
+     * Returns a snapshot of @p lines lines of the screen and history,
+     * starting with @p startLine.  Lines beyond the end of the screen are
+     * blank.
+     *
+     * The snapshot is shared with other callers asking for the same lines
+     * until discardSharedImages() is called.
+     */
+    ScreenImagePtr sharedImage(int startLine, int lines);
+
+    /**
+     * Makes sharedImage() take new snapshots.  This must be called when
+     * the contents of the screen changed.  Changes of the size or the
+     * selection discard the snapshots automatically.
+     */
+    void discardSharedImages();
+
     /** Return the number of lines. */
     int getLines() const
     {
@@ -466,13 +485,20 @@ public:
      */
     QString selectedText(const DecodingOptions options) const;
 
+    /**
+     * Returns the plain text of the first @p maxLines lines of the
+     * selection.
+     * @param options See Screen::DecodingOptions
+     */
+    QString selectedText(const DecodingOptions options, int maxLines) const;
+
     /**
      * Convenience method.  Returns the text between two indices.
      * @param startIndex Specifies the starting text index
      * @param endIndex Specifies the ending text index
      * @param options See Screen::DecodingOptions
      */
-    QString text(int startIndex, int endIndex, const DecodingOptions options) const;
+    QString text(qint64 startIndex, qint64 endIndex, const DecodingOptions options) const;
 
     /**
      * Copies part of the output to a stream.
@@ -483,6 +509,21 @@ public:
      */
     void writeLinesToStream(TerminalCharacterDecoder *decoder, int fromLine, int toLine) const;
 
+    /**
+     * Reads the cells and properties of a line.
+     *
+     * Lines on the screen share their cells with the screen, lines in the
+     * history are read from it, so lines of any length can be read without
+     * copying them into a buffer first.  Reading does not change the screen
+     * or the history, so lines may be read from different threads as long
+     * as the screen does not change meanwhile.
+     *
+     * @param line The line to read, from 0 (the earliest line in the history)
+     * up to getHistLines() + getLines() - 1
+     * @param result The line's cells and properties
+     */
+    void readLine(int line, TerminalLine &result) const;
+
     /**
      * Copies the selected characters, set using @see setSelBeginXY and @see setSelExtentXY
      * into a stream.
@@ -494,6 +535,20 @@ public:
      */
     void writeSelectionToStream(TerminalCharacterDecoder *decoder, const DecodingOptions options) const;
 
+    /**
+     * Copies the selected characters on lines @p fromLine to @p toLine
+     * into a stream.  Calling this for consecutive ranges of lines
+     * produces the same output as copying the whole selection at once,
+     * which allows large selections to be copied in parts.
+     *
+     * @param decoder A decoder which converts terminal characters into text.
+     * @param options See Screen::DecodingOptions
+     * @param fromLine The first line to copy
+     * @param toLine The last line to copy
+     */
+    void writeSelectionToStream(TerminalCharacterDecoder *decoder, const DecodingOptions options,
+                                int fromLine, int toLine) const;
+
     /**
      * Checks if the text between from and to is inside the current
      * selection. If this is the case, the selection is cleared. The
@@ -565,6 +620,26 @@ public:
      */
     void resetDroppedLines();
 
+    /**
+     * Returns the number of lines which have been added to the history
+     * since the screen was created or resetHistoryLinesAdded() was called.
+     */
+    quint64 historyLinesAdded() const
+    {
+        return _historyLinesAdded;
+    }
+
+    void resetHistoryLinesAdded()
+    {
+        _historyLinesAdded = 0;
+    }
+
+    /** Returns the number of bytes of memory used by the history. */
+    qint64 historyMemoryUsage() const;
+
+    /** Returns the number of bytes of disk space used by the history. */
+    qint64 historyDiskUsage() const;
+
     /**
       * Fills the buffer @p dest with @p count instances of the default (ie. blank)
       * Character style.
@@ -640,9 +715,12 @@ private:
 
     bool isSelectionValid() const;
     // copies text from 'startIndex' to 'endIndex' to a stream
-    // startIndex and endIndex are positions generated using the loc(x,y) macro
-    void writeToStream(TerminalCharacterDecoder *decoder, int startIndex, int endIndex,
+    // startIndex and endIndex are positions generated using the globalLoc(x,y) macro
+    void writeToStream(TerminalCharacterDecoder *decoder, qint64 startIndex, qint64 endIndex,
                        const DecodingOptions options) const;
+    // as above, but only copies the part of the text on lines 'fromLine' to 'toLine'
+    void writeToStream(TerminalCharacterDecoder *decoder, qint64 startIndex, qint64 endIndex,
+                       const DecodingOptions options, int fromLine, int toLine) const;
     // copies 'count' lines from the screen buffer into 'dest',
     // starting from 'startLine', where 0 is the first line in the screen buffer
     void copyFromScreen(Character *dest, int startLine, int count) const;
@@ -662,6 +740,7 @@ private:
     QRect _lastScrolledRegion;
 
     int _droppedLines;
+    quint64 _historyLinesAdded;
 
     QVarLengthArray<LineProperty, 64> _lineProperties;
 
@@ -690,9 +769,9 @@ private:
     QBitArray _tabStops;
 
     // selection -------------------
-    int _selBegin; // The first location selected.
-    int _selTopLeft;    // TopLeft Location.
-    int _selBottomRight;    // Bottom Right Location.
+    qint64 _selBegin; // The first location selected.
+    qint64 _selTopLeft;    // TopLeft Location.
+    qint64 _selBottomRight;    // Bottom Right Location.
     bool _blockSelectionMode;  // Column selection mode
 
     // effective colors and rendition ------------
@@ -725,6 +804,9 @@ private:
 
     // used in REP (repeating char)
     quint32 _lastDrawnChar;
+
+    // snapshots handed out by sharedImage() which are still in use
+    QList<QWeakPointer<const ScreenImage> > _sharedImages;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Screen::DecodingOptions)
@@ -0,0 +1,111 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "ScreenImage.h"
+
+// Qt
+#include <QTextStream>
+
+// Konsole
+#include "TerminalCharacterDecoder.h"
+
+using namespace Konsole;
+
+ScreenImage::ScreenImage(int startLine, int lines, int columns) :
+    _startLine(startLine),
+    _lines(lines),
+    _columns(columns),
+    _characters(lines * columns),
+    _lineProperties(lines),
+    _textDecoded(false)
+{
+}
+
+int ScreenImage::startLine() const
+{
+    return _startLine;
+}
+
+int ScreenImage::lines() const
+{
+    return _lines;
+}
+
+int ScreenImage::columns() const
+{
+    return _columns;
+}
+
+const Character *ScreenImage::characters() const
+{
+    return _characters.constData();
+}
+
+const QVector<LineProperty> &ScreenImage::lineProperties() const
+{
+    return _lineProperties;
+}
+
+const QString &ScreenImage::text() const
+{
+    decodeText();
+    return _text;
+}
+
+const QList<int> &ScreenImage::linePositions() const
+{
+    decodeText();
+    return _linePositions;
+}
+
+void ScreenImage::decodeText() const
+{
+    if (_textDecoded) {
+        return;
+    }
+    _textDecoded = true;
+
+    PlainTextDecoder decoder;
+    decoder.setLeadingWhitespace(true);
+    decoder.setTrailingWhitespace(true);
+
+    QTextStream lineStream(&_text);
+    decoder.begin(&lineStream);
+
+    for (int i = 0; i < _lines; i++) {
+        _linePositions.append(_text.length());
+        decoder.decodeLine(_characters.constData() + i * _columns, _columns, LINE_DEFAULT);
+
+        // pretend that each line ends with a newline character.
+        // this prevents a link that occurs at the end of one line
+        // being treated as part of a link that occurs at the start of the next line
+        //
+        // the downside is that links which are spread over more than one line are not
+        // highlighted.
+        //
+        // TODO - Use the "line wrapped" attribute associated with lines in a
+        // terminal image to avoid adding this imaginary character for wrapped
+        // lines
+        if ((_lineProperties.value(i, LINE_DEFAULT) & LINE_WRAPPED) == 0) {
+            lineStream << QLatin1Char('\n');
+        }
+    }
+    decoder.end();
+}
@@ -0,0 +1,94 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef SCREENIMAGE_H
+#define SCREENIMAGE_H
+
+// Qt
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+// Konsole
+#include "Character.h"
+#include "konsoleemulation_export.h"
+
+namespace Konsole {
+/**
+ * A snapshot of some lines of a screen, as shown by a screen window.
+ *
+ * Snapshots are created by Screen::sharedImage() and shared between all
+ * the windows which show the same lines of the screen, until the screen
+ * changes.  A session shown in several views therefore copies the lines
+ * from the screen and decodes their text for the filters only once.
+ *
+ * A snapshot never changes after it has been created.
+ */
+class KONSOLEEMULATION_EXPORT ScreenImage
+{
+public:
+    /** Returns the index of the first line of the screen in the snapshot */
+    int startLine() const;
+    /** Returns the number of lines in the snapshot */
+    int lines() const;
+    /** Returns the number of columns in the snapshot */
+    int columns() const;
+
+    /**
+     * Returns the characters of the snapshot, lines() * columns() of them.
+     * Lines beyond the end of the screen are filled with blank characters.
+     */
+    const Character *characters() const;
+
+    /** Returns the properties of the lines in the snapshot */
+    const QVector<LineProperty> &lineProperties() const;
+
+    /**
+     * Returns the text of the snapshot, decoded on first use.  Each line
+     * is followed by a newline character unless it is wrapped, so that
+     * filters do not match text across lines which are not joined.
+     */
+    const QString &text() const;
+
+    /** Returns the position in text() at which each line starts */
+    const QList<int> &linePositions() const;
+
+private:
+    friend class Screen;
+
+    ScreenImage(int startLine, int lines, int columns);
+    void decodeText() const;
+
+    int _startLine;
+    int _lines;
+    int _columns;
+    QVector<Character> _characters;
+    QVector<LineProperty> _lineProperties;
+
+    // decoded text and line positions, see text()
+    mutable QString _text;
+    mutable QList<int> _linePositions;
+    mutable bool _textDecoded;
+};
+
+typedef QSharedPointer<const ScreenImage> ScreenImagePtr;
+}
+
+#endif // SCREENIMAGE_H
@@ -22,14 +22,13 @@
 
 // Konsole
 #include "Screen.h"
+#include "Tracer.h"
 
 using namespace Konsole;
 
 ScreenWindow::ScreenWindow(Screen *screen, QObject *parent) :
     QObject(parent),
     _screen(nullptr),
-    _windowBuffer(nullptr),
-    _windowBufferSize(0),
     _bufferNeedsUpdate(true),
     _windowLines(1),
     _currentLine(0),
@@ -42,7 +41,6 @@ ScreenWindow::ScreenWindow(Screen *screen, QObject *parent) :
 
 ScreenWindow::~ScreenWindow()
 {
-    delete[] _windowBuffer;
 }
 
 void ScreenWindow::setScreen(Screen *screen)
@@ -50,6 +48,7 @@ void ScreenWindow::setScreen(Screen *screen)
     Q_ASSERT(screen);
 
     _screen = screen;
+    _bufferNeedsUpdate = true;
 }
 
 Screen *ScreenWindow::screen() const
@@ -57,49 +56,25 @@ Screen *ScreenWindow::screen() const
     return _screen;
 }
 
-Character *ScreenWindow::getImage()
+const Character *ScreenWindow::getImage()
 {
-    // reallocate internal buffer if the window size has changed
-    int size = windowLines() * windowColumns();
-    if (_windowBuffer == nullptr || _windowBufferSize != size) {
-        delete[] _windowBuffer;
-        _windowBufferSize = size;
-        _windowBuffer = new Character[size];
-        _bufferNeedsUpdate = true;
-    }
-
-    if (!_bufferNeedsUpdate) {
-        return _windowBuffer;
-    }
-
-    _screen->getImage(_windowBuffer, size,
-                      currentLine(), endWindowLine());
-
-    // this window may look beyond the end of the screen, in which
-    // case there will be an unused area which needs to be filled
-    // with blank characters
-    fillUnusedArea();
-
-    _bufferNeedsUpdate = false;
-    return _windowBuffer;
+    return snapshot()->characters();
 }
 
-void ScreenWindow::fillUnusedArea()
+ScreenImagePtr ScreenWindow::snapshot()
 {
-    int screenEndLine = _screen->getHistLines() + _screen->getLines() - 1;
-    int windowEndLine = currentLine() + windowLines() - 1;
+    KONSOLE_TRACE_SCOPE("ScreenWindow::snapshot");
 
-    int unusedLines = windowEndLine - screenEndLine;
-
-    // stop when unusedLines is negative; there is an issue w/ charsToFill
-    //  being greater than an int can hold
-    if (unusedLines <= 0) {
-        return;
+    // take a new snapshot if the output or the window size has changed
+    if (_snapshot.isNull() || _bufferNeedsUpdate
+            || _snapshot->startLine() != currentLine()
+            || _snapshot->lines() != windowLines()
+            || _snapshot->columns() != windowColumns()) {
+        _snapshot = _screen->sharedImage(currentLine(), windowLines());
+        _bufferNeedsUpdate = false;
     }
 
-    int charsToFill = unusedLines * windowColumns();
-
-    Screen::fillWithDefaultChar(_windowBuffer + _windowBufferSize - charsToFill, charsToFill);
+    return _snapshot;
 }
 
 // return the index of the line at the end of this window, or if this window
@@ -117,13 +92,7 @@ int ScreenWindow::endWindowLine() const
 
 QVector<LineProperty> ScreenWindow::getLineProperties()
 {
-    QVector<LineProperty> result = _screen->getLineProperties(currentLine(), endWindowLine());
-
-    if (result.count() != windowLines()) {
-        result.resize(windowLines());
-    }
-
-    return result;
+    return snapshot()->lineProperties();
 }
 
 QString ScreenWindow::selectedText(const Screen::DecodingOptions options) const
@@ -48,7 +48,7 @@ namespace Konsole {
  * be called.  This in turn will update the window's position and emit the outputChanged() signal
  * if necessary.
  */
-class ScreenWindow : public QObject
+class KONSOLEEMULATION_EXPORT ScreenWindow : public QObject
 {
     Q_OBJECT
 
@@ -77,7 +77,14 @@ public:
      * The returned buffer is managed by the ScreenWindow instance and does not need to be
      * deleted by the caller.
      */
-    Character *getImage();
+    const Character *getImage();
+
+    /**
+     * Returns the snapshot of the screen which is currently visible through this
+     * window.  Windows showing the same lines of a screen share the snapshot,
+     * see Screen::sharedImage()
+     */
+    ScreenImagePtr snapshot();
 
     /**
      * Returns the line attributes associated with the lines of characters which
@@ -261,11 +268,9 @@ private:
     Q_DISABLE_COPY(ScreenWindow)
 
     int endWindowLine() const;
-    void fillUnusedArea();
 
     Screen *_screen; // see setScreen() , screen()
-    Character *_windowBuffer;
-    int _windowBufferSize;
+    ScreenImagePtr _snapshot;
     bool _bufferNeedsUpdate;
 
     int _windowLines;
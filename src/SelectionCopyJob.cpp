@@ -0,0 +1,156 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "SelectionCopyJob.h"
+
+// Qt
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QMimeData>
+
+// Konsole
+#include "ScreenWindow.h"
+
+using namespace Konsole;
+
+namespace {
+// number of lines decoded between checks of the time spent
+const int LINES_PER_STEP = 256;
+// time in milliseconds spent decoding before returning to the event loop
+const int TIME_PER_SLICE = 10;
+}
+
+SelectionCopyJob::SelectionCopyJob(ScreenWindow *window, Screen::DecodingOptions options,
+                                   bool copyHtml, const QList<QClipboard::Mode> &modes,
+                                   QObject *parent) :
+    QObject(parent),
+    _window(window),
+    _screen(window->screen()),
+    _options(options),
+    _copyHtml(copyHtml),
+    _modes(modes),
+    _startColumn(0),
+    _startLine(0),
+    _endColumn(0),
+    _endLine(0),
+    _nextLine(0),
+    _running(false),
+    _textStream(&_text, QIODevice::ReadWrite),
+    _htmlStream(&_html, QIODevice::ReadWrite)
+{
+    _timer.setSingleShot(true);
+    _timer.setInterval(0);
+    connect(&_timer, &QTimer::timeout, this, &Konsole::SelectionCopyJob::copyLines);
+}
+
+void SelectionCopyJob::start()
+{
+    Q_ASSERT(!_running);
+
+    _running = true;
+    _screen->getSelectionStart(_startColumn, _startLine);
+    _screen->getSelectionEnd(_endColumn, _endLine);
+    _nextLine = _startLine;
+
+    _textDecoder.begin(&_textStream);
+    if (_copyHtml) {
+        _htmlDecoder.begin(&_htmlStream);
+    }
+
+    _timer.start();
+}
+
+bool SelectionCopyJob::isRunning() const
+{
+    return _running;
+}
+
+bool SelectionCopyJob::selectionChanged() const
+{
+    if (_window.isNull() || _window->screen() != _screen) {
+        return true;
+    }
+
+    int startColumn;
+    int startLine;
+    int endColumn;
+    int endLine;
+    _screen->getSelectionStart(startColumn, startLine);
+    _screen->getSelectionEnd(endColumn, endLine);
+    return startColumn != _startColumn || startLine != _startLine
+           || endColumn != _endColumn || endLine != _endLine;
+}
+
+void SelectionCopyJob::copyLines()
+{
+    if (selectionChanged()) {
+        finish(true);
+        return;
+    }
+
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+
+    while (_nextLine <= _endLine && sliceTimer.elapsed() < TIME_PER_SLICE) {
+        const int lastLine = qMin(_nextLine + LINES_PER_STEP - 1, _endLine);
+        _screen->writeSelectionToStream(&_textDecoder, _options, _nextLine, lastLine);
+        if (_copyHtml) {
+            _screen->writeSelectionToStream(&_htmlDecoder, _options, _nextLine, lastLine);
+        }
+        _nextLine = lastLine + 1;
+    }
+
+    if (_nextLine <= _endLine) {
+        _timer.start();
+        return;
+    }
+
+    _textDecoder.end();
+    if (_copyHtml) {
+        _htmlDecoder.end();
+    }
+
+    foreach (QClipboard::Mode mode, _modes) {
+        auto mimeData = new QMimeData;
+        mimeData->setText(_text);
+        if (_copyHtml) {
+            mimeData->setHtml(_html);
+        }
+        QApplication::clipboard()->setMimeData(mimeData, mode);
+    }
+
+    finish(false);
+}
+
+void SelectionCopyJob::cancel()
+{
+    if (_running) {
+        finish(true);
+    }
+}
+
+void SelectionCopyJob::finish(bool canceled)
+{
+    _running = false;
+    _timer.stop();
+
+    emit finished(canceled);
+    deleteLater();
+}
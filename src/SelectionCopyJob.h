@@ -0,0 +1,111 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef SELECTIONCOPYJOB_H
+#define SELECTIONCOPYJOB_H
+
+// Qt
+#include <QClipboard>
+#include <QObject>
+#include <QPointer>
+#include <QTextStream>
+#include <QTimer>
+
+// Konsole
+#include "konsoleprivate_export.h"
+#include "Screen.h"
+#include "TerminalCharacterDecoder.h"
+
+namespace Konsole {
+class ScreenWindow;
+
+/**
+ * Copies a large selection to the clipboard a few thousand lines at a
+ * time, returning to the event loop in between so that the user
+ * interface stays responsive.
+ *
+ * The screen and its history belong to the GUI thread and change with
+ * every block of output, so the text is not decoded on another thread.
+ * Instead the selection must stay the same while the job runs: the
+ * owner of the job is expected to hold back output from the terminal
+ * program, and the job is canceled if the selection changes anyway.
+ */
+class KONSOLEPRIVATE_EXPORT SelectionCopyJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Constructs a job which copies the selection of @p window's screen
+     * into the clipboards given by @p modes.
+     *
+     * @param options See Screen::DecodingOptions
+     * @param copyHtml If true, an HTML version of the text is copied as well
+     */
+    SelectionCopyJob(ScreenWindow *window, Screen::DecodingOptions options, bool copyHtml,
+                     const QList<QClipboard::Mode> &modes, QObject *parent = nullptr);
+
+    /** Starts decoding the selection. */
+    void start();
+
+    /** Returns true if the job has been started and not finished yet */
+    bool isRunning() const;
+
+public Q_SLOTS:
+    /** Stops the job without changing the clipboard */
+    void cancel();
+
+Q_SIGNALS:
+    /**
+     * Emitted when the job has stored the text in the clipboard or was
+     * canceled.  The job deletes itself afterwards.
+     */
+    void finished(bool canceled);
+
+private Q_SLOTS:
+    void copyLines();
+
+private:
+    bool selectionChanged() const;
+    void finish(bool canceled);
+
+    QPointer<ScreenWindow> _window;
+    Screen *_screen;
+    Screen::DecodingOptions _options;
+    bool _copyHtml;
+    QList<QClipboard::Mode> _modes;
+
+    int _startColumn;
+    int _startLine;
+    int _endColumn;
+    int _endLine;
+    int _nextLine;
+    bool _running;
+
+    QString _text;
+    QString _html;
+    QTextStream _textStream;
+    QTextStream _htmlStream;
+    PlainTextDecoder _textDecoder;
+    HTMLDecoder _htmlDecoder;
+    QTimer _timer;
+};
+}
+
+#endif // SELECTIONCOPYJOB_H
@@ -44,6 +44,7 @@
 #include <KShell>
 #include <KProcess>
 #include <KConfigGroup>
+#include <KPtyDevice>
 
 // Konsole
 #include <sessionadaptor.h>
@@ -59,6 +60,11 @@
 #include "SessionManager.h"
 #include "ProfileManager.h"
 #include "Profile.h"
+#include "SessionRecorder.h"
+#include "Tracer.h"
+#include "LatencyProbe.h"
+#include "PasteJob.h"
+#include "KonsoleSettings.h"
 
 using namespace Konsole;
 
@@ -67,6 +73,20 @@ static bool show_disallow_certain_dbus_methods_message = true;
 
 static const int ZMODEM_BUFFER_SIZE = 1048576; // 1 Mb
 
+// input copied to the sessions of a group waits in the group while the
+// teletype of a session has more than this number of bytes left to write
+static const qint64 MAX_PENDING_GROUP_INPUT = 64 * 1024;
+// input copied to a session is dropped once this much is waiting for it,
+// and from then on until the user resumes the copying
+static const qint64 MAX_QUEUED_GROUP_INPUT = 1048576; // 1 Mb
+
+// Avoid recursive calls among session groups!
+// A recursive call happens when a master in group A calls forwardData()
+// in group B. If one of the destination sessions in group B is also a
+// master of a group including the master session of group A, this would
+// again call forwardData() in group A, and so on.
+static bool forwardingGroupInput = false;
+
 Session::Session(QObject* parent) :
     QObject(parent)
     , _uniqueIdentifier(QUuid())
@@ -79,6 +99,7 @@ Session::Session(QObject* parent) :
     , _silenceSeconds(10)
     , _silenceTimer(nullptr)
     , _activityTimer(nullptr)
+    , _resizeTimer(nullptr)
     , _autoClose(true)
     , _closePerUserRequest(false)
     , _nameTitle(QString())
@@ -105,16 +126,24 @@ Session::Session(QObject* parent) :
     , _zmodemProc(nullptr)
     , _zmodemProgress(nullptr)
     , _hasDarkBackground(false)
+    , _defaultWindowId(0)
     , _preferredSize(QSize())
     , _readOnly(false)
     , _isPrimaryScreen(true)
+    , _recorder(nullptr)
+    , _replayer(nullptr)
+    , _lastReplayTime(-1)
+    , _performanceDumpTimer(nullptr)
+    , _latencyProbeEnabled(false)
+    , _pasteJob(nullptr)
+    , _queuedInput(0)
+    , _droppedInput(0)
 {
     _uniqueIdentifier = QUuid::createUuid();
 
     //prepare DBus communication
     new SessionAdaptor(this);
     _sessionId = ++lastSessionId;
-    QDBusConnection::sessionBus().registerObject(QLatin1String("/Sessions/") + QString::number(_sessionId), this);
 
     //create emulation backend
     _emulation = new Vt102Emulation();
@@ -142,6 +171,10 @@ Session::Session(QObject* parent) :
     _activityTimer = new QTimer(this);
     _activityTimer->setSingleShot(true);
     connect(_activityTimer, &QTimer::timeout, this, &Konsole::Session::activityTimerDone);
+
+    _resizeTimer = new QTimer(this);
+    _resizeTimer->setSingleShot(true);
+    connect(_resizeTimer, &QTimer::timeout, this, &Konsole::Session::commitPendingResize);
 }
 
 Session::~Session()
@@ -151,6 +184,7 @@ Session::~Session()
     delete _emulation;
     delete _shellProcess;
     delete _zmodemProc;
+    delete _recorder;
 }
 
 void Session::openTeletype(int fd)
@@ -173,6 +207,7 @@ void Session::openTeletype(int fd)
     // connect the I/O between emulator and pty process
     connect(_shellProcess, &Konsole::Pty::receivedData, this, &Konsole::Session::onReceiveBlock);
     connect(_emulation, &Konsole::Emulation::sendData, _shellProcess, &Konsole::Pty::sendData);
+    connect(_shellProcess, &Konsole::Pty::inputWritten, this, &Konsole::Session::inputWritten);
 
     // UTF8 mode
     connect(_emulation, &Konsole::Emulation::useUtf8Request, _shellProcess, &Konsole::Pty::setUtf8Mode);
@@ -195,13 +230,13 @@ WId Session::windowId() const
     // Sessions can have multiple views or no views, which means
     // that a single ID is not always going to be accurate.
     //
-    // If there are no views, the window ID is just 0.  If
-    // there are multiple views, then the window ID for the
-    // top-level window which contains the first view is
-    // returned
+    // If there are no views, the window ID is the one set with
+    // setDefaultWindowId(), usually 0.  If there are multiple views,
+    // then the window ID for the top-level window which contains the
+    // first view is returned
 
     if (_views.count() == 0) {
-        return 0;
+        return _defaultWindowId;
     } else {
         QWidget* window = _views.first();
 
@@ -220,9 +255,16 @@ void Session::setDarkBackground(bool darkBackground)
     _hasDarkBackground = darkBackground;
 }
 
+void Session::setDefaultWindowId(WId id)
+{
+    _defaultWindowId = id;
+}
+
 bool Session::isRunning() const
 {
-    return (_shellProcess != nullptr) && (_shellProcess->state() == QProcess::Running);
+    // a program which is still being started counts as running, so that it
+    // is not started twice
+    return (_shellProcess != nullptr) && (_shellProcess->state() != QProcess::NotRunning);
 }
 
 void Session::setCodec(QTextCodec* codec)
@@ -330,6 +372,23 @@ void Session::addView(TerminalDisplay* widget)
 
     connect(_emulation, &Konsole::Emulation::setCursorStyleRequest, widget, &Konsole::TerminalDisplay::setCursorStyle);
     connect(_emulation, &Konsole::Emulation::resetCursorStyleRequest, widget, &Konsole::TerminalDisplay::resetCursorStyle);
+
+    widget->setLatencyProbeEnabled(_latencyProbeEnabled);
+
+    connect(widget, &Konsole::TerminalDisplay::pasteRequested, this, &Konsole::Session::paste);
+    connect(widget, &Konsole::TerminalDisplay::pasteCancelRequested, this, &Konsole::Session::cancelPaste);
+    connect(widget, &Konsole::TerminalDisplay::resumeGroupInputRequested, this, &Konsole::Session::resumeGroupInputRequested);
+    connect(widget, &Konsole::TerminalDisplay::copyInProgress, this, [this, widget](bool inProgress) {
+        _viewsHoldingOutput.removeAll(widget);
+        if (inProgress) {
+            _viewsHoldingOutput.append(widget);
+        }
+        updateOutputHold();
+    });
+    if (_pasteJob != nullptr) {
+        widget->setPasteProgress(_pasteJob->percent());
+    }
+    widget->setInputLag(_queuedInput, _droppedInput);
 }
 
 void Session::viewDestroyed(QObject* view)
@@ -345,6 +404,10 @@ void Session::removeView(TerminalDisplay* widget)
 {
     _views.removeAll(widget);
 
+    if (_viewsHoldingOutput.removeAll(widget) > 0) {
+        updateOutputHold();
+    }
+
     disconnect(widget, nullptr, this, nullptr);
 
     // disconnect
@@ -496,11 +559,26 @@ void Session::run()
         return;
     }
 
+    // the program is executed in the background, report if that fails
+    connect(_shellProcess, &Konsole::Pty::errorOccurred, this, &Konsole::Session::shellProcessError,
+            Qt::UniqueConnection);
+
     _shellProcess->setWriteable(false);  // We are reachable via kwrited.
 
     emit started();
 }
 
+void Session::shellProcessError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart) {
+        return;
+    }
+
+    const QStringList program = _shellProcess->program();
+    terminalWarning(i18n("Could not start program '%1' with arguments '%2'.", program.value(0), program.mid(1).join(QLatin1String(" "))));
+    terminalWarning(_shellProcess->errorString());
+}
+
 void Session::setSessionAttribute(int what, const QString& caption)
 {
     // set to true if anything has actually changed
@@ -729,9 +807,45 @@ void Session::activityStateSet(int state)
 
 void Session::onViewSizeChange(int /*height*/, int /*width*/)
 {
+    // while a window or a splitter is dragged, the views change their size
+    // many times a second.  Each new terminal size makes the program in the
+    // terminal redraw its screen, so the terminal is only resized when the
+    // size has not changed for a moment or the mouse button is released.
+    //
+    // before the shell runs there is nothing to redraw, and the first size
+    // of the terminal is what starts the shell, see openTeletype()
+    const int delay = KonsoleSettings::resizeSettleDelay();
+    if (delay <= 0 || !isRunning()) {
+        commitPendingResize();
+        return;
+    }
+
+    if (!_resizeTimer->isActive()) {
+        qApp->installEventFilter(this);
+    }
+    _resizeTimer->start(delay);
+}
+
+void Session::commitPendingResize()
+{
+    if (_resizeTimer->isActive()) {
+        _resizeTimer->stop();
+    }
+    qApp->removeEventFilter(this);
+
     updateTerminalSize();
 }
 
+bool Session::eventFilter(QObject *watched, QEvent *event)
+{
+    // the application's events are only watched while a resize is pending
+    if (event->type() == QEvent::MouseButtonRelease && _resizeTimer->isActive()) {
+        commitPendingResize();
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
 void Session::updateTerminalSize()
 {
     int minLines = -1;
@@ -763,6 +877,10 @@ void Session::updateWindowSize(int lines, int columns)
 {
     Q_ASSERT(lines > 0 && columns > 0);
     _shellProcess->setWindowSize(columns, lines);
+
+    if (_recorder != nullptr) {
+        _recorder->recordResize(columns, lines);
+    }
 }
 void Session::refresh()
 {
@@ -902,6 +1020,80 @@ void Session::sendTextToTerminal(const QString& text, const QChar& eol) const
     }
 }
 
+void Session::updateOutputHold()
+{
+    // stop reading from the pty, the terminal program blocks once the
+    // pty's buffer is full
+    _shellProcess->pty()->setSuspended(!_viewsHoldingOutput.isEmpty());
+}
+
+void Session::paste(const QString &text, bool bracketed)
+{
+    if (isReadOnly() || text.isEmpty()) {
+        return;
+    }
+
+    _pendingPastes.append(qMakePair(text, bracketed));
+    if (_pasteJob == nullptr) {
+        startNextPaste();
+    }
+}
+
+void Session::startNextPaste()
+{
+    while (_pasteJob == nullptr && !_pendingPastes.isEmpty()) {
+        const QPair<QString, bool> next = _pendingPastes.takeFirst();
+        _pasteJob = new PasteJob(_emulation, _shellProcess, next.first, next.second, this);
+        connect(_pasteJob, &Konsole::PasteJob::progress, this, &Konsole::Session::updatePasteProgress);
+        connect(_pasteJob, &Konsole::PasteJob::finished, this, &Konsole::Session::onPasteFinished);
+        _pasteJob->start();
+    }
+}
+
+void Session::cancelPaste()
+{
+    _pendingPastes.clear();
+    if (_pasteJob != nullptr) {
+        _pasteJob->cancel();
+    }
+}
+
+qint64 Session::pendingInput() const
+{
+    return _shellProcess->pendingInput();
+}
+
+void Session::setInputLag(qint64 queued, qint64 dropped)
+{
+    if (queued == _queuedInput && dropped == _droppedInput) {
+        return;
+    }
+
+    _queuedInput = queued;
+    _droppedInput = dropped;
+    foreach (TerminalDisplay *view, _views) {
+        view->setInputLag(queued, dropped);
+    }
+}
+
+void Session::updatePasteProgress(int percent)
+{
+    foreach (TerminalDisplay *view, _views) {
+        view->setPasteProgress(percent);
+    }
+}
+
+void Session::onPasteFinished()
+{
+    // the job deletes itself
+    _pasteJob = nullptr;
+    if (_pendingPastes.isEmpty()) {
+        updatePasteProgress(-1);
+    } else {
+        startNextPaste();
+    }
+}
+
 // Only D-Bus calls this function (via SendText or runCommand)
 void Session::sendText(const QString& text) const
 {
@@ -1008,6 +1200,11 @@ int Session::sessionId() const
     return _sessionId;
 }
 
+void Session::registerOnDBus()
+{
+    QDBusConnection::sessionBus().registerObject(QLatin1String("/Sessions/") + QString::number(_sessionId), this);
+}
+
 void Session::setKeyBindings(const QString& name)
 {
     _emulation->setKeyBindings(name);
@@ -1463,6 +1660,10 @@ void Session::zmodemFinished()
 
 void Session::onReceiveBlock(const char* buf, int len)
 {
+    if (_recorder != nullptr) {
+        _recorder->recordData(buf, len);
+    }
+
     _emulation->receiveData(buf, len);
 }
 
@@ -1590,6 +1791,168 @@ void Session::setProfile(const QString &profileName)
   }
 }
 
+bool Session::startRecording(const QString &fileName)
+{
+    if (_recorder == nullptr) {
+        _recorder = new SessionRecorder();
+    }
+
+    const QSize size = _emulation->imageSize();
+    if (!_recorder->open(fileName, size.width(), size.height())) {
+        stopRecording();
+        return false;
+    }
+
+    return true;
+}
+
+void Session::stopRecording()
+{
+    delete _recorder;
+    _recorder = nullptr;
+}
+
+bool Session::isRecording() const
+{
+    return _recorder != nullptr && _recorder->isOpen();
+}
+
+bool Session::replayRecording(const QString &fileName, bool realTime)
+{
+    if (_replayer == nullptr) {
+        _replayer = new SessionReplayer(this);
+        connect(_replayer, &Konsole::SessionReplayer::dataReady, _emulation, &Konsole::Emulation::receiveData);
+        connect(_replayer, &Konsole::SessionReplayer::resizeRequest, this, &Konsole::Session::resizeRequest);
+        connect(_replayer, &Konsole::SessionReplayer::finished, this, &Konsole::Session::onReplayFinished);
+    }
+
+    if (!_replayer->load(fileName)) {
+        return false;
+    }
+
+    _replayer->start(realTime ? SessionReplayer::RealTime : SessionReplayer::AsFastAsPossible);
+    return true;
+}
+
+int Session::lastReplayTime() const
+{
+    return _lastReplayTime;
+}
+
+void Session::onReplayFinished(qint64 msecs)
+{
+    _lastReplayTime = static_cast<int>(msecs);
+    emit replayFinished(_lastReplayTime);
+}
+
+QVariantMap Session::performanceCounters() const
+{
+    quint64 paintEvents = 0;
+    qint64 updateImageTime = 0;
+    qint64 paintTime = 0;
+    foreach (TerminalDisplay *view, _views) {
+        paintEvents += view->paintCount();
+        updateImageTime += view->updateImageTime();
+        paintTime += view->paintTime();
+    }
+
+    QVariantMap counters;
+    counters.insert(QStringLiteral("receivedBytes"), _emulation->receivedBytes());
+    counters.insert(QStringLiteral("decodedCodePoints"), _emulation->decodedCodePoints());
+    counters.insert(QStringLiteral("historyLines"), _emulation->historyLinesAdded());
+    counters.insert(QStringLiteral("bulkUpdates"), _emulation->bulkUpdates());
+    counters.insert(QStringLiteral("paintEvents"), paintEvents);
+    counters.insert(QStringLiteral("suppressedMouseEvents"), _emulation->suppressedMouseEvents());
+    counters.insert(QStringLiteral("parseTime"), _emulation->parseTime() / 1e6);
+    counters.insert(QStringLiteral("updateImageTime"), updateImageTime / 1e6);
+    counters.insert(QStringLiteral("paintTime"), paintTime / 1e6);
+    counters.insert(QStringLiteral("historyMemoryUsage"), _emulation->historyMemoryUsage());
+    counters.insert(QStringLiteral("historyDiskUsage"), _emulation->historyDiskUsage());
+    return counters;
+}
+
+void Session::resetPerformanceCounters()
+{
+    _emulation->resetStatistics();
+    foreach (TerminalDisplay *view, _views) {
+        view->resetStatistics();
+    }
+}
+
+void Session::setPerformanceCountersDumpInterval(int seconds)
+{
+    if (seconds <= 0) {
+        delete _performanceDumpTimer;
+        _performanceDumpTimer = nullptr;
+        return;
+    }
+
+    if (_performanceDumpTimer == nullptr) {
+        _performanceDumpTimer = new QTimer(this);
+        connect(_performanceDumpTimer, &QTimer::timeout, this, &Konsole::Session::dumpPerformanceCounters);
+    }
+    _performanceDumpTimer->start(seconds * 1000);
+}
+
+bool Session::setTracingEnabled(bool enabled)
+{
+#if KONSOLE_ENABLE_TRACING
+    Tracer::setEnabled(enabled);
+    return true;
+#else
+    Q_UNUSED(enabled);
+    return false;
+#endif
+}
+
+bool Session::writeTrace(const QString &fileName, int seconds)
+{
+#if KONSOLE_ENABLE_TRACING
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCDebug(KonsoleDebug) << "Unable to open trace file" << fileName << file.errorString();
+        return false;
+    }
+
+    return Tracer::writeChromeTrace(&file, seconds);
+#else
+    Q_UNUSED(fileName);
+    Q_UNUSED(seconds);
+    return false;
+#endif
+}
+
+void Session::setLatencyProbeEnabled(bool enabled)
+{
+    _latencyProbeEnabled = enabled;
+    foreach (TerminalDisplay *view, _views) {
+        view->setLatencyProbeEnabled(enabled);
+    }
+}
+
+QVariantMap Session::keyLatency() const
+{
+    QVector<qint64> samples;
+    foreach (TerminalDisplay *view, _views) {
+        if (view->latencyProbe() != nullptr) {
+            samples += view->latencyProbe()->samples();
+        }
+    }
+
+    QVariantMap latency;
+    latency.insert(QStringLiteral("samples"), samples.size());
+    latency.insert(QStringLiteral("p50"), LatencyProbe::percentile(samples, 50) / 1e6);
+    latency.insert(QStringLiteral("p99"), LatencyProbe::percentile(samples, 99) / 1e6);
+    latency.insert(QStringLiteral("max"), LatencyProbe::percentile(samples, 100) / 1e6);
+    return latency;
+}
+
+void Session::dumpPerformanceCounters()
+{
+    qCInfo(KonsoleDebug) << "Session" << _sessionId << title(Session::DisplayedTitleRole)
+                         << performanceCounters();
+}
+
 int Session::foregroundProcessId()
 {
     int pid;
@@ -1683,6 +2046,7 @@ void Session::setReadOnly(bool readOnly)
 {
     if (_readOnly != readOnly) {
         _readOnly = readOnly;
+        _emulation->setReadOnly(readOnly);
 
         // Needed to update the tab icons and all
         // attached views.
@@ -1712,13 +2076,20 @@ bool SessionGroup::masterStatus(Session* session) const
 void SessionGroup::addSession(Session* session)
 {
     connect(session, &Konsole::Session::finished, this, &Konsole::SessionGroup::sessionFinished);
+    connect(session, &Konsole::Session::inputWritten, this, &Konsole::SessionGroup::sessionInputWritten);
+    connect(session, &Konsole::Session::resumeGroupInputRequested, this, &Konsole::SessionGroup::resumeGroupInput);
     _sessions.insert(session, false);
 }
 void SessionGroup::removeSession(Session* session)
 {
     disconnect(session, &Konsole::Session::finished, this, &Konsole::SessionGroup::sessionFinished);
+    disconnect(session, &Konsole::Session::inputWritten, this, nullptr);
+    disconnect(session, &Konsole::Session::resumeGroupInputRequested, this, nullptr);
     setMasterStatus(session, false);
     _sessions.remove(session);
+    if (_pendingInput.remove(session) > 0) {
+        session->setInputLag(0, 0);
+    }
 }
 void SessionGroup::sessionFinished()
 {
@@ -1753,22 +2124,96 @@ void SessionGroup::setMasterStatus(Session* session , bool master)
 }
 void SessionGroup::forwardData(const QByteArray& data)
 {
-    static bool _inForwardData = false;
-    if (_inForwardData) {  // Avoid recursive calls among session groups!
-        // A recursive call happens when a master in group A calls forwardData()
-        // in group B. If one of the destination sessions in group B is also a
-        // master of a group including the master session of group A, this would
-        // again call forwardData() in group A, and so on.
+    if (forwardingGroupInput) {
         return;
     }
 
-    _inForwardData = true;
-    const QList<Session*> sessionsKeys = _sessions.keys();
-    foreach(Session* other, sessionsKeys) {
-        if (!_sessions[other]) {
+    // all sessions are sent the same implicitly shared data.  A session
+    // whose terminal program does not keep up with the input gets the
+    // data queued instead, so that it does not hold up the others.  Once
+    // too much is waiting for it, all further data is dropped until the
+    // user resumes the copying, so that no command is sent with parts of
+    // it missing.
+    forwardingGroupInput = true;
+    for (auto iter = _sessions.constBegin(); iter != _sessions.constEnd(); ++iter) {
+        if (iter.value()) {
+            continue;
+        }
+
+        Session *other = iter.key();
+        auto pending = _pendingInput.find(other);
+        if (pending == _pendingInput.end() && other->pendingInput() <= MAX_PENDING_GROUP_INPUT) {
             other->emulation()->sendString(data);
+            continue;
         }
+
+        if (pending == _pendingInput.end()) {
+            pending = _pendingInput.insert(other, PendingInput());
+        }
+        if (pending->dropped == 0 && pending->queued + data.size() <= MAX_QUEUED_GROUP_INPUT) {
+            pending->chunks.append(data);
+            pending->queued += data.size();
+        } else {
+            pending->dropped += data.size();
+        }
+        other->setInputLag(pending->queued, pending->dropped);
+    }
+    forwardingGroupInput = false;
+}
+void SessionGroup::sessionInputWritten()
+{
+    auto* session = qobject_cast<Session*>(sender());
+    Q_ASSERT(session);
+    sendPendingInput(session);
+}
+void SessionGroup::resumeGroupInput()
+{
+    auto* session = qobject_cast<Session*>(sender());
+    Q_ASSERT(session);
+
+    auto pending = _pendingInput.find(session);
+    if (pending == _pendingInput.end()) {
+        return;
+    }
+
+    pending->dropped = 0;
+    if (pending->chunks.isEmpty()) {
+        _pendingInput.erase(pending);
+        session->setInputLag(0, 0);
+    } else {
+        session->setInputLag(pending->queued, 0);
+    }
+}
+void SessionGroup::sendPendingInput(Session* session)
+{
+    auto pending = _pendingInput.find(session);
+    if (pending == _pendingInput.end()) {
+        return;
+    }
+
+    // send the chunks the teletype has room for in one write
+    const qint64 room = MAX_PENDING_GROUP_INPUT - session->pendingInput();
+    QByteArray batch;
+    while (!pending->chunks.isEmpty() && batch.size() + pending->chunks.first().size() <= room) {
+        batch.append(pending->chunks.takeFirst());
+    }
+    if (batch.isEmpty() && !pending->chunks.isEmpty() && session->pendingInput() == 0) {
+        // the chunk is larger than the room, but nothing else is waiting
+        batch = pending->chunks.takeFirst();
+    }
+    pending->queued -= batch.size();
+
+    if (pending->chunks.isEmpty() && pending->dropped == 0) {
+        _pendingInput.erase(pending);
+        session->setInputLag(0, 0);
+    } else {
+        session->setInputLag(pending->queued, pending->dropped);
+    }
+
+    if (!batch.isEmpty()) {
+        forwardingGroupInput = true;
+        session->emulation()->sendString(batch);
+        forwardingGroupInput = false;
     }
-    _inForwardData = false;
 }
 
@@ -32,6 +32,8 @@
 #include <QProcess>
 #include <QWidget>
 #include <QUrl>
+#include <QVariantMap>
+#include <QPair>
 
 // Konsole
 #include "konsoleprivate_export.h"
@@ -50,6 +52,9 @@ class ProcessInfo;
 class TerminalDisplay;
 class ZModemDialog;
 class HistoryType;
+class SessionRecorder;
+class SessionReplayer;
+class PasteJob;
 
 /**
  * Represents a terminal session consisting of a pseudo-teletype and a terminal emulation.
@@ -139,6 +144,13 @@ public:
     /** Returns the unique ID for this session. */
     int sessionId() const;
 
+    /**
+     * Makes the session available on D-Bus as /Sessions/<sessionId()>.
+     * This is done by the SessionManager once the session is listed in
+     * SessionManager::sessions().
+     */
+    void registerOnDBus();
+
     /**
      * This enum describes the contexts for which separate
      * tab title formats may be specified.
@@ -328,6 +340,15 @@ public:
      */
     void setDarkBackground(bool darkBackground);
 
+    /**
+     * Sets the window ID passed to the program in the WINDOWID environment
+     * variable if the session has no views when it is started, as is the
+     * case for the sessions of a SessionPool.
+     *
+     * This has no effect once the session is running.
+     */
+    void setDefaultWindowId(WId id);
+
     /**
      * Attempts to get the shell program to redraw the current display area.
      * This can be used after clearing the screen, for example, to get the
@@ -490,6 +511,38 @@ public Q_SLOTS:
      */
     void sendTextToTerminal(const QString &text, const QChar &eol = QChar()) const;
 
+    /**
+     * Pastes @p text into the terminal a chunk at a time, see PasteJob.
+     * The views show the progress of long pastes and allow canceling
+     * them.  A paste requested while another one is in progress is
+     * sent after it.
+     *
+     * @param bracketed If true, the text is enclosed in the bracketed
+     * paste start and end sequences.
+     */
+    void paste(const QString &text, bool bracketed);
+
+    /** Cancels the paste in progress and any pastes queued after it. */
+    void cancelPaste();
+
+    /**
+     * Returns the number of bytes of input which have not been written
+     * to the terminal yet, see Pty::pendingInput()
+     */
+    qint64 pendingInput() const;
+
+    /**
+     * Shows in the views how much input copied from the other sessions
+     * of a session group waits to be sent, because the terminal program
+     * reads its input slowly.  See SessionGroup.
+     *
+     * @param queued The number of bytes waiting, 0 hides the message
+     * @param dropped The number of bytes discarded since too much input
+     * was waiting.  The views keep showing this until the user resumes
+     * the copying, see resumeGroupInputRequested()
+     */
+    void setInputLag(qint64 queued, qint64 dropped);
+
 #if defined(REMOVE_SENDTEXT_RUNCOMMAND_DBUS_METHODS)
     void sendText(const QString &text) const;
 #else
@@ -593,6 +646,98 @@ public Q_SLOTS:
      */
     Q_SCRIPTABLE void setProfile(const QString &profile);
 
+    /**
+     * Starts recording the output of the terminal program, with the
+     * time each block of output arrived, to @p fileName in asciicast
+     * format.  Any recording already in progress is stopped first.
+     *
+     * Returns false if the file could not be created.
+     */
+    Q_SCRIPTABLE bool startRecording(const QString &fileName);
+
+    /** Stops recording the output of the terminal program. */
+    Q_SCRIPTABLE void stopRecording();
+
+    /** Returns true if the output of this session is being recorded. */
+    Q_SCRIPTABLE bool isRecording() const;
+
+    /**
+     * Plays a recording made with startRecording() through this session's
+     * terminal emulation and views, in addition to any output from the
+     * running program.
+     *
+     * @param fileName The recording to play.
+     * @param realTime If true the original timing of the recording is
+     * reproduced, otherwise the output is fed as fast as possible.
+     *
+     * Returns false if the recording could not be read.
+     */
+    Q_SCRIPTABLE bool replayRecording(const QString &fileName, bool realTime);
+
+    /**
+     * Returns the time in milliseconds taken by the last completed
+     * replayRecording(), or -1 if no replay has completed yet.
+     */
+    Q_SCRIPTABLE int lastReplayTime() const;
+
+    /**
+     * Returns counters describing the work done for this session since it
+     * was created or resetPerformanceCounters() was called:
+     * <ul>
+     * <li> receivedBytes - bytes of output received from the terminal program</li>
+     * <li> decodedCodePoints - unicode characters decoded from that output</li>
+     * <li> historyLines - lines pushed into the history</li>
+     * <li> bulkUpdates - number of times the views were told to update</li>
+     * <li> paintEvents - paint events handled by all views</li>
+     * <li> parseTime, updateImageTime, paintTime - milliseconds spent parsing
+     *      the output, finding the changed parts of the views' images and
+     *      painting the views</li>
+     * <li> historyMemoryUsage, historyDiskUsage - bytes currently used by
+     *      the history</li>
+     * </ul>
+     */
+    Q_SCRIPTABLE QVariantMap performanceCounters() const;
+
+    /** Resets the counters returned by performanceCounters() */
+    Q_SCRIPTABLE void resetPerformanceCounters();
+
+    /**
+     * Writes performanceCounters() to the debug log every @p seconds.
+     * A value of 0 stops the periodic output.
+     */
+    Q_SCRIPTABLE void setPerformanceCountersDumpInterval(int seconds);
+
+    /**
+     * Starts or stops recording the trace points in the output pipeline.
+     * Tracing is shared by all sessions.  It is only available if Konsole
+     * was built with KONSOLE_ENABLE_TRACING; returns false otherwise.
+     */
+    Q_SCRIPTABLE bool setTracingEnabled(bool enabled);
+
+    /**
+     * Writes the trace events recorded during the last @p seconds to
+     * @p fileName in the Chrome trace event format.
+     *
+     * Returns false if Konsole was built without tracing support or the
+     * file could not be written.
+     */
+    Q_SCRIPTABLE bool writeTrace(const QString &fileName, int seconds);
+
+    /**
+     * Enables or disables measuring the time from a key press in one of
+     * the session's views to the repaint which shows the echo.  While
+     * enabled, the views show the latency percentiles in an overlay.
+     */
+    Q_SCRIPTABLE void setLatencyProbeEnabled(bool enabled);
+
+    /**
+     * Returns the key press latencies measured by the views of this
+     * session since the probe was enabled or the performance counters
+     * were reset.  The map contains the number of samples and the
+     * p50, p99 and max latencies in milliseconds.
+     */
+    Q_SCRIPTABLE QVariantMap keyLatency() const;
+
 Q_SIGNALS:
 
     /** Emitted when the terminal process starts. */
@@ -612,6 +757,15 @@ Q_SIGNALS:
     /** Emitted when the session gets locked / unlocked. */
     void readOnlyChanged();
 
+    /** Emitted when input has been written to the terminal, see pendingInput() */
+    void inputWritten();
+
+    /**
+     * Emitted when the user acknowledges in one of the views that input
+     * copied from the other sessions of a group was discarded.
+     */
+    void resumeGroupInputRequested();
+
     /**
      * Emitted when the activity state of this session changes.
      *
@@ -708,6 +862,16 @@ Q_SIGNALS:
      */
     void getBackgroundColor();
 
+    /**
+     * Emitted when a replay started with replayRecording() has finished.
+     *
+     * @param msecs The time taken by the replay in milliseconds.
+     */
+    void replayFinished(int msecs);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) Q_DECL_OVERRIDE;
+
 private Q_SLOTS:
     void done(int, QProcess::ExitStatus);
 
@@ -715,10 +879,13 @@ private Q_SLOTS:
     void fireZModemUploadDetected();
 
     void onReceiveBlock(const char *buf, int len);
+    void shellProcessError(QProcess::ProcessError error);
     void silenceTimerDone();
     void activityTimerDone();
 
     void onViewSizeChange(int height, int width);
+    // resizes the terminal to the settled size of the views
+    void commitPendingResize();
 
     void activityStateSet(int);
 
@@ -738,9 +905,21 @@ private Q_SLOTS:
 
     void sessionAttributeRequest(int id);
 
+    void onReplayFinished(qint64 msecs);
+
+    void dumpPerformanceCounters();
+
+    void updatePasteProgress(int percent);
+    void onPasteFinished();
+
 private:
     Q_DISABLE_COPY(Session)
 
+    void startNextPaste();
+
+    // holds back output while views copy a large selection
+    void updateOutputHold();
+
     // checks that the binary 'program' is available and can be executed
     // returns the binary name if available or an empty string otherwise
     static QString checkProgram(const QString &program);
@@ -774,6 +953,10 @@ private:
     QTimer *_silenceTimer;
     QTimer *_activityTimer;
 
+    // delays resizing the terminal while the views are being resized,
+    // see onViewSizeChange()
+    QTimer *_resizeTimer;
+
     bool _autoClose;
     bool _closePerUserRequest;
 
@@ -811,6 +994,7 @@ private:
     ZModemDialog *_zmodemProgress;
 
     bool _hasDarkBackground;
+    WId _defaultWindowId;
 
     QSize _preferredSize;
 
@@ -818,6 +1002,22 @@ private:
     static int lastSessionId;
 
     bool _isPrimaryScreen;
+
+    SessionRecorder *_recorder;
+    SessionReplayer *_replayer;
+    int _lastReplayTime;
+
+    QTimer *_performanceDumpTimer;
+    bool _latencyProbeEnabled;
+
+    PasteJob *_pasteJob;
+    QList<QPair<QString, bool> > _pendingPastes;
+
+    // see setInputLag()
+    qint64 _queuedInput;
+    qint64 _droppedInput;
+
+    QList<TerminalDisplay *> _viewsHoldingOutput;
 };
 
 /**
@@ -825,6 +1025,16 @@ private:
  * Activity in master sessions can be propagated to all sessions within the group.
  * The type of activity which is propagated and method of propagation is controlled
  * by the masterMode() flags.
+ *
+ * Input copied from the masters waits in the group for sessions whose
+ * terminal program reads its input slowly, so that they do not hold up
+ * the other sessions.  The views of such a session show how much input
+ * is waiting, see Session::setInputLag().
+ *
+ * If too much input is waiting for a session, the input is discarded
+ * from then on, rather than sending the session a command with a
+ * missing middle, until the user resumes the copying in one of the
+ * session's views.
  */
 class SessionGroup : public QObject
 {
@@ -884,13 +1094,31 @@ public:
 private Q_SLOTS:
     void sessionFinished();
     void forwardData(const QByteArray &data);
+    void sessionInputWritten();
+    void resumeGroupInput();
 
 private:
     QList<Session *> masters() const;
+    void sendPendingInput(Session *session);
 
     // maps sessions to their master status
     QHash<Session *, bool> _sessions;
 
+    // input from the masters waiting for a session which is slow to read it.
+    // the chunks share their data with the chunks of the other sessions.
+    struct PendingInput {
+        PendingInput() :
+            queued(0),
+            dropped(0)
+        {
+        }
+
+        QList<QByteArray> chunks;
+        qint64 queued;
+        qint64 dropped;
+    };
+    QHash<Session *, PendingInput> _pendingInput;
+
     int _masterMode;
 };
 }
@@ -32,6 +32,8 @@
 #include <QPrinter>
 #include <QPrintDialog>
 #include <QFileDialog>
+#include <QBuffer>
+#include <QTextStream>
 #include <QPainter>
 #include <QStandardPaths>
 #include <QUrl>
@@ -72,6 +74,7 @@
 #include "SessionManager.h"
 #include "Enumeration.h"
 #include "PrintOptions.h"
+#include "ColorSchemeManager.h"
 
 // for SaveHistoryTask
 #include <KIO/Job>
@@ -205,6 +208,7 @@ SessionController::SessionController(Session* session , TerminalDisplay* view, Q
     connect(_interactionTimer, &QTimer::timeout, this, &Konsole::SessionController::snapshot);
     connect(_view.data(), &Konsole::TerminalDisplay::focusGained, this, &Konsole::SessionController::interactionHandler);
     connect(_view.data(), &Konsole::TerminalDisplay::keyPressedSignal, this, &Konsole::SessionController::interactionHandler);
+    connect(_view.data(), &Konsole::TerminalDisplay::pasteRequested, this, &Konsole::SessionController::interactionHandler);
 
     // take a snapshot of the session state periodically in the background
     auto backgroundTimer = new QTimer(_session);
@@ -1814,6 +1818,10 @@ void SaveHistoryTask::execute()
     mimeTypes << QStringLiteral("text/html");
     dialog->setMimeTypeFilters(mimeTypes);
 
+    QStringList nameFilters = dialog->nameFilters();
+    nameFilters << i18n("Text with ANSI escape sequences (*.ansi)");
+    dialog->setNameFilters(nameFilters);
+
     // iterate over each session in the task and display a dialog to allow the user to choose where
     // to save that session's history.
     // then start a KIO job to transfer the data from the history to the chosen URL
@@ -1855,15 +1863,37 @@ void SaveHistoryTask::execute()
         // has already been sent, and where the next request should continue
         // from.
         // this is set to -1 to indicate the job has just been started
+        jobInfo.lastLine = session->emulation()->lineCount() - 1;
 
-        if (((dialog->selectedNameFilter()).contains(QLatin1String("html"), Qt::CaseInsensitive)) ||
+        if (((dialog->selectedNameFilter()).contains(QLatin1String("*.ansi"), Qt::CaseInsensitive)) ||
+           ((dialog->selectedFiles()).at(0).endsWith(QLatin1String(".ansi"), Qt::CaseInsensitive))) {
+            jobInfo.decoder = new ANSIDecoder();
+        } else if (((dialog->selectedNameFilter()).contains(QLatin1String("html"), Qt::CaseInsensitive)) ||
            ((dialog->selectedFiles()).at(0).endsWith(QLatin1String("html"), Qt::CaseInsensitive))) {
             Profile::Ptr profile = SessionManager::instance()->sessionProfile(session);
-            jobInfo.decoder = new HTMLDecoder(profile);
+            const ColorScheme *colorScheme = ColorSchemeManager::instance()->findColorScheme(profile->colorScheme());
+            if (colorScheme == nullptr) {
+                colorScheme = ColorSchemeManager::instance()->defaultColorScheme();
+            }
+
+            ColorEntry colorTable[TABLE_COLORS];
+            colorScheme->getColorTable(colorTable);
+            auto htmlDecoder = new HTMLDecoder(colorTable, profile->font());
+            htmlDecoder->setStyleClasses(true);
+            jobInfo.decoder = htmlDecoder;
         } else {
             jobInfo.decoder = new PlainTextDecoder();
         }
 
+        jobInfo.buffer = new QBuffer();
+        jobInfo.buffer->open(QIODevice::WriteOnly);
+        jobInfo.stream = new QTextStream(jobInfo.buffer);
+        jobInfo.stream->setCodec("UTF-8");
+
+        // the decoder produces a single document for all requests
+        jobInfo.decoder->begin(jobInfo.stream);
+        jobInfo.ended = false;
+
         _jobSession.insert(job, jobInfo);
 
         connect(job, &KIO::TransferJob::dataReq, this, &Konsole::SaveHistoryTask::jobDataRequested);
@@ -1881,28 +1911,39 @@ void SaveHistoryTask::jobDataRequested(KIO::Job* job , QByteArray& data)
 
     SaveJob& info = _jobSession[job];
 
-    // transfer LINES_PER_REQUEST lines from the session's history
-    // to the save location
-    if (!info.session.isNull()) {
-        // note:  when retrieving lines from the emulation,
-        // the first line is at index 0.
-
-        int sessionLines = info.session->emulation()->lineCount();
-
-        if (sessionLines - 1 == info.lastLineFetched) {
-            return; // if there is no more data to transfer then stop the job
-        }
+    // if there is no more data to transfer then stop the job
+    if (info.ended) {
+        return;
+    }
 
-        int copyUpToLine = qMin(info.lastLineFetched + LINES_PER_REQUEST ,
-                                sessionLines - 1);
+    // note:  when retrieving lines from the emulation,
+    // the first line is at index 0.
+    //
+    // the history may lose lines while it is saved, or the session may
+    // go away, in which case the output ends early
+    const int lastLine = info.session.isNull() ? -1
+                         : qMin(info.lastLine, info.session->emulation()->lineCount() - 1);
 
-        QTextStream stream(&data, QIODevice::ReadWrite);
-        info.decoder->begin(&stream);
+    // transfer LINES_PER_REQUEST lines from the session's history
+    // to the save location
+    if (info.lastLineFetched < lastLine) {
+        const int copyUpToLine = qMin(info.lastLineFetched + LINES_PER_REQUEST ,
+                                      lastLine);
         info.session->emulation()->writeToStream(info.decoder , info.lastLineFetched + 1 , copyUpToLine);
-        info.decoder->end();
-
         info.lastLineFetched = copyUpToLine;
     }
+
+    // every way of finishing the job ends the document, so that it gets
+    // its closing tags or final reset
+    if (info.lastLineFetched >= lastLine) {
+        info.decoder->end();
+        info.ended = true;
+    }
+
+    info.stream->flush();
+    data = info.buffer->data();
+    info.buffer->buffer().clear();
+    info.buffer->seek(0);
 }
 void SaveHistoryTask::jobResult(KJob* job)
 {
@@ -1910,11 +1951,11 @@ void SaveHistoryTask::jobResult(KJob* job)
         KMessageBox::sorry(nullptr , i18n("A problem occurred when saving the output.\n%1", job->errorString()));
     }
 
-    TerminalCharacterDecoder * decoder = _jobSession[job].decoder;
-
-    _jobSession.remove(job);
+    const SaveJob info = _jobSession.take(job);
 
-    delete decoder;
+    delete info.stream;
+    delete info.buffer;
+    delete info.decoder;
 
     // notify the world that the task is done
     emit completed(true);
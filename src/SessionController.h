@@ -45,6 +45,8 @@ class QAction;
 class QTextCodec;
 class QKeyEvent;
 class QTimer;
+class QBuffer;
+class QTextStream;
 class QUrl;
 
 class KCodecAction;
@@ -457,9 +459,16 @@ private:
         SessionPtr session; // the session associated with a history save job
         int lastLineFetched; // the last line processed in the previous data request
         // set this to -1 at the start of the save job
+        int lastLine; // the last line to save, the output at the start of the job
 
         TerminalCharacterDecoder *decoder;  // decoder used to convert terminal characters
         // into output
+
+        // the decoder writes the whole output into this stream, which encodes
+        // it as UTF-8 into the buffer handed to the job with each data request
+        QBuffer *buffer;
+        QTextStream *stream;
+        bool ended; // the decoder has ended the document
     };
 
     QHash<KJob *, SaveJob> _jobSession;
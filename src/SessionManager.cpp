@@ -25,12 +25,16 @@
 #include "konsoledebug.h"
 
 // Qt
+#include <QApplication>
+#include <QDir>
+#include <QStandardPaths>
 #include <QStringList>
 #include <QTextCodec>
 
 // KDE
 #include <KConfig>
 #include <KConfigGroup>
+#include <KSharedConfig>
 
 // Konsole
 #include "Session.h"
@@ -38,18 +42,46 @@
 #include "History.h"
 #include "Enumeration.h"
 #include "TerminalDisplay.h"
+#include "KonsoleSettings.h"
 
 using namespace Konsole;
 
+// Returns the folder configured for "unlimited" scrollback files
+static QString scrollbackFileLocation()
+{
+    KSharedConfigPtr appConfig = KSharedConfig::openConfig();
+    if (qApp->applicationName() != QLatin1String("konsole")) {
+        // Check if "kpart"rc has "FileLocation" group; AFAIK
+        // only possible if user manually added it. If not
+        // found, use konsole's config.
+        if (!appConfig->hasGroup("FileLocation")) {
+            appConfig = KSharedConfig::openConfig(QStringLiteral("konsolerc"));
+        }
+    }
+
+    KConfigGroup configGroup = appConfig->group("FileLocation");
+    if (configGroup.readEntry("scrollbackUseCacheLocation", false)) {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    } else if (configGroup.readEntry("scrollbackUseSpecifiedLocation", false)) {
+        const QUrl specifiedUrl = KonsoleSettings::scrollbackUseSpecifiedLocationDirectory();
+        return specifiedUrl.path();
+    } else {
+        return QDir::tempPath();
+    }
+}
+
 SessionManager::SessionManager() :
     _sessions(QList<Session *>()),
+    _idleSessions(QList<Session *>()),
     _sessionProfiles(QHash<Session *, Profile::Ptr>()),
     _sessionRuntimeProfiles(QHash<Session *, Profile::Ptr>()),
     _restoreMapping(QHash<Session *, int>())
 {
+    HistoryFile::setLocationResolver(scrollbackFileLocation);
+
     ProfileManager *profileMananger = ProfileManager::instance();
-    connect(profileMananger, &Konsole::ProfileManager::profileChanged, this,
-            &Konsole::SessionManager::profileChanged);
+    connect(profileMananger, &Konsole::ProfileManager::profilePropertiesChanged, this,
+            &Konsole::SessionManager::profilePropertiesChanged);
 }
 
 SessionManager::~SessionManager()
@@ -64,6 +96,9 @@ SessionManager::~SessionManager()
             disconnect(session, nullptr, this, nullptr);
         }
     }
+    foreach (Session *session, _idleSessions) {
+        disconnect(session, nullptr, this, nullptr);
+    }
 }
 
 Q_GLOBAL_STATIC(SessionManager, theSessionManager)
@@ -75,10 +110,11 @@ SessionManager* SessionManager::instance()
 void SessionManager::closeAllSessions()
 {
     // close remaining sessions
-    foreach (Session *session, _sessions) {
+    foreach (Session *session, _sessions + _idleSessions) {
         session->close();
     }
     _sessions.clear();
+    _idleSessions.clear();
 }
 
 const QList<Session *> SessionManager::sessions() const
@@ -87,6 +123,32 @@ const QList<Session *> SessionManager::sessions() const
 }
 
 Session *SessionManager::createSession(Profile::Ptr profile)
+{
+    Session *session = newSession(profile);
+
+    //add session to active list
+    _sessions << session;
+    session->registerOnDBus();
+
+    return session;
+}
+
+Session *SessionManager::createIdleSession(Profile::Ptr profile)
+{
+    Session *session = newSession(profile);
+    _idleSessions << session;
+    return session;
+}
+
+void SessionManager::adoptSession(Session *session)
+{
+    if (_idleSessions.removeAll(session) > 0) {
+        _sessions << session;
+        session->registerOnDBus();
+    }
+}
+
+Session *SessionManager::newSession(Profile::Ptr profile)
 {
     if (!profile) {
         profile = ProfileManager::instance()->defaultProfile();
@@ -111,16 +173,20 @@ Session *SessionManager::createSession(Profile::Ptr profile)
                 sessionTerminated(session);
             });
 
-    //add session to active list
-    _sessions << session;
     _sessionProfiles.insert(session, profile);
 
     return session;
 }
 
-void SessionManager::profileChanged(Profile::Ptr profile)
+void SessionManager::profilePropertiesChanged(Profile::Ptr profile,
+                                              const QSet<Profile::Property> &properties)
 {
-    applyProfile(profile, true);
+    const ShouldApplyProperty apply(properties);
+    foreach (Session *session, _sessions + _idleSessions) {
+        if (_sessionProfiles[session] == profile) {
+            applyProfile(session, profile, apply);
+        }
+    }
 }
 
 void SessionManager::sessionTerminated(Session *session)
@@ -128,6 +194,7 @@ void SessionManager::sessionTerminated(Session *session)
     Q_ASSERT(session);
 
     _sessions.removeAll(session);
+    _idleSessions.removeAll(session);
     _sessionProfiles.remove(session);
     _sessionRuntimeProfiles.remove(session);
 
@@ -136,7 +203,7 @@ void SessionManager::sessionTerminated(Session *session)
 
 void SessionManager::applyProfile(Profile::Ptr profile, bool modifiedPropertiesOnly)
 {
-    foreach (Session *session, _sessions) {
+    foreach (Session *session, _sessions + _idleSessions) {
         if (_sessionProfiles[session] == profile) {
             applyProfile(session, profile, modifiedPropertiesOnly);
         }
@@ -165,13 +232,17 @@ void SessionManager::setSessionProfile(Session *session, Profile::Ptr profile)
 
 void SessionManager::applyProfile(Session *session, const Profile::Ptr profile,
                                   bool modifiedPropertiesOnly)
+{
+    applyProfile(session, profile, ShouldApplyProperty(profile, modifiedPropertiesOnly));
+}
+
+void SessionManager::applyProfile(Session *session, const Profile::Ptr profile,
+                                  const ShouldApplyProperty &apply)
 {
     Q_ASSERT(profile);
 
     _sessionProfiles[session] = profile;
 
-    ShouldApplyProperty apply(profile, modifiedPropertiesOnly);
-
     // Basic session settings
     if (apply.shouldApply(Profile::Name)) {
         session->setTitle(Session::NameRole, profile->name());
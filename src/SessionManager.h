@@ -25,6 +25,7 @@
 // Qt
 #include <QHash>
 #include <QList>
+#include <QSet>
 
 // Konsole
 #include "Profile.h"
@@ -33,6 +34,7 @@ class KConfig;
 
 namespace Konsole {
 class Session;
+class ShouldApplyProperty;
 
 /**
  * Manages running terminal sessions.
@@ -75,6 +77,20 @@ public:
      */
     Session *createSession(Profile::Ptr profile = Profile::Ptr());
 
+    /**
+     * Creates a new session like createSession(), which is kept idle by a
+     * SessionPool until a window adopts it with adoptSession().  Until then
+     * the session is not listed in sessions() and not available on D-Bus,
+     * but changes of its profile are applied to it.
+     */
+    Session *createIdleSession(Profile::Ptr profile);
+
+    /**
+     * Lists a session created with createIdleSession() in sessions() and
+     * makes it available on D-Bus.
+     */
+    void adoptSession(Session *session);
+
     /** Sets the profile associated with a session. */
     void setSessionProfile(Session *session, Profile::Ptr profile);
 
@@ -110,7 +126,7 @@ protected Q_SLOTS:
 private Q_SLOTS:
     void sessionProfileCommandReceived(const QString &text);
 
-    void profileChanged(Profile::Ptr profile);
+    void profilePropertiesChanged(Profile::Ptr profile, const QSet<Profile::Property> &properties);
 
 private:
     Q_DISABLE_COPY(SessionManager)
@@ -126,32 +142,58 @@ private:
     // are set in @p profile are update ( ie. properties for which profile->isPropertySet(<property>)
     // returns true )
     void applyProfile(Session *session, const Profile::Ptr profile, bool modifiedPropertiesOnly);
+    // applies the properties of @p profile for which @p apply returns true
+    void applyProfile(Session *session, const Profile::Ptr profile,
+                      const ShouldApplyProperty &apply);
+
+    // creates a session for createSession() and createIdleSession()
+    Session *newSession(Profile::Ptr profile);
 
     QList<Session *> _sessions; // list of running sessions
+    QList<Session *> _idleSessions; // sessions not adopted yet, see createIdleSession()
 
     QHash<Session *, Profile::Ptr> _sessionProfiles;
     QHash<Session *, Profile::Ptr> _sessionRuntimeProfiles;
     QHash<Session *, int> _restoreMapping;
 };
 
-/** Utility class to simplify code in SessionManager::applyProfile(). */
+/**
+ * Utility class to simplify code in SessionManager::applyProfile() and
+ * ViewManager::applyProfileToView().
+ */
 class ShouldApplyProperty
 {
 public:
     ShouldApplyProperty(const Profile::Ptr profile, bool modifiedOnly) :
         _profile(profile),
-        _modifiedPropertiesOnly(modifiedOnly)
+        _modifiedPropertiesOnly(modifiedOnly),
+        _changedPropertiesOnly(false),
+        _changedProperties()
+    {
+    }
+
+    /** Only the properties in @p changedProperties are applied. */
+    explicit ShouldApplyProperty(const QSet<Profile::Property> &changedProperties) :
+        _profile(),
+        _modifiedPropertiesOnly(false),
+        _changedPropertiesOnly(true),
+        _changedProperties(changedProperties)
     {
     }
 
     bool shouldApply(Profile::Property property) const
     {
+        if (_changedPropertiesOnly) {
+            return _changedProperties.contains(property);
+        }
         return !_modifiedPropertiesOnly || _profile->isPropertySet(property);
     }
 
 private:
     const Profile::Ptr _profile;
     bool _modifiedPropertiesOnly;
+    bool _changedPropertiesOnly;
+    QSet<Profile::Property> _changedProperties;
 };
 }
 #endif //SESSIONMANAGER_H
@@ -0,0 +1,184 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "SessionPool.h"
+
+// Konsole
+#include "Emulation.h"
+#include "ProfileManager.h"
+#include "Session.h"
+#include "SessionManager.h"
+#include "TerminalDisplay.h"
+#include "ViewManager.h"
+
+using namespace Konsole;
+
+namespace {
+// time in milliseconds between taking a session from the pool and
+// starting its replacement, so that the two shells do not compete
+const int REFILL_DELAY = 1000;
+}
+
+SessionPool::SessionPool(ViewManager *manager) :
+    QObject(manager),
+    _viewManager(manager),
+    _size(0),
+    _profile(nullptr),
+    _directory(QString()),
+    _sessions(QList<QPointer<Session> >())
+{
+    _refillTimer.setSingleShot(true);
+    _refillTimer.setInterval(REFILL_DELAY);
+    connect(&_refillTimer, &QTimer::timeout, this, &Konsole::SessionPool::refill);
+
+    connect(ProfileManager::instance(), &Konsole::ProfileManager::profilePropertiesChanged,
+            this, &Konsole::SessionPool::profilePropertiesChanged);
+}
+
+SessionPool::~SessionPool()
+{
+    trim(0);
+}
+
+void SessionPool::setSize(int size)
+{
+    _size = qMax(0, size);
+    trim(_size);
+    scheduleRefill();
+}
+
+int SessionPool::size() const
+{
+    return _size;
+}
+
+Session *SessionPool::takeSession(Profile::Ptr profile, const QString &directory)
+{
+    if (_size == 0) {
+        return nullptr;
+    }
+
+    const Profile::Ptr defaultProfile = ProfileManager::instance()->defaultProfile();
+    if (_profile != defaultProfile) {
+        trim(0);
+        _profile = defaultProfile;
+        scheduleRefill();
+    }
+
+    if (profile != _profile) {
+        return nullptr;
+    }
+
+    const QString wantedDirectory = profile->startInCurrentSessionDir() ? directory : QString();
+    if (wantedDirectory != _directory) {
+        trim(0);
+        _directory = wantedDirectory;
+        scheduleRefill();
+        return nullptr;
+    }
+
+    Session *session = nullptr;
+    while (session == nullptr && !_sessions.isEmpty()) {
+        session = _sessions.takeFirst();
+        if (session != nullptr && !session->isRunning()) {
+            session->close();
+            session = nullptr;
+        }
+    }
+
+    if (session != nullptr) {
+        SessionManager::instance()->adoptSession(session);
+    }
+
+    scheduleRefill();
+    return session;
+}
+
+void SessionPool::scheduleRefill()
+{
+    if (_sessions.count() < _size) {
+        _refillTimer.start();
+    }
+}
+
+void SessionPool::refill()
+{
+    if (!_profile) {
+        _profile = ProfileManager::instance()->defaultProfile();
+    }
+
+    // forget the sessions whose program has exited in the meantime
+    for (auto iter = _sessions.begin(); iter != _sessions.end();) {
+        if (iter->isNull()) {
+            iter = _sessions.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    // the sessions are started with the size of the active view, so that
+    // most of them do not need to be resized when they are adopted
+    const auto activeDisplay = qobject_cast<TerminalDisplay *>(_viewManager->activeView());
+    const bool haveActiveSize = activeDisplay != nullptr
+                                && activeDisplay->lines() > 1 && activeDisplay->columns() > 1;
+
+    while (_sessions.count() < _size) {
+        Session *session = SessionManager::instance()->createIdleSession(_profile);
+        if (!_directory.isEmpty()) {
+            session->setInitialWorkingDirectory(_directory);
+        }
+        session->addEnvironmentEntry(QStringLiteral("KONSOLE_DBUS_WINDOW=/Windows/%1").arg(_viewManager->managerId()));
+        session->setDefaultWindowId(_viewManager->widget()->window()->winId());
+
+        if (haveActiveSize) {
+            session->emulation()->setImageSize(activeDisplay->lines(), activeDisplay->columns());
+        }
+        if (!session->isRunning()) {
+            session->run();
+        }
+
+        _sessions << session;
+    }
+}
+
+void SessionPool::profilePropertiesChanged(Profile::Ptr profile,
+                                           const QSet<Profile::Property> &properties)
+{
+    // the idle sessions may have been started with the old command or
+    // environment, which includes the profile name as KONSOLE_PROFILE_NAME.
+    // The other properties are applied to them like to the sessions in use
+    if (profile == _profile
+        && (properties.contains(Profile::Command) || properties.contains(Profile::Arguments)
+            || properties.contains(Profile::Environment) || properties.contains(Profile::Directory)
+            || properties.contains(Profile::Name))) {
+        trim(0);
+        scheduleRefill();
+    }
+}
+
+void SessionPool::trim(int count)
+{
+    while (_sessions.count() > count) {
+        QPointer<Session> session = _sessions.takeLast();
+        if (!session.isNull()) {
+            session->close();
+        }
+    }
+}
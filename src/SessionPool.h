@@ -0,0 +1,97 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef SESSIONPOOL_H
+#define SESSIONPOOL_H
+
+// Qt
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+
+// Konsole
+#include "konsoleprivate_export.h"
+#include "Profile.h"
+
+namespace Konsole {
+class Session;
+class ViewManager;
+
+/**
+ * Keeps a number of sessions for the default profile running in the
+ * background, so that a new tab can adopt one whose shell has already
+ * read its startup files instead of waiting for a new shell.
+ *
+ * The pool belongs to a view manager, and its sessions are started with
+ * the same environment as the sessions created for new tabs in that
+ * window.  If the default profile starts new tabs in the directory of
+ * the current session, the pooled sessions are started in the directory
+ * of the last new tab; a tab which asks for another directory gets a new
+ * session as usual, and the pool is refilled for the new directory.
+ *
+ * The idle sessions are not listed by the SessionManager and are not
+ * available on D-Bus until they are taken from the pool.
+ *
+ * The pool is empty by default, see setSize().
+ */
+class KONSOLEPRIVATE_EXPORT SessionPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionPool(ViewManager *manager);
+    ~SessionPool() Q_DECL_OVERRIDE;
+
+    /** Sets the number of idle sessions kept running */
+    void setSize(int size);
+    int size() const;
+
+    /**
+     * Returns an idle session which was created for @p profile and started
+     * in @p directory and removes it from the pool, or nullptr if there is
+     * no such session.  The session is adopted by the SessionManager, see
+     * SessionManager::adoptSession().  A replacement is started a moment
+     * later.
+     *
+     * @p directory is the directory a new session would be given with
+     * Session::setInitialWorkingDirectory(), or an empty string.
+     */
+    Session *takeSession(Profile::Ptr profile, const QString &directory);
+
+private Q_SLOTS:
+    void refill();
+    void profilePropertiesChanged(Profile::Ptr profile, const QSet<Profile::Property> &properties);
+
+private:
+    void scheduleRefill();
+    // closes the sessions in the pool beyond the first 'count' ones
+    void trim(int count);
+
+    ViewManager *_viewManager;
+    int _size;
+    Profile::Ptr _profile;
+    QString _directory;
+    QList<QPointer<Session> > _sessions;
+    QTimer _refillTimer;
+};
+}
+
+#endif // SESSIONPOOL_H
@@ -0,0 +1,262 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "SessionRecorder.h"
+
+// Qt
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTimer>
+
+// Konsole
+#include "konsoledebug.h"
+
+using namespace Konsole;
+
+static const int ASCIICAST_VERSION = 2;
+
+SessionRecorder::SessionRecorder() :
+    _file(),
+    _clock()
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    close();
+}
+
+bool SessionRecorder::open(const QString &fileName, int columns, int lines)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCDebug(KonsoleDebug) << "Unable to open recording file" << fileName << _file.errorString();
+        return false;
+    }
+
+    QJsonObject header;
+    header.insert(QStringLiteral("version"), ASCIICAST_VERSION);
+    header.insert(QStringLiteral("width"), columns);
+    header.insert(QStringLiteral("height"), lines);
+    header.insert(QStringLiteral("timestamp"), QDateTime::currentMSecsSinceEpoch() / 1000);
+
+    _file.write(QJsonDocument(header).toJson(QJsonDocument::Compact));
+    _file.write("\n", 1);
+
+    _clock.start();
+    return true;
+}
+
+void SessionRecorder::close()
+{
+    if (_file.isOpen()) {
+        _file.close();
+    }
+}
+
+bool SessionRecorder::isOpen() const
+{
+    return _file.isOpen();
+}
+
+QString SessionRecorder::fileName() const
+{
+    return _file.fileName();
+}
+
+void SessionRecorder::recordData(const char *data, int length)
+{
+    if (!_file.isOpen() || length <= 0) {
+        return;
+    }
+
+    const QByteArray bytes = QByteArray::fromRawData(data, length);
+    const QString text = QString::fromUtf8(bytes);
+
+    // blocks may end in the middle of a multi-byte sequence or contain
+    // data in a legacy encoding; keep the exact bytes for those
+    if (text.toUtf8() == bytes) {
+        writeEvent(QStringLiteral("o"), text);
+    } else {
+        writeEvent(QStringLiteral("b"), QString::fromLatin1(bytes.toBase64()));
+    }
+}
+
+void SessionRecorder::recordResize(int columns, int lines)
+{
+    if (!_file.isOpen()) {
+        return;
+    }
+
+    writeEvent(QStringLiteral("r"), QStringLiteral("%1x%2").arg(columns).arg(lines));
+}
+
+void SessionRecorder::writeEvent(const QString &type, const QString &payload)
+{
+    QJsonArray event;
+    event.append(_clock.nsecsElapsed() / 1e9);
+    event.append(type);
+    event.append(payload);
+
+    _file.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    _file.write("\n", 1);
+}
+
+SessionReplayer::SessionReplayer(QObject *parent) :
+    QObject(parent),
+    _events(QVector<Event>()),
+    _size(QSize()),
+    _nextEvent(0),
+    _speed(RealTime),
+    _timer(nullptr),
+    _clock()
+{
+    _timer = new QTimer(this);
+    _timer->setSingleShot(true);
+    connect(_timer, &QTimer::timeout, this, &Konsole::SessionReplayer::playNextEvents);
+}
+
+SessionReplayer::~SessionReplayer()
+{
+}
+
+bool SessionReplayer::load(const QString &fileName)
+{
+    stop();
+    _events.clear();
+    _size = QSize();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCDebug(KonsoleDebug) << "Unable to open recording file" << fileName << file.errorString();
+        return false;
+    }
+
+    const QJsonObject header = QJsonDocument::fromJson(file.readLine()).object();
+    if (header.value(QStringLiteral("version")).toInt() != ASCIICAST_VERSION) {
+        qCDebug(KonsoleDebug) << "Unsupported recording format in" << fileName;
+        return false;
+    }
+    _size = QSize(header.value(QStringLiteral("width")).toInt(),
+                  header.value(QStringLiteral("height")).toInt());
+
+    while (!file.atEnd()) {
+        const QJsonArray entry = QJsonDocument::fromJson(file.readLine()).array();
+        if (entry.size() < 3) {
+            continue;
+        }
+
+        Event event;
+        event.time = qRound64(entry.at(0).toDouble() * 1000);
+
+        const QString type = entry.at(1).toString();
+        const QString payload = entry.at(2).toString();
+        if (type == QLatin1String("o")) {
+            event.data = payload.toUtf8();
+        } else if (type == QLatin1String("b")) {
+            event.data = QByteArray::fromBase64(payload.toLatin1());
+        } else if (type == QLatin1String("r")) {
+            const QStringList dimensions = payload.split(QLatin1Char('x'));
+            if (dimensions.count() != 2) {
+                continue;
+            }
+            event.size = QSize(dimensions.at(0).toInt(), dimensions.at(1).toInt());
+        } else {
+            // input and marker events are not replayed
+            continue;
+        }
+
+        _events.append(event);
+    }
+
+    return true;
+}
+
+QSize SessionReplayer::size() const
+{
+    return _size;
+}
+
+int SessionReplayer::eventCount() const
+{
+    return _events.count();
+}
+
+void SessionReplayer::start(Speed speed)
+{
+    _speed = speed;
+    _nextEvent = 0;
+    _clock.start();
+    scheduleNextEvent();
+}
+
+void SessionReplayer::stop()
+{
+    _timer->stop();
+    _clock.invalidate();
+}
+
+bool SessionReplayer::isRunning() const
+{
+    return _clock.isValid();
+}
+
+void SessionReplayer::scheduleNextEvent()
+{
+    // the playback may have been stopped by a receiver of dataReady()
+    if (!_clock.isValid()) {
+        return;
+    }
+
+    if (_nextEvent >= _events.count()) {
+        const qint64 elapsed = _clock.elapsed();
+        _clock.invalidate();
+        emit finished(elapsed);
+        return;
+    }
+
+    int delay = 0;
+    if (_speed == RealTime) {
+        delay = static_cast<int>(qMax(Q_INT64_C(0), _events.at(_nextEvent).time - _clock.elapsed()));
+    }
+    _timer->start(delay);
+}
+
+void SessionReplayer::playNextEvents()
+{
+    // in real time mode emit everything which is due, so that a slow
+    // receiver does not make the playback fall further and further behind
+    do {
+        const Event &event = _events.at(_nextEvent++);
+        if (event.size.isValid()) {
+            emit resizeRequest(event.size);
+        } else {
+            emit dataReady(event.data.constData(), event.data.length());
+        }
+    } while (_speed == RealTime && _clock.isValid() && _nextEvent < _events.count()
+             && _events.at(_nextEvent).time <= _clock.elapsed());
+
+    scheduleNextEvent();
+}
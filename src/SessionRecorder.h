@@ -0,0 +1,169 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+// Qt
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSize>
+#include <QVector>
+
+// Konsole
+#include "konsoleprivate_export.h"
+
+class QTimer;
+
+namespace Konsole {
+/**
+ * Writes the output of a terminal program to a file, together with the
+ * time at which each block arrived.
+ *
+ * The file uses the asciicast v2 format: a JSON header line followed by
+ * one JSON array per event, [seconds, type, payload].  Blocks which are
+ * valid UTF-8 are stored as "o" (output) events and changes of the
+ * terminal size as "r" events.
+ *
+ * Blocks which are not valid UTF-8 are stored base64 encoded as "b"
+ * events, so that the exact bytes can be reproduced by SessionReplayer.
+ * "b" is a Konsole extension which is not part of asciicast v2, so other
+ * asciicast players can only play recordings without such blocks.
+ */
+class KONSOLEPRIVATE_EXPORT SessionRecorder
+{
+public:
+    SessionRecorder();
+    ~SessionRecorder();
+
+    /**
+     * Creates or truncates @p fileName and writes the recording header.
+     * @p columns and @p lines give the terminal size at the start of the
+     * recording.
+     *
+     * Returns false if the file could not be opened for writing.
+     */
+    bool open(const QString &fileName, int columns, int lines);
+
+    /** Flushes and closes the recording file. */
+    void close();
+
+    /** Returns true if a recording file is currently open. */
+    bool isOpen() const;
+
+    /** Returns the name of the recording file. */
+    QString fileName() const;
+
+    /** Appends a block of raw output received from the terminal program. */
+    void recordData(const char *data, int length);
+
+    /** Appends a change of the terminal size. */
+    void recordResize(int columns, int lines);
+
+private:
+    Q_DISABLE_COPY(SessionRecorder)
+
+    void writeEvent(const QString &type, const QString &payload);
+
+    QFile _file;
+    QElapsedTimer _clock;
+};
+
+/**
+ * Plays back a recording written by SessionRecorder (or any asciicast v2
+ * file), emitting the recorded output blocks through dataReady().
+ *
+ * Connect dataReady() to Emulation::receiveData() to drive a terminal with
+ * the recording.  The playback either reproduces the original timing or
+ * feeds the blocks as fast as the event loop permits, which makes it
+ * possible to measure how long a given workload takes to process and paint.
+ */
+class KONSOLEPRIVATE_EXPORT SessionReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Speed {
+        /** Each block is emitted at the time offset it was recorded at. */
+        RealTime,
+        /** Blocks are emitted one per event loop iteration without delay. */
+        AsFastAsPossible
+    };
+
+    explicit SessionReplayer(QObject *parent = nullptr);
+    ~SessionReplayer() Q_DECL_OVERRIDE;
+
+    /**
+     * Reads the recording in @p fileName.  Returns false if the file could
+     * not be opened or is not an asciicast v2 file.
+     */
+    bool load(const QString &fileName);
+
+    /** Returns the terminal size stored in the recording header. */
+    QSize size() const;
+
+    /** Returns the number of output and resize events in the recording. */
+    int eventCount() const;
+
+    /** Starts playing the loaded recording from the beginning. */
+    void start(Speed speed);
+
+    /** Stops the playback.  finished() is not emitted. */
+    void stop();
+
+    /** Returns true while a playback is in progress. */
+    bool isRunning() const;
+
+Q_SIGNALS:
+    /** Emitted for each recorded block of terminal program output. */
+    void dataReady(const char *data, int length);
+
+    /** Emitted when the recording requests a new terminal size. */
+    void resizeRequest(const QSize &size);
+
+    /**
+     * Emitted once all events have been played.
+     *
+     * @param msecs The time taken by the playback in milliseconds.
+     */
+    void finished(qint64 msecs);
+
+private Q_SLOTS:
+    void playNextEvents();
+
+private:
+    struct Event {
+        qint64 time;    // milliseconds from the start of the recording
+        QByteArray data;
+        QSize size;     // valid for resize events only
+    };
+
+    void scheduleNextEvent();
+
+    QVector<Event> _events;
+    QSize _size;
+    int _nextEvent;
+    Speed _speed;
+    QTimer *_timer;
+    QElapsedTimer _clock;
+};
+}
+
+#endif // SESSIONRECORDER_H
@@ -0,0 +1,96 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "StartupTrace.h"
+
+// Qt
+#include <QElapsedTimer>
+#include <QPair>
+#include <QVector>
+
+// C++
+#include <cstdio>
+
+using namespace Konsole;
+
+namespace {
+struct TraceData
+{
+    QElapsedTimer clock;
+    qint64 lastTime = 0;
+    QVector<QPair<const char *, qint64> > phases;
+    bool enabled = false;
+    bool reported = false;
+};
+}
+
+Q_GLOBAL_STATIC(TraceData, theTrace)
+
+void StartupTrace::start()
+{
+    theTrace->clock.start();
+}
+
+void StartupTrace::setEnabled(bool enabled)
+{
+    TraceData *trace = theTrace;
+    trace->enabled = enabled;
+    if (!enabled) {
+        trace->phases.clear();
+        trace->reported = true;
+    }
+}
+
+bool StartupTrace::isEnabled()
+{
+    return theTrace->enabled;
+}
+
+void StartupTrace::phaseFinished(const char *name)
+{
+    TraceData *trace = theTrace;
+    if (trace->reported || !trace->clock.isValid()) {
+        return;
+    }
+
+    const qint64 time = trace->clock.nsecsElapsed();
+    trace->phases.append(qMakePair(name, time - trace->lastTime));
+    trace->lastTime = time;
+}
+
+void StartupTrace::report()
+{
+    TraceData *trace = theTrace;
+    if (trace->reported) {
+        return;
+    }
+    trace->reported = true;
+
+    if (!trace->enabled) {
+        return;
+    }
+
+    fprintf(stderr, "Konsole startup trace:\n");
+    typedef QPair<const char *, qint64> Phase;
+    foreach (const Phase &phase, trace->phases) {
+        fprintf(stderr, "  %-28s %9.1f ms\n", phase.first, phase.second / 1e6);
+    }
+    fprintf(stderr, "  %-28s %9.1f ms\n", "total", trace->lastTime / 1e6);
+}
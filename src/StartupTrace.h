@@ -0,0 +1,60 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+namespace Konsole {
+/**
+ * Measures the time spent in each phase of starting Konsole, from
+ * entering main() until the first session produces output.
+ *
+ * Each call to phaseFinished() attributes the time since the previous
+ * call to the named phase.  The phases before the command line has been
+ * parsed are always recorded, which only costs a clock read each; unless
+ * the --startup-trace option is given, the trace is disabled after that.
+ */
+class StartupTrace
+{
+public:
+    /** Starts the clock.  Called first thing in main(). */
+    static void start();
+
+    /**
+     * Enables or disables the trace.  Disabling it drops the phases
+     * recorded so far and stops recording new ones.
+     */
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /**
+     * Records the end of the phase @p name.  Does nothing once the
+     * report has been printed.
+     */
+    static void phaseFinished(const char *name);
+
+    /**
+     * Prints the time spent in each phase and the total time to standard
+     * error.  Only the first call has an effect.
+     */
+    static void report();
+};
+}
+
+#endif // STARTUPTRACE_H
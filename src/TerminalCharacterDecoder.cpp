@@ -27,9 +27,6 @@
 
 // Konsole
 #include "ExtendedCharTable.h"
-#include "ColorScheme.h"
-#include "ColorSchemeManager.h"
-#include "Profile.h"
 
 using namespace Konsole;
 PlainTextDecoder::PlainTextDecoder()
@@ -164,61 +161,94 @@ void PlainTextDecoder::decodeLine(const Character* const characters, int count,
     *_output << plainText;
 }
 
-HTMLDecoder::HTMLDecoder(const QExplicitlySharedDataPointer<Profile> &profile) :
+// writes @p color in the #rrggbb notation
+static void writeColorName(QTextStream &output, QRgb color)
+{
+    static const char digits[] = "0123456789abcdef";
+
+    char name[7];
+    name[0] = '#';
+    for (int i = 0; i < 6; i++) {
+        name[i + 1] = digits[(color >> (20 - 4 * i)) & 0xf];
+    }
+    output << QLatin1String(name, 7);
+}
+
+// writes the character of @p character, or the sequence of characters
+// if it is an extended character
+static void writeCharacter(QTextStream &output, const Character &character)
+{
+    if ((character.rendition & RE_EXTENDED_CHAR) != 0) {
+        ushort extendedCharLength = 0;
+        const uint* chars = ExtendedCharTable::instance.lookupExtendedChar(character.character, extendedCharLength);
+        if (chars != nullptr) {
+            output << QString::fromUcs4(chars, extendedCharLength);
+        }
+    } else if (character.character > 0xffff) {
+        output << QString::fromUcs4(&character.character, 1);
+    } else {
+        output << QChar(character.character);
+    }
+}
+
+HTMLDecoder::HTMLDecoder() :
     _output(nullptr)
-    , _profile(profile)
+    , _styleBody(false)
+    , _styleClasses(false)
+    , _font(QFont())
     , _innerSpanOpen(false)
     , _lastRendition(DEFAULT_RENDITION)
     , _lastForeColor(CharacterColor())
     , _lastBackColor(CharacterColor())
 {
-    const ColorScheme *colorScheme = nullptr;
-
-    if (profile) {
-        colorScheme = ColorSchemeManager::instance()->findColorScheme(profile->colorScheme());
-
-        if (!colorScheme) {
-            colorScheme = ColorSchemeManager::instance()->defaultColorScheme();
-        }
+    fillPalette(defaultColorTable, _palette);
+}
 
-    }
+HTMLDecoder::HTMLDecoder(const ColorEntry *colorTable, const QFont &font) :
+    _output(nullptr)
+    , _styleBody(true)
+    , _styleClasses(false)
+    , _font(font)
+    , _innerSpanOpen(false)
+    , _lastRendition(DEFAULT_RENDITION)
+    , _lastForeColor(CharacterColor())
+    , _lastBackColor(CharacterColor())
+{
+    fillPalette(colorTable, _palette);
+}
 
-    if (colorScheme) {
-        colorScheme->getColorTable(_colorTable);
-    } else {
-        for (int i = 0; i < TABLE_COLORS; i++) {
-            _colorTable[i] = ColorScheme::defaultTable[i];
-        }
-    }
+void HTMLDecoder::setStyleClasses(bool enable)
+{
+    _styleClasses = enable;
 }
 
 void HTMLDecoder::begin(QTextStream* output)
 {
     _output = output;
+    _styleClassIds.clear();
+    _lastRendition = DEFAULT_RENDITION;
+    _lastForeColor = CharacterColor();
+    _lastBackColor = CharacterColor();
 
-
-    if (_profile) {
-        QString style;
-
-        QFont font = _profile->font();
-        style.append(QStringLiteral("font-family:'%1',monospace;").arg(font.family()));
+    if (_styleBody) {
+        *output << QLatin1String("<!DOCTYPE html><html><head><meta charset=\"utf-8\"></head>");
+        *output << QLatin1String("<body style=\"font-family:'") << _font.family()
+                << QLatin1String("',monospace;");
 
         // Prefer point size if set
-        if (font.pointSizeF() > 0) {
-            style.append(QStringLiteral("font-size:%1pt;").arg(font.pointSizeF()));
+        if (_font.pointSizeF() > 0) {
+            *output << QLatin1String("font-size:") << _font.pointSizeF() << QLatin1String("pt;");
         } else {
-            style.append(QStringLiteral("font-size:%1px;").arg(font.pixelSize()));
+            *output << QLatin1String("font-size:") << _font.pixelSize() << QLatin1String("px;");
         }
 
-
-        style.append(QStringLiteral("color:%1;").arg(_colorTable[DEFAULT_FORE_COLOR].name()));
-        style.append(QStringLiteral("background-color:%1;").arg(_colorTable[DEFAULT_BACK_COLOR].name()));
-
-        *output << QStringLiteral("<body style=\"%1\">").arg(style);
+        *output << QLatin1String("color:");
+        writeColorName(*output, _palette[DEFAULT_FORE_COLOR]);
+        *output << QLatin1String(";background-color:");
+        writeColorName(*output, _palette[DEFAULT_BACK_COLOR]);
+        *output << QLatin1String(";\">");
     } else {
-        QString text;
-        openSpan(text, QStringLiteral("font-family:monospace"));
-        *output << text;
+        *output << QLatin1String("<span style=\"font-family:monospace\">");
     }
 }
 
@@ -226,12 +256,10 @@ void HTMLDecoder::end()
 {
     Q_ASSERT(_output);
 
-    if (_profile) {
-        *_output << QStringLiteral("</body>");
+    if (_styleBody) {
+        *_output << QLatin1String("</body></html>");
     } else {
-        QString text;
-        closeSpan(text);
-        *_output << text;
+        *_output << QLatin1String("</span>");
     }
 
     _output = nullptr;
@@ -243,7 +271,7 @@ void HTMLDecoder::decodeLine(const Character* const characters, int count, LineP
 {
     Q_ASSERT(_output);
 
-    QString text;
+    QTextStream &output = *_output;
 
     int spaceCount = 0;
 
@@ -253,7 +281,7 @@ void HTMLDecoder::decodeLine(const Character* const characters, int count, LineP
                 characters[i].foregroundColor != _lastForeColor  ||
                 characters[i].backgroundColor != _lastBackColor) {
             if (_innerSpanOpen) {
-                closeSpan(text);
+                output << QLatin1String("</span>");
                 _innerSpanOpen = false;
             }
 
@@ -261,24 +289,8 @@ void HTMLDecoder::decodeLine(const Character* const characters, int count, LineP
             _lastForeColor = characters[i].foregroundColor;
             _lastBackColor = characters[i].backgroundColor;
 
-            //build up style string
-            QString style;
-
-            bool useBold = (_lastRendition & RE_BOLD) != 0;
-            if (useBold) {
-                style.append(QLatin1String("font-weight:bold;"));
-            }
-
-            if ((_lastRendition & RE_UNDERLINE) != 0) {
-                style.append(QLatin1String("font-decoration:underline;"));
-            }
-
-            style.append(QStringLiteral("color:%1;").arg(_lastForeColor.color(_colorTable).name()));
-
-            style.append(QStringLiteral("background-color:%1;").arg(_lastBackColor.color(_colorTable).name()));
-
             //open the span with the current style
-            openSpan(text, style);
+            openSpan(_lastRendition, _lastForeColor, _lastBackColor);
             _innerSpanOpen = true;
         }
 
@@ -291,49 +303,230 @@ void HTMLDecoder::decodeLine(const Character* const characters, int count, LineP
 
         //output current character
         if (spaceCount < 2) {
+            //escape HTML tag characters and just display others as they are
+            const uint ch = characters[i].character;
             if ((characters[i].rendition & RE_EXTENDED_CHAR) != 0) {
-                ushort extendedCharLength = 0;
-                const uint* chars = ExtendedCharTable::instance.lookupExtendedChar(characters[i].character, extendedCharLength);
-                if (chars != nullptr) {
-                    text.append(QString::fromUcs4(chars, extendedCharLength));
-                }
+                writeCharacter(output, characters[i]);
+            } else if (ch == '<') {
+                output << QLatin1String("&lt;");
+            } else if (ch == '>') {
+                output << QLatin1String("&gt;");
+            } else if (ch == '&') {
+                output << QLatin1String("&amp;");
             } else {
-                //escape HTML tag characters and just display others as they are
-                const QChar ch = characters[i].character;
-                if (ch == QLatin1Char('<')) {
-                    text.append(QLatin1String("&lt;"));
-                } else if (ch == QLatin1Char('>')) {
-                    text.append(QLatin1String("&gt;"));
-                } else if (ch == QLatin1Char('&')) {
-                    text.append(QLatin1String("&amp;"));
-                } else {
-                    text.append(ch);
-                }
+                writeCharacter(output, characters[i]);
             }
         } else {
             // HTML truncates multiple spaces, so use a space marker instead
             // Use &#160 instead of &nbsp so xmllint will work.
-            text.append(QLatin1String("&#160;"));
+            output << QLatin1String("&#160;");
         }
     }
 
-    //close any remaining open inner spans
+    //close any remaining open inner spans, the next line opens a new one
     if (_innerSpanOpen) {
-        closeSpan(text);
+        output << QLatin1String("</span>");
         _innerSpanOpen = false;
     }
+    _lastForeColor = CharacterColor();
+    _lastBackColor = CharacterColor();
 
     //start new line
-    text.append(QLatin1String("<br>"));
+    output << QLatin1String("<br>");
+}
+
+void HTMLDecoder::openSpan(RenditionFlags rendition, const CharacterColor &foreColor,
+                           const CharacterColor &backColor)
+{
+    const QRgb foreRgb = foreColor.rgb(_palette);
+    const QRgb backRgb = backColor.rgb(_palette);
+
+    if (!_styleClasses) {
+        *_output << QLatin1String("<span style=\"");
+        writeStyle(rendition, foreRgb, backRgb);
+        *_output << QLatin1String("\">");
+        return;
+    }
+
+    // only the properties which writeStyle() describes tell the classes apart
+    const quint64 key = (quint64(rendition & (RE_BOLD | RE_UNDERLINE)) << 48)
+                        | (quint64(foreRgb & 0xffffff) << 24)
+                        | (backRgb & 0xffffff);
+    auto id = _styleClassIds.constFind(key);
+    if (id == _styleClassIds.constEnd()) {
+        id = _styleClassIds.insert(key, _styleClassIds.count());
+        *_output << QLatin1String("<style>.c") << *id << QLatin1Char('{');
+        writeStyle(rendition, foreRgb, backRgb);
+        *_output << QLatin1String("}</style>");
+    }
+    *_output << QLatin1String("<span class=\"c") << *id << QLatin1String("\">");
+}
+
+void HTMLDecoder::writeStyle(RenditionFlags rendition, QRgb foreColor, QRgb backColor)
+{
+    if ((rendition & RE_BOLD) != 0) {
+        *_output << QLatin1String("font-weight:bold;");
+    }
+
+    if ((rendition & RE_UNDERLINE) != 0) {
+        *_output << QLatin1String("font-decoration:underline;");
+    }
 
-    *_output << text;
+    *_output << QLatin1String("color:");
+    writeColorName(*_output, foreColor);
+    *_output << QLatin1String(";background-color:");
+    writeColorName(*_output, backColor);
+    *_output << QLatin1Char(';');
 }
-void HTMLDecoder::openSpan(QString& text , const QString& style)
+
+ANSIDecoder::ANSIDecoder() :
+    _output(nullptr)
+    , _defaultFormat(true)
+    , _lastRendition(DEFAULT_RENDITION)
+    , _lastForeColor(CharacterColor(COLOR_SPACE_DEFAULT, DEFAULT_FORE_COLOR))
+    , _lastBackColor(CharacterColor(COLOR_SPACE_DEFAULT, DEFAULT_BACK_COLOR))
+{
+}
+
+void ANSIDecoder::begin(QTextStream* output)
+{
+    _output = output;
+    resetFormat();
+}
+
+void ANSIDecoder::end()
+{
+    Q_ASSERT(_output);
+
+    if (!_defaultFormat) {
+        *_output << QLatin1String("\033[0m");
+        resetFormat();
+    }
+
+    _output = nullptr;
+}
+
+void ANSIDecoder::decodeLine(const Character* const characters, int count, LineProperty /*properties*/
+                            )
+{
+    Q_ASSERT(_output);
+
+    for (int i = 0; i < count; i++) {
+        const Character &character = characters[i];
+
+        // the second half of a double width character
+        if (character.character == 0) {
+            continue;
+        }
+
+        // end the format before line breaks, so that pagers do not
+        // color the rest of the line
+        if (character.character == '\n' && (character.rendition & RE_EXTENDED_CHAR) == 0) {
+            if (!_defaultFormat) {
+                *_output << QLatin1String("\033[0m");
+                resetFormat();
+            }
+            *_output << QLatin1Char('\n');
+            continue;
+        }
+
+        if (character.rendition != _lastRendition
+                || character.foregroundColor != _lastForeColor
+                || character.backgroundColor != _lastBackColor) {
+            writeFormat(character);
+        }
+
+        writeCharacter(*_output, character);
+    }
+}
+
+void ANSIDecoder::writeFormat(const Character &character)
+{
+    _lastRendition = character.rendition;
+    _lastForeColor = character.foregroundColor;
+    _lastBackColor = character.backgroundColor;
+
+    // each format starts from the default, which saves tracking which
+    // attributes have to be turned off
+    *_output << QLatin1String("\033[0");
+    if ((_lastRendition & RE_BOLD) != 0) {
+        *_output << QLatin1String(";1");
+    }
+    if ((_lastRendition & RE_FAINT) != 0) {
+        *_output << QLatin1String(";2");
+    }
+    if ((_lastRendition & RE_ITALIC) != 0) {
+        *_output << QLatin1String(";3");
+    }
+    if ((_lastRendition & RE_UNDERLINE) != 0) {
+        *_output << QLatin1String(";4");
+    }
+    if ((_lastRendition & RE_BLINK) != 0) {
+        *_output << QLatin1String(";5");
+    }
+    if ((_lastRendition & RE_CONCEAL) != 0) {
+        *_output << QLatin1String(";8");
+    }
+    if ((_lastRendition & RE_STRIKEOUT) != 0) {
+        *_output << QLatin1String(";9");
+    }
+    if ((_lastRendition & RE_OVERLINE) != 0) {
+        *_output << QLatin1String(";53");
+    }
+
+    // the screen stores reverse video as swapped colors.  The default
+    // colors cannot be written swapped, so reverse video is written
+    // instead, with the colors swapped back
+    const bool reverse = (_lastForeColor.colorSpace() == COLOR_SPACE_DEFAULT
+                          && (_lastForeColor.value() & 1) == DEFAULT_BACK_COLOR)
+                         || (_lastBackColor.colorSpace() == COLOR_SPACE_DEFAULT
+                             && (_lastBackColor.value() & 1) == DEFAULT_FORE_COLOR);
+    if (reverse) {
+        *_output << QLatin1String(";7");
+    }
+
+    // bold text which is not faint gets the intensive foreground color
+    const bool boldIntensive = (_lastRendition & RE_BOLD) != 0 && (_lastRendition & RE_FAINT) == 0;
+    writeColor(_lastForeColor, reverse ? 40 : 30, boldIntensive);
+    writeColor(_lastBackColor, reverse ? 30 : 40, false);
+    *_output << QLatin1Char('m');
+
+    _defaultFormat = false;
+}
+
+void ANSIDecoder::writeColor(const CharacterColor &color, int base, bool boldIntensive)
 {
-    text.append(QStringLiteral("<span style=\"%1\">").arg(style));
+    const int value = color.value();
+
+    switch (color.colorSpace()) {
+    case COLOR_SPACE_SYSTEM:
+        // the intensive foreground color of bold text is implied by the
+        // bold attribute
+        if (((value >> 3) & 3) == 1 && !boldIntensive) {
+            *_output << QLatin1Char(';') << (base + 60 + (value & 7));
+        } else {
+            *_output << QLatin1Char(';') << (base + (value & 7));
+        }
+        break;
+    case COLOR_SPACE_256:
+        *_output << QLatin1Char(';') << (base + 8) << QLatin1String(";5;") << value;
+        break;
+    case COLOR_SPACE_RGB:
+        *_output << QLatin1Char(';') << (base + 8) << QLatin1String(";2;")
+                 << ((value >> 16) & 0xff) << QLatin1Char(';')
+                 << ((value >> 8) & 0xff) << QLatin1Char(';')
+                 << (value & 0xff);
+        break;
+    default:
+        // the default colors are set by resetting the format
+        break;
+    }
 }
 
-void HTMLDecoder::closeSpan(QString& text)
+void ANSIDecoder::resetFormat()
 {
-    text.append(QLatin1String("</span>"));
+    _defaultFormat = true;
+    _lastRendition = DEFAULT_RENDITION;
+    _lastForeColor = CharacterColor(COLOR_SPACE_DEFAULT, DEFAULT_FORE_COLOR);
+    _lastBackColor = CharacterColor(COLOR_SPACE_DEFAULT, DEFAULT_BACK_COLOR);
 }
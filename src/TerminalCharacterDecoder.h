@@ -23,12 +23,13 @@
 #define TERMINAL_CHARACTER_DECODER_H
 
 // Qt
+#include <QFont>
+#include <QHash>
 #include <QList>
 
 // Konsole
 #include "Character.h"
-#include "Profile.h"
-#include "konsoleprivate_export.h"
+#include "konsoleemulation_export.h"
 
 class QTextStream;
 
@@ -42,7 +43,7 @@ namespace Konsole {
  * Derived classes may produce either plain text with no other color or appearance information, or
  * they may produce text which incorporates these additional properties.
  */
-class KONSOLEPRIVATE_EXPORT TerminalCharacterDecoder
+class KONSOLEEMULATION_EXPORT TerminalCharacterDecoder
 {
 public:
     virtual ~TerminalCharacterDecoder()
@@ -70,7 +71,7 @@ public:
  * A terminal character decoder which produces plain text, ignoring colors and other appearance-related
  * properties of the original characters.
  */
-class KONSOLEPRIVATE_EXPORT PlainTextDecoder : public TerminalCharacterDecoder
+class KONSOLEEMULATION_EXPORT PlainTextDecoder : public TerminalCharacterDecoder
 {
 public:
     PlainTextDecoder();
@@ -124,13 +125,30 @@ private:
 /**
  * A terminal character decoder which produces pretty HTML markup
  */
-class KONSOLEPRIVATE_EXPORT HTMLDecoder : public TerminalCharacterDecoder
+class KONSOLEEMULATION_EXPORT HTMLDecoder : public TerminalCharacterDecoder
 {
 public:
     /**
      * Constructs an HTML decoder using a default black-on-white color scheme.
      */
-    explicit HTMLDecoder(const Profile::Ptr &profile = Profile::Ptr());
+    HTMLDecoder();
+
+    /**
+     * Constructs an HTML decoder which uses the colors in @p colorTable,
+     * an array of TABLE_COLORS entries, and produces a document whose body
+     * is styled with @p font and the table's default colors.
+     */
+    HTMLDecoder(const ColorEntry *colorTable, const QFont &font);
+
+    /**
+     * Sets whether the appearance of the text is described by CSS classes
+     * instead of a style attribute on each span.  A class is defined by a
+     * style element when its appearance is first used, which keeps the
+     * markup of output with many colors small.
+     *
+     * Defaults to false.
+     */
+    void setStyleClasses(bool enable);
 
     void decodeLine(const Character * const characters, int count,
                     LineProperty properties) Q_DECL_OVERRIDE;
@@ -139,16 +157,50 @@ public:
     void end() Q_DECL_OVERRIDE;
 
 private:
-    void openSpan(QString &text, const QString &style);
-    void closeSpan(QString &text);
+    void openSpan(RenditionFlags rendition, const CharacterColor &foreColor,
+                  const CharacterColor &backColor);
+    void writeStyle(RenditionFlags rendition, QRgb foreColor, QRgb backColor);
 
     QTextStream *_output;
-    Profile::Ptr _profile;
-    ColorEntry _colorTable[TABLE_COLORS];
+    bool _styleBody;
+    bool _styleClasses;
+    QFont _font;
+    QRgb _palette[PALETTE_COLORS];
     bool _innerSpanOpen;
     RenditionFlags _lastRendition;
     CharacterColor _lastForeColor;
     CharacterColor _lastBackColor;
+
+    // maps the appearances used so far to their CSS classes
+    QHash<quint64, int> _styleClassIds;
+};
+
+/**
+ * A terminal character decoder which produces text with ANSI escape
+ * sequences for the colors and other appearance-related properties,
+ * which can be viewed in a terminal or with "less -R".
+ */
+class KONSOLEEMULATION_EXPORT ANSIDecoder : public TerminalCharacterDecoder
+{
+public:
+    ANSIDecoder();
+
+    void decodeLine(const Character * const characters, int count,
+                    LineProperty properties) Q_DECL_OVERRIDE;
+
+    void begin(QTextStream *output) Q_DECL_OVERRIDE;
+    void end() Q_DECL_OVERRIDE;
+
+private:
+    void writeFormat(const Character &character);
+    void writeColor(const CharacterColor &color, int base, bool boldIntensive);
+    void resetFormat();
+
+    QTextStream *_output;
+    bool _defaultFormat;
+    RenditionFlags _lastRendition;
+    CharacterColor _lastForeColor;
+    CharacterColor _lastBackColor;
 };
 }
 
@@ -29,6 +29,7 @@
 // Qt
 #include <QApplication>
 #include <QClipboard>
+#include <QElapsedTimer>
 #include <QKeyEvent>
 #include <QEvent>
 #include <QFileInfo>
@@ -38,6 +39,7 @@
 #include <QLabel>
 #include <QMimeData>
 #include <QPainter>
+#include <QPaintEngine>
 #include <QPixmap>
 #include <QScrollBar>
 #include <QStyle>
@@ -57,20 +59,23 @@
 #include <KMessageBox>
 #include <KMessageWidget>
 #include <KIO/StatJob>
+#include <KFormat>
 
 // Konsole
 #include "Filter.h"
 #include "konsoledebug.h"
 #include "TerminalCharacterDecoder.h"
 #include "Screen.h"
-#include "LineFont.h"
+#include "LineGlyphCache.h"
 #include "SessionController.h"
 #include "ExtendedCharTable.h"
 #include "TerminalDisplayAccessible.h"
 #include "SessionManager.h"
 #include "Session.h"
-#include "WindowSystemInfo.h"
 #include "IncrementalSearchBar.h"
+#include "LatencyProbe.h"
+#include "SelectionCopyJob.h"
+#include "Tracer.h"
 
 using namespace Konsole;
 
@@ -139,6 +144,8 @@ const ColorEntry* TerminalDisplay::colorTable() const
 
 void TerminalDisplay::onColorsChanged()
 {
+    fillPalette(_colorTable, _palette);
+
     // Mostly just fix the scrollbar
     // this is a workaround to add some readability to old themes like Fusion
     // changing the light value for button a bit makes themes like fusion, windows and oxygen way more readable and pleasing
@@ -164,7 +171,8 @@ void TerminalDisplay::onColorsChanged()
 
     _scrollBar->setPalette(p);
 
-    update();
+    // the text layer is recreated if the background became (in)complete
+    updateText();
 }
 
 void TerminalDisplay::setBackgroundColor(const QColor& color)
@@ -209,7 +217,7 @@ static inline bool isLineCharString(const QString& string)
         return false;
     }
 
-    return isSupportedLineChar(string.at(0).unicode());
+    return LineGlyphCache::canDraw(string.at(0).unicode());
 }
 
 void TerminalDisplay::fontChange(const QFont&)
@@ -243,7 +251,7 @@ void TerminalDisplay::fontChange(const QFont&)
 
     emit changedFontMetricSignal(_fontHeight, _fontWidth);
     propagateSize();
-    update();
+    updateText();
 }
 
 void TerminalDisplay::setVTFont(const QFont& f)
@@ -358,10 +366,21 @@ uint TerminalDisplay::lineSpacing() const
     return _lineSpacing;
 }
 
-void TerminalDisplay::setLineSpacing(uint i)
+void TerminalDisplay::setLineSpacing(uint i, bool updateLayout)
 {
+    if (_lineSpacing == i) {
+        return;
+    }
+
     _lineSpacing = i;
-    setVTFont(font()); // Trigger an update.
+    if (updateLayout) {
+        setVTFont(font()); // Trigger an update.
+    }
+}
+
+void TerminalDisplay::redraw()
+{
+    updateText();
 }
 
 
@@ -474,11 +493,25 @@ TerminalDisplay::TerminalDisplay(QWidget* parent)
     , _margin(1)
     , _centerContents(false)
     , _readOnlyMessageWidget(nullptr)
+    , _pasteProgressMessageWidget(nullptr)
+    , _pasteProgress(-1)
+    , _inputLagMessageWidget(nullptr)
+    , _inputDroppedMessageWidget(nullptr)
+    , _selectionCopyJob(nullptr)
     , _readOnly(false)
     , _opacity(1.0)
     , _dimWhenInactive(false)
     , _scrollWheelState(ScrollState())
     , _searchBar(new IncrementalSearchBar(this))
+    , _paintCount(0)
+    , _updateImageTime(0)
+    , _paintTime(0)
+    , _latencyProbe(nullptr)
+    , _lineGlyphCache(new LineGlyphCache())
+    , _accessibleFirstDirtyLine(0)
+    , _accessibleLastDirtyLine(-1)
+    , _accessibleCursorPosition(-1)
+    , _accessibilityTimer(nullptr)
 {
     // terminal applications are not designed with Right-To-Left in mind,
     // so the layout is forced to Left-To-Right
@@ -505,6 +538,12 @@ TerminalDisplay::TerminalDisplay(QWidget* parent)
     _blinkCursorTimer->setInterval(QApplication::cursorFlashTime() / 2);
     connect(_blinkCursorTimer, &QTimer::timeout, this, &Konsole::TerminalDisplay::blinkCursorEvent);
 
+    // setup timer for reporting changes to assistive technology
+    _accessibilityTimer = new QTimer(this);
+    _accessibilityTimer->setSingleShot(true);
+    _accessibilityTimer->setInterval(ACCESSIBILITY_UPDATE_DELAY);
+    connect(_accessibilityTimer, &QTimer::timeout, this, &Konsole::TerminalDisplay::sendAccessibilityEvents);
+
     // hide mouse cursor on keystroke or idle
     KCursor::setAutoHideCursor(this, true);
     setMouseTracking(true);
@@ -540,6 +579,10 @@ TerminalDisplay::TerminalDisplay(QWidget* parent)
         _verticalLayout->setContentsMargins(0, 0, scrollBarWidth, 0);
     });
 
+    // the parts of the display uncovered by the search bar are composited
+    // from the text layer, see eventFilter()
+    _searchBar->installEventFilter(this);
+
     new AutoScrollHandler(this);
 
 
@@ -557,11 +600,19 @@ TerminalDisplay::~TerminalDisplay()
 
     delete _readOnlyMessageWidget;
     delete _outputSuspendedMessageWidget;
+    delete _pasteProgressMessageWidget;
+    delete _inputLagMessageWidget;
+    delete _inputDroppedMessageWidget;
     delete[] _image;
     delete _filterChain;
+    delete _latencyProbe;
+    delete _lineGlyphCache;
 
     _readOnlyMessageWidget = nullptr;
     _outputSuspendedMessageWidget = nullptr;
+    _pasteProgressMessageWidget = nullptr;
+    _inputLagMessageWidget = nullptr;
+    _inputDroppedMessageWidget = nullptr;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -570,249 +621,30 @@ TerminalDisplay::~TerminalDisplay()
 /*                                                                           */
 /* ------------------------------------------------------------------------- */
 
-/**
- A table for emulating the simple (single width) unicode drawing chars.
- It represents the 250x - 257x glyphs. If it's zero, we can't use it.
- if it's not, it's encoded as follows: imagine a 5x5 grid where the points are numbered
- 0 to 24 left to top, top to bottom. Each point is represented by the corresponding bit.
-
- Then, the pixels basically have the following interpretation:
- _|||_
- -...-
- -...-
- -...-
- _|||_
-
-where _ = none
-      | = vertical line.
-      - = horizontal line.
- */
-
-enum LineEncode {
-    TopL  = (1 << 1),
-    TopC  = (1 << 2),
-    TopR  = (1 << 3),
-
-    LeftT = (1 << 5),
-    Int11 = (1 << 6),
-    Int12 = (1 << 7),
-    Int13 = (1 << 8),
-    RightT = (1 << 9),
-
-    LeftC = (1 << 10),
-    Int21 = (1 << 11),
-    Int22 = (1 << 12),
-    Int23 = (1 << 13),
-    RightC = (1 << 14),
-
-    LeftB = (1 << 15),
-    Int31 = (1 << 16),
-    Int32 = (1 << 17),
-    Int33 = (1 << 18),
-    RightB = (1 << 19),
-
-    BotL  = (1 << 21),
-    BotC  = (1 << 22),
-    BotR  = (1 << 23)
-};
-
-static void drawLineChar(QPainter& paint, int x, int y, int w, int h, uchar code)
-{
-    //Calculate cell midpoints, end points.
-    const int cx = x + w / 2;
-    const int cy = y + h / 2;
-    const int ex = x + w - 1;
-    const int ey = y + h - 1;
-
-    const quint32 toDraw = LineChars[code];
-
-    //Top _lines:
-    if ((toDraw & TopL) != 0u) {
-        paint.drawLine(cx - 1, y, cx - 1, cy - 2);
-    }
-    if ((toDraw & TopC) != 0u) {
-        paint.drawLine(cx, y, cx, cy - 2);
-    }
-    if ((toDraw & TopR) != 0u) {
-        paint.drawLine(cx + 1, y, cx + 1, cy - 2);
-    }
-
-    //Bot _lines:
-    if ((toDraw & BotL) != 0u) {
-        paint.drawLine(cx - 1, cy + 2, cx - 1, ey);
-    }
-    if ((toDraw & BotC) != 0u) {
-        paint.drawLine(cx, cy + 2, cx, ey);
-    }
-    if ((toDraw & BotR) != 0u) {
-        paint.drawLine(cx + 1, cy + 2, cx + 1, ey);
-    }
-
-    //Left _lines:
-    if ((toDraw & LeftT) != 0u) {
-        paint.drawLine(x, cy - 1, cx - 2, cy - 1);
-    }
-    if ((toDraw & LeftC) != 0u) {
-        paint.drawLine(x, cy, cx - 2, cy);
-    }
-    if ((toDraw & LeftB) != 0u) {
-        paint.drawLine(x, cy + 1, cx - 2, cy + 1);
-    }
-
-    //Right _lines:
-    if ((toDraw & RightT) != 0u) {
-        paint.drawLine(cx + 2, cy - 1, ex, cy - 1);
-    }
-    if ((toDraw & RightC) != 0u) {
-        paint.drawLine(cx + 2, cy, ex, cy);
-    }
-    if ((toDraw & RightB) != 0u) {
-        paint.drawLine(cx + 2, cy + 1, ex, cy + 1);
-    }
-
-    //Intersection points.
-    if ((toDraw & Int11) != 0u) {
-        paint.drawPoint(cx - 1, cy - 1);
-    }
-    if ((toDraw & Int12) != 0u) {
-        paint.drawPoint(cx, cy - 1);
-    }
-    if ((toDraw & Int13) != 0u) {
-        paint.drawPoint(cx + 1, cy - 1);
-    }
-
-    if ((toDraw & Int21) != 0u) {
-        paint.drawPoint(cx - 1, cy);
-    }
-    if ((toDraw & Int22) != 0u) {
-        paint.drawPoint(cx, cy);
-    }
-    if ((toDraw & Int23) != 0u) {
-        paint.drawPoint(cx + 1, cy);
-    }
-
-    if ((toDraw & Int31) != 0u) {
-        paint.drawPoint(cx - 1, cy + 1);
-    }
-    if ((toDraw & Int32) != 0u) {
-        paint.drawPoint(cx, cy + 1);
-    }
-    if ((toDraw & Int33) != 0u) {
-        paint.drawPoint(cx + 1, cy + 1);
-    }
-}
-
-static void drawOtherChar(QPainter& paint, int x, int y, int w, int h, uchar code)
-{
-    //Calculate cell midpoints, end points.
-    const int cx = x + w / 2;
-    const int cy = y + h / 2;
-    const int ex = x + w - 1;
-    const int ey = y + h - 1;
-
-    // Double dashes
-    if (0x4C <= code && code <= 0x4F) {
-        const int xHalfGap = qMax(w / 15, 1);
-        const int yHalfGap = qMax(h / 15, 1);
-        switch (code) {
-        case 0x4D: // BOX DRAWINGS HEAVY DOUBLE DASH HORIZONTAL
-            paint.drawLine(x, cy - 1, cx - xHalfGap - 1, cy - 1);
-            paint.drawLine(x, cy + 1, cx - xHalfGap - 1, cy + 1);
-            paint.drawLine(cx + xHalfGap, cy - 1, ex, cy - 1);
-            paint.drawLine(cx + xHalfGap, cy + 1, ex, cy + 1);
-            // No break!
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 8, 0))
-            Q_FALLTHROUGH();
-#endif
-        case 0x4C: // BOX DRAWINGS LIGHT DOUBLE DASH HORIZONTAL
-            paint.drawLine(x, cy, cx - xHalfGap - 1, cy);
-            paint.drawLine(cx + xHalfGap, cy, ex, cy);
-            break;
-        case 0x4F: // BOX DRAWINGS HEAVY DOUBLE DASH VERTICAL
-            paint.drawLine(cx - 1, y, cx - 1, cy - yHalfGap - 1);
-            paint.drawLine(cx + 1, y, cx + 1, cy - yHalfGap - 1);
-            paint.drawLine(cx - 1, cy + yHalfGap, cx - 1, ey);
-            paint.drawLine(cx + 1, cy + yHalfGap, cx + 1, ey);
-            // No break!
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 8, 0))
-            Q_FALLTHROUGH();
-#endif
-        case 0x4E: // BOX DRAWINGS LIGHT DOUBLE DASH VERTICAL
-            paint.drawLine(cx, y, cx, cy - yHalfGap - 1);
-            paint.drawLine(cx, cy + yHalfGap, cx, ey);
-            break;
-        }
-    }
-
-    // Rounded corner characters
-    else if (0x6D <= code && code <= 0x70) {
-        const int r = w * 3 / 8;
-        const int d = 2 * r;
-        switch (code) {
-        case 0x6D: // BOX DRAWINGS LIGHT ARC DOWN AND RIGHT
-            paint.drawLine(cx, cy + r, cx, ey);
-            paint.drawLine(cx + r, cy, ex, cy);
-            paint.drawArc(cx, cy, d, d, 90 * 16, 90 * 16);
-            break;
-        case 0x6E: // BOX DRAWINGS LIGHT ARC DOWN AND LEFT
-            paint.drawLine(cx, cy + r, cx, ey);
-            paint.drawLine(x, cy, cx - r, cy);
-            paint.drawArc(cx - d, cy, d, d, 0 * 16, 90 * 16);
-            break;
-        case 0x6F: // BOX DRAWINGS LIGHT ARC UP AND LEFT
-            paint.drawLine(cx, y, cx, cy - r);
-            paint.drawLine(x, cy, cx - r, cy);
-            paint.drawArc(cx - d, cy - d, d, d, 270 * 16, 90 * 16);
-            break;
-        case 0x70: // BOX DRAWINGS LIGHT ARC UP AND RIGHT
-            paint.drawLine(cx, y, cx, cy - r);
-            paint.drawLine(cx + r, cy, ex, cy);
-            paint.drawArc(cx, cy - d, d, d, 180 * 16, 90 * 16);
-            break;
-        }
-    }
-
-    // Diagonals
-    else if (0x71 <= code && code <= 0x73) {
-        switch (code) {
-        case 0x71: // BOX DRAWINGS LIGHT DIAGONAL UPPER RIGHT TO LOWER LEFT
-            paint.drawLine(ex, y, x, ey);
-            break;
-        case 0x72: // BOX DRAWINGS LIGHT DIAGONAL UPPER LEFT TO LOWER RIGHT
-            paint.drawLine(x, y, ex, ey);
-            break;
-        case 0x73: // BOX DRAWINGS LIGHT DIAGONAL CROSS
-            paint.drawLine(ex, y, x, ey);
-            paint.drawLine(x, y, ex, ey);
-            break;
-        }
-    }
-}
-
 void TerminalDisplay::drawLineCharString(QPainter& painter, int x, int y, const QString& str,
         const Character* attributes)
 {
-    painter.save();
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    const QPen& originalPen = painter.pen();
+    const bool bold = ((attributes->rendition & RE_BOLD) != 0) && _boldIntense;
+    const QSize cellSize(_fontWidth, _fontHeight);
 
-    if (((attributes->rendition & RE_BOLD) != 0) && _boldIntense) {
-        QPen boldPen(originalPen);
-        boldPen.setWidth(3);
-        painter.setPen(boldPen);
-    }
+    // printers get the lines rather than a pixmap of the screen's resolution
+    const bool useCache = painter.paintEngine()->type() == QPaintEngine::Raster;
+    const QRgb color = painter.pen().color().rgba();
+    const qreal ratio = painter.device()->devicePixelRatioF();
 
     for (int i = 0 ; i < str.length(); i++) {
-        const uchar code = str[i].cell();
-        if (LineChars[code] != 0u) {
-            drawLineChar(painter, x + (_fontWidth * i), y, _fontWidth, _fontHeight, code);
+        const uint codePoint = str[i].unicode();
+        if (!LineGlyphCache::canDraw(codePoint)) {
+            continue;
+        }
+
+        const QPoint position(x + (_fontWidth * i), y);
+        if (useCache) {
+            painter.drawPixmap(position, _lineGlyphCache->glyph(codePoint, cellSize, ratio, color, bold));
         } else {
-            drawOtherChar(painter, x + (_fontWidth * i), y, _fontWidth, _fontHeight, code);
+            LineGlyphCache::drawGlyph(painter, QRect(position, cellSize), codePoint, bold);
         }
     }
-
-    painter.restore();
 }
 
 void TerminalDisplay::setKeyboardCursorShape(Enum::CursorShapeEnum shape)
@@ -836,7 +668,7 @@ void TerminalDisplay::setCursorStyle(Enum::CursorShapeEnum shape, bool isBlinkin
     // change until the cursor is moved by the user; calling update()
     // makes the cursor shape get updated sooner.
     if (!isBlinking) {
-        update();
+        updateText();
     }
 }
 void TerminalDisplay::resetCursorStyle()
@@ -887,6 +719,7 @@ void TerminalDisplay::setOpacity(qreal opacity)
 void TerminalDisplay::setWallpaper(ColorSchemeWallpaper::Ptr p)
 {
     _wallpaper = p;
+    updateText();
 }
 
 void TerminalDisplay::drawBackground(QPainter& painter, const QRect& rect, const QColor& backgroundColor, bool useOpacitySetting)
@@ -1010,11 +843,9 @@ void TerminalDisplay::drawCharacters(QPainter& painter,
 
     // setup pen
     const CharacterColor& textColor = (invertCharacterColor ? style->backgroundColor : style->foregroundColor);
-    const QColor color = textColor.color(_colorTable);
-    QPen pen = painter.pen();
-    if (pen.color() != color) {
-        pen.setColor(color);
-        painter.setPen(color);
+    const QRgb color = textColor.rgb(_palette);
+    if (painter.pen().color().rgba() != color) {
+        painter.setPen(QColor::fromRgba(color));
     }
 
     // draw text
@@ -1027,13 +858,22 @@ void TerminalDisplay::drawCharacters(QPainter& painter,
         // This still allows RTL characters to be rendered in the RTL way.
         painter.setLayoutDirection(Qt::LeftToRight);
 
-        painter.setClipRect(rect);
+        // the clip set by updateTextLayer() has to be kept for the
+        // following fragments, so the fragment is clipped within it and
+        // the clip is put back afterwards
+        const bool clipping = painter.hasClipping();
+        const QRegion clipRegion = clipping ? painter.clipRegion() : QRegion();
+        painter.setClipRect(rect, clipping ? Qt::IntersectClip : Qt::ReplaceClip);
         if (_bidiEnabled) {
             painter.drawText(rect.x(), rect.y() + _fontAscent + _lineSpacing, text);
         } else {
             painter.drawText(rect.x(), rect.y() + _fontAscent + _lineSpacing, LTR_OVERRIDE_CHAR + text);
         }
-        painter.setClipping(false);
+        if (clipping) {
+            painter.setClipRegion(clipRegion);
+        } else {
+            painter.setClipping(false);
+        }
     }
 }
 
@@ -1042,29 +882,75 @@ void TerminalDisplay::drawTextFragment(QPainter& painter ,
                                        const QString& text,
                                        const Character* style)
 {
-    painter.save();
-
-    // setup painter
-    const QColor foregroundColor = style->foregroundColor.color(_colorTable);
-    const QColor backgroundColor = style->backgroundColor.color(_colorTable);
-
-    // draw background if different from the display's background color
-    if (backgroundColor != getBackgroundColor()) {
-        drawBackground(painter, rect, backgroundColor,
-                       false /* do not use transparency */);
-    }
+    // the painter is not saved and restored around each fragment,
+    // drawCharacters() only changes the pen and the font when the
+    // fragment needs a different one than the previous fragment
 
     // draw cursor shape if the current character is the cursor
     // this may alter the foreground and background colors
     bool invertCharacterColor = false;
     if ((style->rendition & RE_CURSOR) != 0) {
+        const QColor foregroundColor = style->foregroundColor.color(_colorTable);
+        const QColor backgroundColor = style->backgroundColor.color(_colorTable);
         drawCursor(painter, rect, foregroundColor, backgroundColor, invertCharacterColor);
     }
 
     // draw text
     drawCharacters(painter, rect, text, style, invertCharacterColor);
+}
 
-    painter.restore();
+void TerminalDisplay::drawCellBackgrounds(QPainter& painter, const QRect& rect)
+{
+    const QRgb displayBackground = _palette[DEFAULT_BACK_COLOR];
+
+    for (int y = rect.y(); y <= rect.bottom(); y++) {
+        int scaleX = 1;
+        int scaleY = 1;
+        if (y < _lineProperties.size()) {
+            if ((_lineProperties[y] & LINE_DOUBLEWIDTH) != 0) {
+                scaleX = 2;
+            }
+            if ((_lineProperties[y] & LINE_DOUBLEHEIGHT) != 0) {
+                scaleY = 2;
+            }
+        }
+
+        // include both halves of multi-column characters at the edges
+        int x = rect.x();
+        if ((_image[loc(x, y)].character == 0u) && (x != 0)) {
+            x--;
+        }
+        int right = rect.right();
+        if ((right + 1 < _usedColumns) && (_image[loc(right + 1, y)].character == 0u)) {
+            right++;
+        }
+
+        while (x <= right) {
+            const QRgb color = _image[loc(x, y)].backgroundColor.rgb(_palette);
+            int len = 1;
+            while (x + len <= right && _image[loc(x + len, y)].backgroundColor.rgb(_palette) == color) {
+                len++;
+            }
+
+            if (color != displayBackground) {
+                // like the text, runs on double-width lines start at their
+                // column and extend to twice their width
+                painter.fillRect(_contentRect.left() + contentsRect().left() + _fontWidth * x,
+                                 _contentRect.top() + contentsRect().top() + _fontHeight * y,
+                                 _fontWidth * len * scaleX,
+                                 _fontHeight * scaleY,
+                                 QColor::fromRgba(color));
+            }
+
+            x += len;
+        }
+
+        // the second line of a double-height line repeats the first one,
+        // see drawContents()
+        if (scaleY == 2 && y < _lineProperties.size() - 1) {
+            y++;
+        }
+    }
 }
 
 void TerminalDisplay::drawPrinterFriendlyTextFragment(QPainter& painter,
@@ -1103,6 +989,11 @@ uint TerminalDisplay::randomSeed() const
 // display is much cheaper than re-rendering all the text for the
 // part of the image which has moved up or down.
 // Instead only new lines have to be drawn
+//
+// the pixels are moved in the text layer rather than on screen, so the
+// wallpaper, a translucent background and the child widgets (search bar,
+// message widgets) stay where they are, and the scrolled part of the
+// display is composited again from the text layer
 void TerminalDisplay::scrollImage(int lines , const QRect& screenWindowRegion)
 {
     // return if there is nothing to do
@@ -1110,17 +1001,6 @@ void TerminalDisplay::scrollImage(int lines , const QRect& screenWindowRegion)
         return;
     }
 
-    // if the flow control warning is enabled this will interfere with the
-    // scrolling optimizations and cause artifacts.  the simple solution here
-    // is to just disable the optimization whilst it is visible
-    if ((_outputSuspendedMessageWidget != nullptr) && _outputSuspendedMessageWidget->isVisible()) {
-        return;
-    }
-
-    if ((_readOnlyMessageWidget != nullptr) && _readOnlyMessageWidget->isVisible()) {
-        return;
-    }
-
     // constrain the region to the display
     // the bottom of the region is capped to the number of lines in the display's
     // internal image - 2, so that the height of 'region' is strictly less
@@ -1135,41 +1015,21 @@ void TerminalDisplay::scrollImage(int lines , const QRect& screenWindowRegion)
         return;
     }
 
-    // hide terminal size label to prevent it being scrolled
-    if ((_resizeWidget != nullptr) && _resizeWidget->isVisible()) {
-        _resizeWidget->hide();
-    }
-
-    // Note:  With Qt 4.4 the left edge of the scrolled area must be at 0
-    // to get the correct (newly exposed) part of the widget repainted.
-    //
-    // The right edge must be before the left edge of the scroll bar to
-    // avoid triggering a repaint of the entire widget, the distance is
-    // given by SCROLLBAR_CONTENT_GAP
-    //
-    // Set the QT_FLUSH_PAINT environment variable to '1' before starting the
-    // application to monitor repainting.
-    //
-    const int scrollBarWidth = _scrollBar->isHidden() ? 0 : _scrollBar->width();
-    const int SCROLLBAR_CONTENT_GAP = 1;
-    QRect scrollRect;
-    if (_scrollbarLocation == Enum::ScrollBarLeft) {
-        scrollRect.setLeft(scrollBarWidth + SCROLLBAR_CONTENT_GAP);
-        scrollRect.setRight(width());
-    } else {
-        scrollRect.setLeft(0);
-        scrollRect.setRight(width() - scrollBarWidth - SCROLLBAR_CONTENT_GAP);
-    }
     void* firstCharPos = &_image[ region.top() * _columns ];
     void* lastCharPos = &_image[(region.top() + abs(lines)) * _columns ];
 
-    const int top = _contentRect.top() + (region.top() * _fontHeight);
+    const int top = _contentRect.top() + contentsRect().top() + (region.top() * _fontHeight);
     const int linesToMove = region.height() - abs(lines);
     const int bytesToMove = linesToMove * _columns * sizeof(Character);
 
     Q_ASSERT(linesToMove > 0);
     Q_ASSERT(bytesToMove > 0);
 
+    markAccessibleLinesDirty(region.top(), region.bottom());
+
+    int sourceTop;
+    int destinationTop;
+
     //scroll internal image
     if (lines > 0) {
         // check that the memory areas that we are going to move are valid
@@ -1181,8 +1041,8 @@ void TerminalDisplay::scrollImage(int lines , const QRect& screenWindowRegion)
         //scroll internal image down
         memmove(firstCharPos , lastCharPos , bytesToMove);
 
-        //set region of display to scroll
-        scrollRect.setTop(top);
+        sourceTop = top + lines * _fontHeight;
+        destinationTop = top;
     } else {
         // check that the memory areas that we are going to move are valid
         Q_ASSERT((char*)firstCharPos + bytesToMove <
@@ -1191,15 +1051,126 @@ void TerminalDisplay::scrollImage(int lines , const QRect& screenWindowRegion)
         //scroll internal image up
         memmove(lastCharPos , firstCharPos , bytesToMove);
 
-        //set region of the display to scroll
-        scrollRect.setTop(top + abs(lines) * _fontHeight);
+        sourceTop = top;
+        destinationTop = top + abs(lines) * _fontHeight;
+    }
+
+    const QRect sourceRect(0, sourceTop, width(), linesToMove * _fontHeight);
+    const QRect destinationRect(0, destinationTop, width(), linesToMove * _fontHeight);
+
+    Q_ASSERT(destinationRect.isValid() && !destinationRect.isEmpty());
+
+    // the lines of the text layer mirror those of _image, so after moving
+    // both the same way, the lines which were not moved still show what
+    // _image holds for them, and updateImage() finds the ones to redraw
+    ensureTextLayer();
+    const qreal ratio = _textLayer.devicePixelRatio();
+    const qreal sourceRow = sourceRect.top() * ratio;
+    const qreal destinationRow = destinationRect.top() * ratio;
+    const qreal rows = sourceRect.height() * ratio;
+    if (sourceRow != qRound(sourceRow) || destinationRow != qRound(destinationRow)
+            || rows != qRound(rows)) {
+        // lines do not start on a pixel boundary with fractional scaling,
+        // moving whole pixels would leave artifacts
+        updateText(destinationRect);
+        return;
+    }
+
+    const int bytesPerLine = _textLayer.bytesPerLine();
+    uchar* bits = _textLayer.bits();
+    memmove(bits + qRound(destinationRow) * bytesPerLine,
+            bits + qRound(sourceRow) * bytesPerLine,
+            qRound(rows) * bytesPerLine);
+
+    // parts of the layer which were not drawn yet move along
+    const QRegion movedDirt = (_textLayerDirty & sourceRect).translated(0, destinationTop - sourceTop);
+    _textLayerDirty = (_textLayerDirty - destinationRect) | (movedDirt & destinationRect);
+
+    _compositeOnlyRegion |= destinationRect;
+    update(destinationRect);
+}
+
+void TerminalDisplay::updateText(const QRegion &region)
+{
+    _textLayerDirty |= region;
+    update(region);
+}
+
+void TerminalDisplay::updateText()
+{
+    updateText(rect());
+}
+
+bool TerminalDisplay::hasOpaqueTextLayer() const
+{
+    return _wallpaper->isNull() && qAlpha(_blendColor) == 0xff;
+}
+
+void TerminalDisplay::ensureTextLayer()
+{
+    const qreal ratio = devicePixelRatioF();
+    const QSize layerSize = size() * ratio;
+    const QImage::Format format = hasOpaqueTextLayer() ? QImage::Format_RGB32
+                                                       : QImage::Format_ARGB32_Premultiplied;
+
+    if (_textLayer.size() == layerSize && _textLayer.format() == format
+            && _textLayer.devicePixelRatio() == ratio) {
+        return;
+    }
+
+    _textLayer = QImage(layerSize, format);
+    _textLayer.setDevicePixelRatio(ratio);
+    _textLayerDirty = rect();
+}
+
+void TerminalDisplay::updateTextLayer(const QRegion &dirtyRegion)
+{
+    if (dirtyRegion.isEmpty()) {
+        return;
+    }
+
+    // drawContents() draws whole cells, so the region is extended to the
+    // cells it touches.  Otherwise the glyphs of the cells on its edges
+    // would be drawn again over pixels which were not cleared, and their
+    // antialiased edges would get darker with every update
+    QRegion region = dirtyRegion;
+    QRegion dirtyImageRegion;
+    foreach(const QRect & rect, dirtyRegion.rects()) {
+        QRect imageRect = widgetToImage(rect);
+        for (int line = imageRect.top(); line <= imageRect.bottom() && line < _lineProperties.size(); line++) {
+            if ((_lineProperties[line] & LINE_DOUBLEWIDTH) != 0) {
+                imageRect.setLeft(0);
+                imageRect.setRight(_usedColumns - 1);
+                break;
+            }
+        }
+        dirtyImageRegion += imageRect;
+        region |= imageToWidget(imageRect).translated(contentsRect().topLeft());
+    }
+
+    // a painter on an image does not pick up the font of the widget
+    QPainter painter(&_textLayer);
+    painter.setFont(font());
+    painter.setLayoutDirection(layoutDirection());
+    painter.setClipRegion(region);
+
+    // on an opaque layer the text is drawn on the background color like
+    // it used to be drawn on screen, which keeps subpixel antialiasing
+    foreach(const QRect & rect, region.rects()) {
+        if (hasOpaqueTextLayer()) {
+            painter.fillRect(rect, getBackgroundColor());
+        } else {
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.fillRect(rect, Qt::transparent);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        }
     }
-    scrollRect.setHeight(linesToMove * _fontHeight);
 
-    Q_ASSERT(scrollRect.isValid() && !scrollRect.isEmpty());
+    foreach(const QRect & rect, dirtyImageRegion.rects()) {
+        drawContents(painter, rect);
+    }
 
-    //scroll the display vertically to match internal _image
-    scroll(0 , _fontHeight * (-lines) , scrollRect);
+    _textLayerDirty -= region;
 }
 
 QRegion TerminalDisplay::hotSpotRegion() const
@@ -1238,6 +1209,8 @@ QRegion TerminalDisplay::hotSpotRegion() const
 
 void TerminalDisplay::processFilters()
 {
+    KONSOLE_TRACE_SCOPE("TerminalDisplay::processFilters");
+
     if (_screenWindow.isNull()) {
         return;
     }
@@ -1248,15 +1221,12 @@ void TerminalDisplay::processFilters()
 
     QRegion preUpdateHotSpots = hotSpotRegion();
 
-    // use _screenWindow->getImage() here rather than _image because
+    // use _screenWindow->snapshot() here rather than _image because
     // other classes may call processFilters() when this display's
     // ScreenWindow emits a scrolled() signal - which will happen before
     // updateImage() is called on the display and therefore _image is
     // out of date at this point
-    _filterChain->setImage(_screenWindow->getImage(),
-                           _screenWindow->windowLines(),
-                           _screenWindow->windowColumns(),
-                           _screenWindow->getLineProperties());
+    _filterChain->setImage(_screenWindow->snapshot());
     _filterChain->process();
 
     QRegion postUpdateHotSpots = hotSpotRegion();
@@ -1267,19 +1237,21 @@ void TerminalDisplay::processFilters()
 
 void TerminalDisplay::updateImage()
 {
+    KONSOLE_TRACE_SCOPE("TerminalDisplay::updateImage");
+
     if (_screenWindow.isNull()) {
         return;
     }
 
+    QElapsedTimer updateTimer;
+    updateTimer.start();
+
     // optimization - scroll the existing image where possible and
     // avoid expensive text drawing for parts of the image that
     // can simply be moved up or down
-    // disable this shortcut for transparent konsole with scaled pixels, otherwise we get rendering artifacts, see BUG 350651
-    if (!(WindowSystemInfo::HAVE_TRANSPARENCY && (qApp->devicePixelRatio() > 1.0)) && _wallpaper->isNull() && !_searchBar->isVisible()) {
-        scrollImage(_screenWindow->scrollCount() ,
-                    _screenWindow->scrollRegion());
-        _screenWindow->resetScrollCount();
-    }
+    scrollImage(_screenWindow->scrollCount() ,
+                _screenWindow->scrollRegion());
+    _screenWindow->resetScrollCount();
 
     if (_image == nullptr) {
         // Create _image.
@@ -1287,7 +1259,7 @@ void TerminalDisplay::updateImage()
         updateImageSize();
     }
 
-    Character* const newimg = _screenWindow->getImage();
+    const Character* const newimg = _screenWindow->getImage();
     const int lines = _screenWindow->windowLines();
     const int columns = _screenWindow->windowColumns();
 
@@ -1327,11 +1299,16 @@ void TerminalDisplay::updateImage()
         // its cell boundaries
         memset(dirtyMask, 0, columnsToUpdate + 2);
 
+        bool lineChanged = false;
         for (x = 0 ; x < columnsToUpdate ; ++x) {
             if (newLine[x] != currentLine[x]) {
                 dirtyMask[x] = 1;
+                lineChanged = true;
             }
         }
+        if (lineChanged) {
+            markAccessibleLinesDirty(y, y);
+        }
 
         if (!_resizing) { // not while _resizing, we're expecting a paintEvent
             for (x = 0; x < columnsToUpdate; ++x) {
@@ -1417,6 +1394,9 @@ void TerminalDisplay::updateImage()
 
     // if the new _image is smaller than the previous _image, then ensure that the area
     // outside the new _image is cleared
+    if (linesToUpdate != _usedLines || columnsToUpdate != _usedColumns) {
+        markAccessibleLinesDirty(0, qMax(linesToUpdate, _usedLines) - 1);
+    }
     if (linesToUpdate < _usedLines) {
         dirtyRegion |= QRect(_contentRect.left() + tLx ,
                              _contentRect.top() + tLy + _fontHeight * linesToUpdate ,
@@ -1435,8 +1415,12 @@ void TerminalDisplay::updateImage()
 
     dirtyRegion |= _inputMethodData.previousPreeditRect;
 
+    if ((_latencyProbe != nullptr) && !dirtyRegion.isEmpty()) {
+        _latencyProbe->contentChanged(_latencyProbe->now());
+    }
+
     // update the parts of the display which have changed
-    update(dirtyRegion);
+    updateText(dirtyRegion);
 
     if (_allowBlinkingText && _hasTextBlinker && !_blinkTextTimer->isActive()) {
         _blinkTextTimer->start();
@@ -1448,10 +1432,72 @@ void TerminalDisplay::updateImage()
     delete[] dirtyMask;
 
 #ifndef QT_NO_ACCESSIBILITY
-    QAccessibleEvent dataChangeEvent(this, QAccessible::VisibleDataChanged);
-    QAccessible::updateAccessibility(&dataChangeEvent);
-    QAccessibleTextCursorEvent cursorEvent(this, _usedColumns * screenWindow()->screen()->getCursorY() + screenWindow()->screen()->getCursorX());
-    QAccessible::updateAccessibility(&cursorEvent);
+    // the cursor may have moved without changing the text
+    if (QAccessible::isActive() && !_accessibilityTimer->isActive()) {
+        _accessibilityTimer->start();
+    }
+#endif
+
+    _updateImageTime += updateTimer.nsecsElapsed();
+}
+
+void TerminalDisplay::markAccessibleLinesDirty(int firstLine, int lastLine)
+{
+#ifndef QT_NO_ACCESSIBILITY
+    if (!QAccessible::isActive()) {
+        return;
+    }
+
+    if (_accessibleFirstDirtyLine > _accessibleLastDirtyLine) {
+        _accessibleFirstDirtyLine = firstLine;
+        _accessibleLastDirtyLine = lastLine;
+    } else {
+        _accessibleFirstDirtyLine = qMin(_accessibleFirstDirtyLine, firstLine);
+        _accessibleLastDirtyLine = qMax(_accessibleLastDirtyLine, lastLine);
+    }
+
+    if (!_accessibilityTimer->isActive()) {
+        _accessibilityTimer->start();
+    }
+#else
+    Q_UNUSED(firstLine)
+    Q_UNUSED(lastLine)
+#endif
+}
+
+void TerminalDisplay::sendAccessibilityEvents()
+{
+#ifndef QT_NO_ACCESSIBILITY
+    const int firstLine = _accessibleFirstDirtyLine;
+    const int lastLine = _accessibleLastDirtyLine;
+    _accessibleFirstDirtyLine = 0;
+    _accessibleLastDirtyLine = -1;
+
+    if (_screenWindow.isNull() || !QAccessible::isActive()) {
+        return;
+    }
+
+    auto accessible = dynamic_cast<TerminalDisplayAccessible *>(QAccessible::queryAccessibleInterface(this));
+    if (accessible == nullptr) {
+        return;
+    }
+
+    if (firstLine <= lastLine) {
+        int position = 0;
+        QString oldText;
+        QString newText;
+        if (accessible->updateLines(firstLine, lastLine, &position, &oldText, &newText)) {
+            QAccessibleTextUpdateEvent updateEvent(this, position, oldText, newText);
+            QAccessible::updateAccessibility(&updateEvent);
+        }
+    }
+
+    const int cursorPosition = accessible->cursorPosition();
+    if (cursorPosition != _accessibleCursorPosition) {
+        _accessibleCursorPosition = cursorPosition;
+        QAccessibleTextCursorEvent cursorEvent(this, cursorPosition);
+        QAccessible::updateAccessibility(&cursorEvent);
+    }
 #endif
 }
 
@@ -1465,6 +1511,7 @@ void TerminalDisplay::showResizeNotification()
             _resizeWidget->setAlignment(Qt::AlignCenter);
 
             _resizeWidget->setStyleSheet(QStringLiteral("background-color:palette(window);border-style:solid;border-width:1px;border-color:palette(dark)"));
+            _resizeWidget->installEventFilter(this);
 
             _resizeTimer = new QTimer(this);
             _resizeTimer->setInterval(SIZE_HINT_DURATION);
@@ -1482,18 +1529,33 @@ void TerminalDisplay::showResizeNotification()
 
 void TerminalDisplay::paintEvent(QPaintEvent* pe)
 {
+    KONSOLE_TRACE_SCOPE("TerminalDisplay::paintEvent");
+
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
+    const QRegion paintRegion = pe->region() & contentsRect();
+
+    // the text is drawn into the text layer, and only where it changed or
+    // may have changed.  Parts of the display which were scrolled or
+    // uncovered by a child widget are just composited from the layer
+    ensureTextLayer();
+    updateTextLayer((paintRegion - _compositeOnlyRegion) | (paintRegion & _textLayerDirty));
+    _compositeOnlyRegion -= paintRegion;
+
     QPainter paint(this);
 
-    // Determine which characters should be repainted (1 region unit = 1 character)
-    QRegion dirtyImageRegion;
-    foreach(const QRect & rect, (pe->region() & contentsRect()).rects()) {
-        dirtyImageRegion += widgetToImage(rect);
-        drawBackground(paint, rect, getBackgroundColor(), true /* use opacity setting */);
+    const bool opaque = hasOpaqueTextLayer();
+    const qreal ratio = _textLayer.devicePixelRatio();
+    foreach(const QRect & rect, paintRegion.rects()) {
+        if (!opaque) {
+            drawBackground(paint, rect, getBackgroundColor(), true /* use opacity setting */);
+        }
+        const QRectF source(rect.x() * ratio, rect.y() * ratio,
+                            rect.width() * ratio, rect.height() * ratio);
+        paint.drawImage(QRectF(rect), _textLayer, source);
     }
 
-    foreach(const QRect & rect, dirtyImageRegion.rects()) {
-        drawContents(paint, rect);
-    }
     drawCurrentResultRect(paint);
     drawInputMethodPreeditString(paint, preeditRect());
     paintFilters(paint);
@@ -1505,6 +1567,77 @@ void TerminalDisplay::paintEvent(QPaintEvent* pe)
             paint.fillRect(rect, dimColor);
         }
     }
+
+    if (_latencyProbe != nullptr) {
+        drawLatencyOverlay(paint);
+    }
+
+    paint.end();
+    _paintCount++;
+    _paintTime += paintTimer.nsecsElapsed();
+
+    if ((_latencyProbe != nullptr) && _latencyProbe->painted(_latencyProbe->now())) {
+        // show the new sample.  The overlay is not part of the text
+        // layer, so the layer only needs to be composited again
+        _compositeOnlyRegion |= latencyOverlayRect();
+        update(latencyOverlayRect());
+    }
+}
+
+void TerminalDisplay::resetStatistics()
+{
+    _paintCount = 0;
+    _updateImageTime = 0;
+    _paintTime = 0;
+    if (_latencyProbe != nullptr) {
+        _latencyProbe->reset();
+        _compositeOnlyRegion |= latencyOverlayRect();
+        update(latencyOverlayRect());
+    }
+}
+
+void TerminalDisplay::setLatencyProbeEnabled(bool enable)
+{
+    if (enable == (_latencyProbe != nullptr)) {
+        return;
+    }
+
+    // repaint the overlay area before the probe is deleted or after it is created
+    _compositeOnlyRegion |= latencyOverlayRect();
+    update(latencyOverlayRect());
+
+    if (enable) {
+        _latencyProbe = new LatencyProbe();
+    } else {
+        delete _latencyProbe;
+        _latencyProbe = nullptr;
+    }
+}
+
+QRect TerminalDisplay::latencyOverlayRect() const
+{
+    const QFontMetrics metrics(QApplication::font());
+    const QSize size(metrics.width(QStringLiteral("p50 0000.0 ms  p99 0000.0 ms  n=0000")) + 2 * _margin,
+                     metrics.height() + 2 * _margin);
+    const QRect area = contentsRect();
+    return QRect(area.right() - size.width(), area.top(), size.width(), size.height());
+}
+
+void TerminalDisplay::drawLatencyOverlay(QPainter &painter)
+{
+    const QVector<qint64> samples = _latencyProbe->samples();
+    const QString text = QStringLiteral("p50 %1 ms  p99 %2 ms  n=%3")
+                         .arg(LatencyProbe::percentile(samples, 50) / 1e6, 0, 'f', 1)
+                         .arg(LatencyProbe::percentile(samples, 99) / 1e6, 0, 'f', 1)
+                         .arg(samples.size());
+
+    const QRect rect = latencyOverlayRect();
+    painter.save();
+    painter.setFont(QApplication::font());
+    painter.fillRect(rect, palette().window());
+    painter.setPen(palette().windowText().color());
+    painter.drawText(rect, Qt::AlignCenter, text);
+    painter.restore();
 }
 
 void TerminalDisplay::printContent(QPainter& painter, bool friendly)
@@ -1715,6 +1848,14 @@ inline static bool isRtl(const Character &chr) {
 
 void TerminalDisplay::drawContents(QPainter& paint, const QRect& rect)
 {
+    paint.save();
+
+    // the backgrounds are drawn first, so that fragments of text only
+    // have to be split where the foreground changes
+    if (!_printerFriendly) {
+        drawCellBackgrounds(paint, rect);
+    }
+
     const int numberOfColumns = _usedColumns;
     QVector<uint> univec;
     univec.reserve(numberOfColumns);
@@ -1759,14 +1900,12 @@ void TerminalDisplay::drawContents(QPainter& paint, const QRect& rect)
             const bool lineDraw = _image[loc(x, y)].isLineChar();
             const bool doubleWidth = (_image[qMin(loc(x, y) + 1, _imageSize - 1)].character == 0);
             const CharacterColor currentForeground = _image[loc(x, y)].foregroundColor;
-            const CharacterColor currentBackground = _image[loc(x, y)].backgroundColor;
             const RenditionFlags currentRendition = _image[loc(x, y)].rendition;
             const bool rtl = isRtl(_image[loc(x, y)]);
 
             if(_image[loc(x, y)].character <= 0x7e || rtl) {
                 while (x + len <= rect.right() &&
                         _image[loc(x + len, y)].foregroundColor == currentForeground &&
-                        _image[loc(x + len, y)].backgroundColor == currentBackground &&
                         (_image[loc(x + len, y)].rendition & ~RE_EXTENDED_CHAR) == (currentRendition & ~RE_EXTENDED_CHAR) &&
                         (_image[qMin(loc(x + len, y) + 1, _imageSize - 1)].character == 0) == doubleWidth &&
                         _image[loc(x + len, y)].isLineChar() == lineDraw &&
@@ -1877,6 +2016,8 @@ void TerminalDisplay::drawContents(QPainter& paint, const QRect& rect)
             x += len - 1;
         }
     }
+
+    paint.restore();
 }
 
 void TerminalDisplay::drawCurrentResultRect(QPainter& painter)
@@ -1999,7 +2140,7 @@ void TerminalDisplay::blinkTextEvent()
 
     // TODO: Optimize to only repaint the areas of the widget where there is
     // blinking text rather than repainting the whole widget.
-    update();
+    updateText();
 }
 
 void TerminalDisplay::blinkCursorEvent()
@@ -2021,7 +2162,7 @@ void TerminalDisplay::updateCursor()
 
     int charWidth = _image[cursorLocation].width();
     QRect cursorRect = imageToWidget(QRect(cursorPosition(), QSize(charWidth, 1)));
-    update(cursorRect);
+    updateText(cursorRect);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -2186,7 +2327,7 @@ void TerminalDisplay::setCenterContents(bool enable)
 {
     _centerContents = enable;
     calcGeometry();
-    update();
+    updateText();
 }
 
 /* ------------------------------------------------------------------------- */
@@ -2210,7 +2351,7 @@ void TerminalDisplay::setScrollBarPosition(Enum::ScrollBarPositionEnum position)
     _scrollbarLocation = position;
 
     propagateSize();
-    update();
+    updateText();
 }
 
 void TerminalDisplay::scrollBarPositionChanged(int)
@@ -2295,6 +2436,12 @@ void TerminalDisplay::mousePressEvent(QMouseEvent* ev)
         }
     }
 
+    if (_pasteProgressMessageWidget != nullptr) {
+        if (_pasteProgressMessageWidget->isVisible() && _pasteProgressMessageWidget->frameGeometry().contains(ev->pos())) {
+            return;
+        }
+    }
+
     int charLine;
     int charColumn;
     getCharacterPosition(ev->pos(), charLine, charColumn, !_usesMouseTracking);
@@ -3292,12 +3439,11 @@ void TerminalDisplay::doPaste(QString text, bool appendReturn)
         text.replace(QLatin1Char('\n'), QLatin1Char('\r'));
         if (bracketedPasteMode()) {
             text.remove(QLatin1String("\033"));
-            text.prepend(QLatin1String("\033[200~"));
-            text.append(QLatin1String("\033[201~"));
         }
-        // perform paste by simulating keypress events
-        QKeyEvent e(QEvent::KeyPress, 0, Qt::NoModifier, text);
-        emit keyPressedSignal(&e);
+        // the session sends the text in chunks and adds the bracketed
+        // paste sequences
+        _screenWindow->setTrackOutput(true);
+        emit pasteRequested(text, bracketedPasteMode());
     }
 }
 
@@ -3322,6 +3468,16 @@ void TerminalDisplay::copyToX11Selection()
         return;
     }
 
+    QList<QClipboard::Mode> modes;
+    if (QApplication::clipboard()->supportsSelection()) {
+        modes << QClipboard::Selection;
+    }
+    if (_autoCopySelectedText) {
+        modes << QClipboard::Clipboard;
+    }
+    if (!modes.isEmpty() && startSelectionCopyJob(modes)) {
+        return;
+    }
 
     const QString &text = _screenWindow->selectedText(currentDecodingOptions());
     if (text.isEmpty()) {
@@ -3350,6 +3506,10 @@ void TerminalDisplay::copyToClipboard()
         return;
     }
 
+    if (startSelectionCopyJob(QList<QClipboard::Mode>() << QClipboard::Clipboard)) {
+        return;
+    }
+
     const QString &text = _screenWindow->selectedText(currentDecodingOptions());
     if (text.isEmpty()) {
         return;
@@ -3365,6 +3525,34 @@ void TerminalDisplay::copyToClipboard()
     QApplication::clipboard()->setMimeData(mimeData, QClipboard::Clipboard);
 }
 
+bool TerminalDisplay::startSelectionCopyJob(const QList<QClipboard::Mode> &modes)
+{
+    int startColumn;
+    int startLine;
+    int endColumn;
+    int endLine;
+    _screenWindow->getSelectionStart(startColumn, startLine);
+    _screenWindow->getSelectionEnd(endColumn, endLine);
+    if (endLine - startLine < LARGE_SELECTION_LINES) {
+        return false;
+    }
+
+    if (_selectionCopyJob != nullptr) {
+        _selectionCopyJob->cancel();
+    }
+
+    _selectionCopyJob = new SelectionCopyJob(_screenWindow, currentDecodingOptions(),
+                                             _copyTextAsHTML, modes, this);
+    connect(_selectionCopyJob, &Konsole::SelectionCopyJob::finished, this, [this]() {
+        _selectionCopyJob = nullptr;
+        emit copyInProgress(false);
+    });
+
+    emit copyInProgress(true);
+    _selectionCopyJob->start();
+    return true;
+}
+
 void TerminalDisplay::pasteFromClipboard(bool appendEnter)
 {
     QString text = QApplication::clipboard()->text(QClipboard::Clipboard);
@@ -3517,6 +3705,7 @@ KMessageWidget* TerminalDisplay::createMessageWidget(const QString &text) {
     widget->setWordWrap(true);
     widget->setFocusProxy(this);
     widget->setCursor(Qt::ArrowCursor);
+    widget->installEventFilter(this);
 
     _verticalLayout->insertWidget(0, widget);
     return widget;
@@ -3542,6 +3731,80 @@ void TerminalDisplay::updateReadOnlyState(bool readonly) {
     _readOnly = readonly;
 }
 
+void TerminalDisplay::setPasteProgress(int percent)
+{
+    _pasteProgress = percent;
+
+    if (percent < 0) {
+        if (_pasteProgressMessageWidget != nullptr) {
+            _pasteProgressMessageWidget->animatedHide();
+        }
+        return;
+    }
+
+    if (_pasteProgressMessageWidget == nullptr) {
+        _pasteProgressMessageWidget = createMessageWidget(QString());
+        _pasteProgressMessageWidget->setMessageType(KMessageWidget::Information);
+
+        auto cancelAction = new QAction(QIcon::fromTheme(QStringLiteral("dialog-cancel")),
+                                        i18n("Cancel"), _pasteProgressMessageWidget);
+        connect(cancelAction, &QAction::triggered, this, &Konsole::TerminalDisplay::pasteCancelRequested);
+        _pasteProgressMessageWidget->addAction(cancelAction);
+    }
+
+    _pasteProgressMessageWidget->setText(i18n("Pasting text: %1% done. Press Escape to cancel.", percent));
+    if (!_pasteProgressMessageWidget->isVisible()) {
+        _pasteProgressMessageWidget->animatedShow();
+    }
+}
+
+void TerminalDisplay::setInputLag(qint64 queued, qint64 dropped)
+{
+    KFormat format;
+
+    if (dropped <= 0) {
+        if (_inputDroppedMessageWidget != nullptr) {
+            _inputDroppedMessageWidget->animatedHide();
+        }
+    } else {
+        if (_inputDroppedMessageWidget == nullptr) {
+            _inputDroppedMessageWidget = createMessageWidget(QString());
+            _inputDroppedMessageWidget->setMessageType(KMessageWidget::Error);
+
+            auto resumeAction = new QAction(QIcon::fromTheme(QStringLiteral("media-playback-start")),
+                                            i18n("Resume"), _inputDroppedMessageWidget);
+            connect(resumeAction, &QAction::triggered, this, &Konsole::TerminalDisplay::resumeGroupInputRequested);
+            _inputDroppedMessageWidget->addAction(resumeAction);
+        }
+
+        _inputDroppedMessageWidget->setText(i18n("%1 of input copied from other tabs were discarded, "
+                                                 "because the program did not read it fast enough. "
+                                                 "No more input is copied to this tab until you resume.",
+                                                 format.formatByteSize(dropped)));
+        if (!_inputDroppedMessageWidget->isVisible()) {
+            _inputDroppedMessageWidget->animatedShow();
+        }
+    }
+
+    if (queued <= 0) {
+        if (_inputLagMessageWidget != nullptr) {
+            _inputLagMessageWidget->animatedHide();
+        }
+        return;
+    }
+
+    if (_inputLagMessageWidget == nullptr) {
+        _inputLagMessageWidget = createMessageWidget(QString());
+        _inputLagMessageWidget->setMessageType(KMessageWidget::Warning);
+    }
+
+    _inputLagMessageWidget->setText(i18n("Input copied from other tabs is waiting to be sent: %1.",
+                                         format.formatByteSize(queued)));
+    if (!_inputLagMessageWidget->isVisible()) {
+        _inputLagMessageWidget->animatedShow();
+    }
+}
+
 void TerminalDisplay::scrollScreenWindow(enum ScreenWindow::RelativeScrollMode mode, int amount)
 {
     _screenWindow->scrollBy(mode, amount, _scrollFullPage);
@@ -3553,6 +3816,10 @@ void TerminalDisplay::scrollScreenWindow(enum ScreenWindow::RelativeScrollMode m
 
 void TerminalDisplay::keyPressEvent(QKeyEvent* event)
 {
+    if ((_latencyProbe != nullptr) && !_readOnly) {
+        _latencyProbe->keyPressed(_latencyProbe->now());
+    }
+
     if ((_urlHintsModifiers != 0u) && event->modifiers() == _urlHintsModifiers) {
         int nHotSpots = _filterChain->hotSpots().count();
         int hintSelected = event->key() - 0x31;
@@ -3575,6 +3842,15 @@ void TerminalDisplay::keyPressEvent(QKeyEvent* event)
 
     _screenWindow->screen()->setCurrentTerminalDisplay(this);
 
+    if (_pasteProgress >= 0) {
+        // keys typed now would end up in the middle of the pasted text
+        if (event->key() == Qt::Key_Escape) {
+            emit pasteCancelRequested();
+        }
+        event->accept();
+        return;
+    }
+
     if (!_readOnly) {
         _actSel = 0; // Key stroke implies a screen update, so TerminalDisplay won't
                      // know where the current selection is.
@@ -3597,7 +3873,8 @@ void TerminalDisplay::keyPressEvent(QKeyEvent* event)
 
 #ifndef QT_NO_ACCESSIBILITY
     if (!_readOnly) {
-        QAccessibleTextCursorEvent textCursorEvent(this, _usedColumns * screenWindow()->screen()->getCursorY() + screenWindow()->screen()->getCursorX());
+        _accessibleCursorPosition = _usedColumns * screenWindow()->screen()->getCursorY() + screenWindow()->screen()->getCursorX();
+        QAccessibleTextCursorEvent textCursorEvent(this, _accessibleCursorPosition);
         QAccessible::updateAccessibility(&textCursorEvent);
     }
 #endif
@@ -3668,6 +3945,30 @@ bool TerminalDisplay::handleShortcutOverrideEvent(QKeyEvent* keyEvent)
     return false;
 }
 
+bool TerminalDisplay::eventFilter(QObject *watched, QEvent *event)
+{
+    // the parts of the display a child widget leaves are composited from
+    // the text layer, the text below the widget did not change
+    auto widget = qobject_cast<QWidget*>(watched);
+    if (widget != nullptr && widget->parentWidget() == this) {
+        switch (event->type()) {
+        case QEvent::Hide:
+            _compositeOnlyRegion |= widget->geometry();
+            break;
+        case QEvent::Move:
+            _compositeOnlyRegion |= QRect(static_cast<QMoveEvent*>(event)->oldPos(), widget->size());
+            break;
+        case QEvent::Resize:
+            _compositeOnlyRegion |= QRect(widget->pos(), static_cast<QResizeEvent*>(event)->oldSize());
+            break;
+        default:
+            break;
+        }
+    }
+
+    return QWidget::eventFilter(watched, event);
+}
+
 bool TerminalDisplay::event(QEvent* event)
 {
     bool eventHandled = false;
@@ -3681,7 +3982,7 @@ bool TerminalDisplay::event(QEvent* event)
         break;
     case QEvent::FocusOut:
     case QEvent::FocusIn:
-        update();
+        updateText();
         break;
     default:
         break;
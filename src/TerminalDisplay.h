@@ -22,7 +22,9 @@
 #define TERMINALDISPLAY_H
 
 // Qt
+#include <QClipboard>
 #include <QColor>
+#include <QImage>
 #include <QPointer>
 #include <QWidget>
 
@@ -53,6 +55,9 @@ class FilterChain;
 class TerminalImageFilterChain;
 class SessionController;
 class IncrementalSearchBar;
+class LatencyProbe;
+class LineGlyphCache;
+class SelectionCopyJob;
 /**
  * A widget which displays output from a terminal emulation and sends input keypresses and mouse activity
  * to the terminal.
@@ -241,9 +246,20 @@ public:
         return _trimTrailingSpaces;
     }
 
-    void setLineSpacing(uint);
+    /**
+     * Sets the number of pixels between lines.  If @p updateLayout is
+     * false, the display is not laid out again, which is left to a
+     * following setVTFont().
+     */
+    void setLineSpacing(uint, bool updateLayout = true);
     uint lineSpacing() const;
 
+    /**
+     * Draws the whole display again, after changes to settings which
+     * only affect how the text is drawn.
+     */
+    void redraw();
+
     void setSessionController(SessionController *controller);
     SessionController *sessionController();
 
@@ -583,6 +599,41 @@ public:
     /** See setAlternateScrolling() */
     bool alternateScrolling() const;
 
+    /** Returns the number of paint events handled since the last resetStatistics() */
+    quint64 paintCount() const
+    {
+        return _paintCount;
+    }
+
+    /** Returns the time spent in updateImage() comparing and invalidating the image, in nanoseconds */
+    qint64 updateImageTime() const
+    {
+        return _updateImageTime;
+    }
+
+    /** Returns the time spent handling paint events, in nanoseconds */
+    qint64 paintTime() const
+    {
+        return _paintTime;
+    }
+
+    /** Resets the paint count and the update and paint times to zero. */
+    void resetStatistics();
+
+    /**
+     * Enables or disables measuring the latency between key presses and
+     * the repaint which shows their echo.  While enabled, the 50th and
+     * 99th percentile of the latency are shown in the top right corner
+     * of the display.
+     */
+    void setLatencyProbeEnabled(bool enable);
+
+    /** Returns the latency probe, or null if it is disabled. */
+    LatencyProbe *latencyProbe() const
+    {
+        return _latencyProbe;
+    }
+
 public Q_SLOTS:
     /**
      * Scrolls current ScreenWindow
@@ -705,6 +756,25 @@ public Q_SLOTS:
 
     // Used to show/hide the message widget
     void updateReadOnlyState(bool readonly);
+
+    /**
+     * Shows the progress of a paste in a message widget, with an action
+     * to cancel it.  A negative @p percent hides the message again.
+     *
+     * While a paste is in progress, pressing Escape cancels it and other
+     * key presses are ignored, since they would be mixed into the pasted
+     * text.
+     */
+    void setPasteProgress(int percent);
+
+    /**
+     * Shows how much input copied from other sessions waits to be sent
+     * to this display's session, see Session::setInputLag().  A @p queued
+     * size of 0 hides the message again.  Once input was @p dropped, a
+     * second message stays until the user resumes the copying with
+     * resumeGroupInputRequested().
+     */
+    void setInputLag(qint64 queued, qint64 dropped);
     IncrementalSearchBar *searchBar() const;
 Q_SIGNALS:
 
@@ -745,11 +815,37 @@ Q_SIGNALS:
 
     void sendStringToEmu(const QByteArray &local8BitString);
 
+    /**
+     * Emitted when the user pastes @p text.  Newlines have been replaced
+     * with carriage returns already.
+     *
+     * @param bracketed True if the program running in the terminal
+     * enabled bracketed paste mode
+     */
+    void pasteRequested(const QString &text, bool bracketed);
+
+    /** Emitted when the user cancels the paste in progress. */
+    void pasteCancelRequested();
+
+    /**
+     * Emitted when the user acknowledges that input copied from other
+     * sessions was discarded, see setInputLag().
+     */
+    void resumeGroupInputRequested();
+
+    /**
+     * Emitted when copying a large selection starts and ends.  Output
+     * from the terminal program should be held back in the meantime,
+     * otherwise the selection moves and the copy is canceled.
+     */
+    void copyInProgress(bool inProgress);
+
     void focusLost();
     void focusGained();
 
 protected:
     bool event(QEvent *event) Q_DECL_OVERRIDE;
+    bool eventFilter(QObject *watched, QEvent *event) Q_DECL_OVERRIDE;
 
     void paintEvent(QPaintEvent *pe) Q_DECL_OVERRIDE;
 
@@ -827,20 +923,32 @@ private Q_SLOTS:
 
     void dismissOutputSuspendedMessage();
 
+    // reports the lines changed since the last call and the cursor
+    // position to assistive technology
+    void sendAccessibilityEvents();
+
 private:
     Q_DISABLE_COPY(TerminalDisplay)
 
+    // adds lines to the range reported by sendAccessibilityEvents() and
+    // starts the timer for it, if assistive technology is listening
+    void markAccessibleLinesDirty(int firstLine, int lastLine);
+
     // -- Drawing helpers --
 
-    // divides the part of the display specified by 'rect' into
-    // fragments according to their colors and styles and calls
-    // drawTextFragment() or drawPrinterFriendlyTextFragment()
-    // to draw the fragments
+    // draws the backgrounds of the part of the display specified by 'rect'
+    // with drawCellBackgrounds(), then divides it into fragments according
+    // to their foreground colors and styles and calls drawTextFragment()
+    // or drawPrinterFriendlyTextFragment() to draw the fragments
     void drawContents(QPainter &painter, const QRect &rect);
+    // fills runs of cells with the same background color, which is not the
+    // display's background color, one rectangle per run
+    void drawCellBackgrounds(QPainter &painter, const QRect &rect);
     // draw a transparent rectangle over the line of the current match
     void drawCurrentResultRect(QPainter &painter);
     // draws a section of text, all the text in this section
-    // has a common color and style
+    // has a common foreground color and style.  The background of the
+    // section has already been drawn by drawCellBackgrounds()
     void drawTextFragment(QPainter &painter, const QRect &rect, const QString &text,
                           const Character *style);
 
@@ -858,13 +966,17 @@ private:
     // draws the characters or line graphics in a text fragment
     void drawCharacters(QPainter &painter, const QRect &rect, const QString &text,
                         const Character *style, bool invertCharacterColor);
-    // draws a string of line graphics
+    // draws a string of line graphics, block elements or braille patterns
     void drawLineCharString(QPainter &painter, int x, int y, const QString &str,
                             const Character *attributes);
 
     // draws the preedit string for input methods
     void drawInputMethodPreeditString(QPainter &painter, const QRect &rect);
 
+    // draws the key press latency percentiles of the latency probe
+    void drawLatencyOverlay(QPainter &painter);
+    QRect latencyOverlayRect() const;
+
     // --
 
     // maps an area in the character image to an area on the widget
@@ -891,6 +1003,19 @@ private:
     // the left and right are ignored.
     void scrollImage(int lines, const QRect &screenWindowRegion);
 
+    // schedules a repaint of @p region after the text in it has changed,
+    // or of the whole display if no region is given
+    void updateText(const QRegion &region);
+    void updateText();
+
+    // returns true if the text layer is drawn on the background color,
+    // false if it is composited over a wallpaper or a translucent background
+    bool hasOpaqueTextLayer() const;
+    // creates _textLayer if it has been dropped or the display was resized
+    void ensureTextLayer();
+    // draws the text of the cells touched by @p dirtyRegion into _textLayer
+    void updateTextLayer(const QRegion &dirtyRegion);
+
     void calcGeometry();
     void propagateSize();
     void updateImageSize();
@@ -928,6 +1053,10 @@ private:
     // Boilerplate setup for MessageWidget
     KMessageWidget* createMessageWidget(const QString &text);
 
+    // copies the selection with a SelectionCopyJob if it spans many lines,
+    // returns false if the selection is small enough to be copied directly
+    bool startSelectionCopyJob(const QList<QClipboard::Mode> &modes);
+
     int loc(int x, int y) const;
 
     // the window onto the terminal screen which this display
@@ -963,6 +1092,10 @@ private:
     QVector<LineProperty> _lineProperties;
 
     ColorEntry _colorTable[TABLE_COLORS];
+    // _colorTable and the 256 indexed colors as QRgb values, used to
+    // resolve the colors of the characters when drawing them.  This is
+    // refilled by onColorsChanged() whenever _colorTable changes
+    QRgb _palette[PALETTE_COLORS];
 
     uint _randomSeed;
 
@@ -1055,9 +1188,16 @@ private:
     //the delay in milliseconds between redrawing blinking text
     static const int TEXT_BLINK_DELAY = 500;
 
+    //the delay in milliseconds before changes of the text are reported to
+    //assistive technology, so that the changes of one frame are sent together
+    static const int ACCESSIBILITY_UPDATE_DELAY = 16;
+
     //the duration of the size hint in milliseconds
     static const int SIZE_HINT_DURATION = 1000;
 
+    //selections spanning more lines are copied by a SelectionCopyJob
+    static const int LARGE_SELECTION_LINES = 10000;
+
     SessionController *_sessionController;
 
     bool _trimLeadingSpaces;   // trim leading spaces in selected text
@@ -1068,6 +1208,11 @@ private:
     bool _centerContents;   // center the contents between margins
 
     KMessageWidget *_readOnlyMessageWidget; // Message shown at the top when read-only mode gets activated
+    KMessageWidget *_pasteProgressMessageWidget;
+    int _pasteProgress; // percentage of the paste in progress, or -1
+    KMessageWidget *_inputLagMessageWidget;
+    KMessageWidget *_inputDroppedMessageWidget;
+    SelectionCopyJob *_selectionCopyJob;
 
     // Needed to know whether the mode really changed between update calls
     bool _readOnly;
@@ -1079,6 +1224,36 @@ private:
     ScrollState _scrollWheelState;
     IncrementalSearchBar *_searchBar;
 
+    // performance counters
+    quint64 _paintCount;
+    qint64 _updateImageTime;
+    qint64 _paintTime;
+
+    LatencyProbe *_latencyProbe;
+
+    // pixmaps of the box drawing, block and braille characters
+    // drawn by drawLineCharString()
+    LineGlyphCache *_lineGlyphCache;
+
+    // the text and the cell backgrounds as drawn by drawContents(), which
+    // paintEvent() composites over the display's background.  Scrolling
+    // moves the pixels of this layer instead of drawing the text again.
+    QImage _textLayer;
+    // the parts of _textLayer which have not been drawn since they changed
+    QRegion _textLayerDirty;
+    // the parts of the display which only need to be composited from
+    // _textLayer in the next paint event, because they were scrolled or
+    // uncovered by one of the child widgets
+    QRegion _compositeOnlyRegion;
+
+    // the range of lines changed since the last accessibility events,
+    // empty if the first line is greater than the last one
+    int _accessibleFirstDirtyLine;
+    int _accessibleLastDirtyLine;
+    // the cursor offset last reported to assistive technology
+    int _accessibleCursorPosition;
+    QTimer *_accessibilityTimer;
+
     friend class TerminalDisplayAccessible;
 };
 
@@ -21,12 +21,14 @@
 
 #include "TerminalDisplayAccessible.h"
 #include "SessionController.h"
+#include "ExtendedCharTable.h"
 #include <klocalizedstring.h>
 
 using namespace Konsole;
 
 TerminalDisplayAccessible::TerminalDisplayAccessible(TerminalDisplay *display) :
-    QAccessibleWidget(display, QAccessible::Terminal, display->sessionController()->userTitle())
+    QAccessibleWidget(display, QAccessible::Terminal, display->sessionController()->userTitle()),
+    _columns(0)
 {
 }
 
@@ -92,13 +94,114 @@ int TerminalDisplayAccessible::selectionCount() const
 
 QString TerminalDisplayAccessible::visibleText() const
 {
-    // This function should be const to allow calling it from const interface functions.
-    TerminalDisplay *display = const_cast<TerminalDisplayAccessible *>(this)->display();
-    if (display->screenWindow() == nullptr) {
+    if (display()->screenWindow() == nullptr) {
         return QString();
     }
 
-    return display->screenWindow()->screen()->text(0, display->_usedColumns * display->_usedLines, Screen::PreserveLineBreaks);
+    updateCache();
+
+    QString text;
+    text.reserve(_lines.count() * (_columns + 1));
+    for (int i = 0; i < _lines.count(); i++) {
+        const QString &line = _lines.at(i);
+        int length = line.length();
+        while (length > 0 && line.at(length - 1).isSpace()) {
+            length--;
+        }
+        if (i > 0) {
+            text += QLatin1Char('\n');
+        }
+        text += line.leftRef(length);
+    }
+    return text;
+}
+
+QString TerminalDisplayAccessible::decodeLine(int line) const
+{
+    const TerminalDisplay *display = this->display();
+    QString text(_columns, QLatin1Char(' '));
+    if (display->_image == nullptr) {
+        return text;
+    }
+
+    const Character *cells = &display->_image[line * display->_columns];
+    for (int column = 0; column < _columns; column++) {
+        uint ucs4 = cells[column].character;
+        if ((cells[column].rendition & RE_EXTENDED_CHAR) != 0) {
+            // keep the base character of combined sequences
+            ushort length = 0;
+            const uint *chars = ExtendedCharTable::instance.lookupExtendedChar(ucs4, length);
+            ucs4 = (chars != nullptr && length > 0) ? chars[0] : 0;
+        }
+
+        // the second cell of a double width character is left blank
+        if (ucs4 == 0) {
+            continue;
+        }
+        // characters outside the BMP would take up two offsets
+        text[column] = QChar::requiresSurrogates(ucs4) ? QChar(QChar::ReplacementCharacter) : QChar(ucs4);
+    }
+    return text;
+}
+
+void TerminalDisplayAccessible::updateCache() const
+{
+    const TerminalDisplay *display = this->display();
+    if (_lines.count() == display->_usedLines && _columns == display->_usedColumns) {
+        return;
+    }
+
+    _columns = display->_usedColumns;
+    _lines.resize(display->_usedLines);
+    for (int line = 0; line < _lines.count(); line++) {
+        _lines[line] = decodeLine(line);
+    }
+}
+
+bool TerminalDisplayAccessible::updateLines(int firstLine, int lastLine, int *position, QString *oldText, QString *newText)
+{
+    const TerminalDisplay *display = this->display();
+    if (_lines.count() != display->_usedLines || _columns != display->_usedColumns) {
+        *position = 0;
+        foreach (const QString &line, _lines) {
+            *oldText += line;
+        }
+        updateCache();
+        foreach (const QString &line, _lines) {
+            *newText += line;
+        }
+        return *oldText != *newText;
+    }
+
+    firstLine = qMax(firstLine, 0);
+    lastLine = qMin(lastLine, _lines.count() - 1);
+
+    // only report the lines between the first and the last one which
+    // actually changed
+    int first = -1;
+    int last = -1;
+    QVector<QString> oldLines;
+    oldLines.reserve(lastLine - firstLine + 1);
+    for (int line = firstLine; line <= lastLine; line++) {
+        oldLines.append(_lines.at(line));
+        _lines[line] = decodeLine(line);
+        if (_lines.at(line) != oldLines.last()) {
+            if (first < 0) {
+                first = line;
+            }
+            last = line;
+        }
+    }
+    if (first < 0) {
+        return false;
+    }
+
+    *position = first * _columns;
+    for (int line = first; line <= last; line++) {
+        *oldText += oldLines.at(line - firstLine);
+        *newText += _lines.at(line);
+    }
+    return true;
 }
 
 void TerminalDisplayAccessible::addSelection(int startOffset, int endOffset)
@@ -185,7 +288,23 @@ QString TerminalDisplayAccessible::text(int startOffset, int endOffset) const
         return QString();
     }
 
-    return display()->screenWindow()->screen()->text(startOffset, endOffset, Screen::PreserveLineBreaks);
+    updateCache();
+    if (_columns == 0) {
+        return QString();
+    }
+
+    startOffset = qMax(startOffset, 0);
+    endOffset = qMin(endOffset, _lines.count() * _columns);
+
+    QString text;
+    for (int offset = startOffset; offset < endOffset;) {
+        const int line = offset / _columns;
+        const int column = offset % _columns;
+        const int length = qMin(_columns - column, endOffset - offset);
+        text += _lines.at(line).midRef(column, length);
+        offset += length;
+    }
+    return text;
 }
 
 TerminalDisplay *TerminalDisplayAccessible::display() const
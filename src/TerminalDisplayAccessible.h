@@ -26,6 +26,7 @@
 
 #include <QAccessibleTextInterface>
 #include <QAccessibleWidget>
+#include <QVector>
 
 #include "TerminalDisplay.h"
 #include "ScreenWindow.h"
@@ -37,6 +38,10 @@ namespace Konsole {
  * This exposes information about the display to assistive technology using the QAccessible framework.
  *
  * Most functions are re-implemented from QAccessibleTextInterface.
+ *
+ * The text is served from a copy of the display's lines, decoded with one
+ * character per cell so that offsets are line * columns + column.  The
+ * display tells the interface which lines changed with updateLines().
  */
 class TerminalDisplayAccessible : public QAccessibleWidget, public QAccessibleTextInterface
 {
@@ -64,6 +69,18 @@ public:
 
     void *interface_cast(QAccessible::InterfaceType type) override;
 
+    /**
+     * Decodes lines @p firstLine to @p lastLine of the display's image
+     * into the cached text.  If the size of the display changed, all
+     * lines are decoded again and the range is extended accordingly.
+     *
+     * @param position Set to the offset of the first line which changed
+     * @param oldText Set to the previous text of the changed lines
+     * @param newText Set to the current text of the changed lines
+     * @return False if the text of the lines did not change
+     */
+    bool updateLines(int firstLine, int lastLine, int *position, QString *oldText, QString *newText);
+
 private:
     Konsole::TerminalDisplay *display() const;
 
@@ -83,6 +100,13 @@ private:
     }
 
     QString visibleText() const;
+
+    // decodes all lines if the cache does not match the size of the display
+    void updateCache() const;
+    QString decodeLine(int line) const;
+
+    mutable QVector<QString> _lines;
+    mutable int _columns;
 };
 } // namespace
 
@@ -0,0 +1,142 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "Tracer.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+using namespace Konsole;
+
+namespace {
+// number of events kept; at a few thousand events per second of heavy
+// output this covers the last several seconds
+const int TRACE_BUFFER_SIZE = 1 << 16;
+
+struct TraceEvent {
+    const char *name;
+    qint64 start;
+    qint64 duration;
+    quintptr thread;
+};
+
+struct TraceBuffer {
+    TraceBuffer() :
+        events(TRACE_BUFFER_SIZE),
+        next(0),
+        count(0)
+    {
+        clock.start();
+    }
+
+    QMutex mutex;
+    QElapsedTimer clock;
+    QVector<TraceEvent> events;
+    int next;
+    int count;
+};
+}
+
+Q_GLOBAL_STATIC(TraceBuffer, traceBuffer)
+
+bool Tracer::_enabled = false;
+
+void Tracer::setEnabled(bool enabled)
+{
+#if KONSOLE_ENABLE_TRACING
+    if (enabled) {
+        // create the buffer before any trace point uses it
+        traceBuffer();
+    }
+    _enabled = enabled;
+#else
+    Q_UNUSED(enabled);
+#endif
+}
+
+qint64 Tracer::now()
+{
+    return traceBuffer()->clock.nsecsElapsed();
+}
+
+void Tracer::addEvent(const char *name, qint64 start, qint64 duration)
+{
+    TraceBuffer *buffer = traceBuffer();
+    QMutexLocker locker(&buffer->mutex);
+
+    TraceEvent &event = buffer->events[buffer->next];
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    event.thread = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    buffer->next = (buffer->next + 1) % TRACE_BUFFER_SIZE;
+    buffer->count = qMin(buffer->count + 1, TRACE_BUFFER_SIZE);
+}
+
+bool Tracer::writeChromeTrace(QIODevice *device, int seconds)
+{
+    TraceBuffer *buffer = traceBuffer();
+    QMutexLocker locker(&buffer->mutex);
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    const qint64 since = buffer->clock.nsecsElapsed() - seconds * Q_INT64_C(1000000000);
+
+    QByteArray json("{\"traceEvents\":[\n");
+    bool first = true;
+    const int oldest = (buffer->next - buffer->count + TRACE_BUFFER_SIZE) % TRACE_BUFFER_SIZE;
+    for (int i = 0; i < buffer->count; i++) {
+        const TraceEvent &event = buffer->events.at((oldest + i) % TRACE_BUFFER_SIZE);
+        if (event.start < since) {
+            continue;
+        }
+
+        if (!first) {
+            json.append(",\n");
+        }
+        first = false;
+
+        // timestamps and durations are in microseconds
+        json.append("{\"name\":\"").append(event.name)
+            .append("\",\"cat\":\"konsole\",\"ph\":\"X\",\"ts\":")
+            .append(QByteArray::number(event.start / 1000.0, 'f', 3))
+            .append(",\"dur\":").append(QByteArray::number(event.duration / 1000.0, 'f', 3))
+            .append(",\"pid\":").append(QByteArray::number(pid))
+            .append(",\"tid\":").append(QByteArray::number(static_cast<quint64>(event.thread)))
+            .append('}');
+    }
+    json.append("\n]}\n");
+
+    return device->write(json) == json.size();
+}
+
+void Tracer::clear()
+{
+    TraceBuffer *buffer = traceBuffer();
+    QMutexLocker locker(&buffer->mutex);
+    buffer->next = 0;
+    buffer->count = 0;
+}
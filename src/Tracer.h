@@ -0,0 +1,118 @@
+/*
+    This file is part of Konsole, an X terminal.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+// Qt
+#include <QtGlobal>
+
+// Konsole
+#include "config-konsole.h"
+#include "konsoleemulation_export.h"
+
+class QIODevice;
+
+namespace Konsole {
+/**
+ * Records the duration of trace points in the output pipeline into a
+ * fixed size ring buffer, which can be written out in the Chrome trace
+ * event format (load it in chrome://tracing or https://ui.perfetto.dev).
+ *
+ * Trace points are placed with KONSOLE_TRACE_SCOPE(), which compiles to
+ * nothing unless Konsole is built with KONSOLE_ENABLE_TRACING.  When it
+ * is compiled in, a trace point costs a single test of isEnabled() while
+ * tracing is switched off.
+ */
+class KONSOLEEMULATION_EXPORT Tracer
+{
+public:
+    /** Returns true if trace points are being recorded. */
+    static bool isEnabled()
+    {
+        return _enabled;
+    }
+
+    /**
+     * Starts or stops recording trace points.  This has no effect if
+     * Konsole was built without KONSOLE_ENABLE_TRACING.
+     */
+    static void setEnabled(bool enabled);
+
+    /** Returns a timestamp in nanoseconds for use with addEvent() */
+    static qint64 now();
+
+    /**
+     * Adds a completed event to the ring buffer, overwriting the oldest
+     * event if the buffer is full.
+     *
+     * @param name A string with static storage duration.
+     * @param start The start of the event, as returned by now()
+     * @param duration The duration of the event in nanoseconds
+     */
+    static void addEvent(const char *name, qint64 start, qint64 duration);
+
+    /**
+     * Writes the events recorded in the last @p seconds to @p device as
+     * a Chrome trace JSON document.  Returns false if writing failed.
+     */
+    static bool writeChromeTrace(QIODevice *device, int seconds);
+
+    /** Discards all recorded events. */
+    static void clear();
+
+private:
+    static bool _enabled;
+};
+
+/**
+ * Records the time from its construction to its destruction as a trace
+ * event, if tracing was enabled when it was constructed.
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name) :
+        _name(name),
+        _start(Q_UNLIKELY(Tracer::isEnabled()) ? Tracer::now() : -1)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (Q_UNLIKELY(_start >= 0)) {
+            Tracer::addEvent(_name, _start, Tracer::now() - _start);
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(TraceScope)
+
+    const char *_name;
+    qint64 _start;
+};
+}
+
+#if KONSOLE_ENABLE_TRACING
+#define KONSOLE_TRACE_SCOPE(name) Konsole::TraceScope konsoleTraceScope(name)
+#else
+#define KONSOLE_TRACE_SCOPE(name)
+#endif
+
+#endif // TRACER_H
@@ -25,6 +25,7 @@
 // Qt
 #include <QStringList>
 #include <QAction>
+#include <QTimer>
 
 // KDE
 #include <KAcceleratorManager>
@@ -37,10 +38,12 @@
 
 #include "ColorScheme.h"
 #include "ColorSchemeManager.h"
+#include "Emulation.h"
 #include "Session.h"
 #include "TerminalDisplay.h"
 #include "SessionController.h"
 #include "SessionManager.h"
+#include "SessionPool.h"
 #include "ProfileManager.h"
 #include "ViewSplitter.h"
 #include "Enumeration.h"
@@ -60,7 +63,8 @@ ViewManager::ViewManager(QObject *parent, KActionCollection *collection) :
     _navigationVisibility(NavigationNotSet),
     _newTabBehavior(PutNewTabAtTheEnd),
     _managerId(0),
-    _mtdManager(new MultiTerminalDisplayManager(this, this))
+    _mtdManager(new MultiTerminalDisplayManager(this, this)),
+    _sessionPool(new SessionPool(this))
 {
     // create main view area
     _viewSplitter = new ViewSplitter(nullptr);
@@ -86,8 +90,8 @@ ViewManager::ViewManager(QObject *parent, KActionCollection *collection) :
             &Konsole::ViewManager::empty);
 
     // listen for profile changes
-    connect(ProfileManager::instance(), &Konsole::ProfileManager::profileChanged,
-            this, &Konsole::ViewManager::profileChanged);
+    connect(ProfileManager::instance(), &Konsole::ProfileManager::profilePropertiesChanged,
+            this, &Konsole::ViewManager::profilePropertiesChanged);
     connect(SessionManager::instance(), &Konsole::SessionManager::sessionUpdated,
             this, &Konsole::ViewManager::updateViewsForSession);
 
@@ -990,73 +994,166 @@ bool ViewManager::profileHasBlurEnabled(const Profile::Ptr profile)
 }
 
 void ViewManager::applyProfileToView(TerminalDisplay *view, const Profile::Ptr profile)
+{
+    applyProfileToView(view, profile, ShouldApplyProperty(profile, false));
+}
+
+void ViewManager::applyProfileToView(TerminalDisplay *view, const Profile::Ptr profile,
+                                     const ShouldApplyProperty &apply)
 {
     Q_ASSERT(profile);
 
-    emit updateWindowIcon();
+    if (apply.shouldApply(Profile::Icon)) {
+        emit updateWindowIcon();
+    }
 
     // load color scheme
-    ColorEntry table[TABLE_COLORS];
-    const ColorScheme *colorScheme = colorSchemeForProfile(profile);
-    colorScheme->getColorTable(table, view->randomSeed());
-    view->setColorTable(table);
-    view->setOpacity(colorScheme->opacity());
-    view->setWallpaper(colorScheme->wallpaper());
+    if (apply.shouldApply(Profile::ColorScheme)) {
+        ColorEntry table[TABLE_COLORS];
+        const ColorScheme *colorScheme = colorSchemeForProfile(profile);
+        colorScheme->getColorTable(table, view->randomSeed());
+        view->setColorTable(table);
+        view->setOpacity(colorScheme->opacity());
+        view->setWallpaper(colorScheme->wallpaper());
+
+        emit blurSettingChanged(colorScheme->blur());
+    }
 
-    emit blurSettingChanged(colorScheme->blur());
+    // settings which only change how the text is drawn are applied
+    // with one repaint at the end, instead of re-laying out the display
+    bool redraw = false;
 
     // load font
-    view->setAntialias(profile->antiAliasFonts());
-    view->setBoldIntense(profile->boldIntense());
-    view->setUseFontLineCharacters(profile->useFontLineCharacters());
-    view->setVTFont(profile->font());
+    //
+    // the line spacing is set before the font and only re-lays out the
+    // display if it changes and the font is not set as well, setting the
+    // font always does
+    if (apply.shouldApply(Profile::AntiAliasFonts)) {
+        view->setAntialias(profile->antiAliasFonts());
+    }
+    if (apply.shouldApply(Profile::BoldIntense)) {
+        view->setBoldIntense(profile->boldIntense());
+        redraw = true;
+    }
+    if (apply.shouldApply(Profile::UseFontLineCharacters)) {
+        view->setUseFontLineCharacters(profile->useFontLineCharacters());
+        redraw = true;
+    }
+    // anti-aliasing is a property of the font given to the display
+    const bool applyFont = apply.shouldApply(Profile::Font) || apply.shouldApply(Profile::AntiAliasFonts);
+    if (apply.shouldApply(Profile::LineSpacing)) {
+        view->setLineSpacing(profile->lineSpacing(), !applyFont);
+    }
+    if (applyFont) {
+        view->setVTFont(profile->font());
+    }
 
     // set scroll-bar position
-    view->setScrollBarPosition(Enum::ScrollBarPositionEnum(profile->property<int>(Profile::ScrollBarPosition)));
-    view->setScrollFullPage(profile->property<bool>(Profile::ScrollFullPage));
+    if (apply.shouldApply(Profile::ScrollBarPosition)) {
+        view->setScrollBarPosition(Enum::ScrollBarPositionEnum(profile->property<int>(Profile::ScrollBarPosition)));
+    }
+    if (apply.shouldApply(Profile::ScrollFullPage)) {
+        view->setScrollFullPage(profile->property<bool>(Profile::ScrollFullPage));
+    }
 
     // show hint about terminal size after resizing
-    view->setShowTerminalSizeHint(profile->showTerminalSizeHint());
-    view->setDimWhenInactive(profile->dimWhenInactive());
+    if (apply.shouldApply(Profile::ShowTerminalSizeHint)) {
+        view->setShowTerminalSizeHint(profile->showTerminalSizeHint());
+    }
+    if (apply.shouldApply(Profile::DimWhenInactive)) {
+        view->setDimWhenInactive(profile->dimWhenInactive());
+        redraw = true;
+    }
 
     // terminal features
-    view->setBlinkingCursorEnabled(profile->blinkingCursorEnabled());
-    view->setBlinkingTextEnabled(profile->blinkingTextEnabled());
-    view->setTripleClickMode(Enum::TripleClickModeEnum(profile->property<int>(Profile::TripleClickMode)));
-    view->setAutoCopySelectedText(profile->autoCopySelectedText());
-    view->setControlDrag(profile->property<bool>(Profile::CtrlRequiredForDrag));
-    view->setDropUrlsAsText(profile->property<bool>(Profile::DropUrlsAsText));
-    view->setBidiEnabled(profile->bidiRenderingEnabled());
-    view->setLineSpacing(profile->lineSpacing());
-    view->setTrimLeadingSpaces(profile->property<bool>(Profile::TrimLeadingSpacesInSelectedText));
-    view->setTrimTrailingSpaces(profile->property<bool>(Profile::TrimTrailingSpacesInSelectedText));
-    view->setOpenLinksByDirectClick(profile->property<bool>(Profile::OpenLinksByDirectClickEnabled));
-    view->setUrlHintsModifiers(profile->property<int>(Profile::UrlHintsModifiers));
-    view->setReverseUrlHintsEnabled(profile->property<int>(Profile::ReverseUrlHints));
-    view->setMiddleClickPasteMode(Enum::MiddleClickPasteModeEnum(profile->property<int>(Profile::MiddleClickPasteMode)));
-    view->setCopyTextAsHTML(profile->property<bool>(Profile::CopyTextAsHTML));
+    if (apply.shouldApply(Profile::BlinkingCursorEnabled)) {
+        view->setBlinkingCursorEnabled(profile->blinkingCursorEnabled());
+    }
+    if (apply.shouldApply(Profile::BlinkingTextEnabled)) {
+        view->setBlinkingTextEnabled(profile->blinkingTextEnabled());
+        redraw = true;
+    }
+    if (apply.shouldApply(Profile::TripleClickMode)) {
+        view->setTripleClickMode(Enum::TripleClickModeEnum(profile->property<int>(Profile::TripleClickMode)));
+    }
+    if (apply.shouldApply(Profile::AutoCopySelectedText)) {
+        view->setAutoCopySelectedText(profile->autoCopySelectedText());
+    }
+    if (apply.shouldApply(Profile::CtrlRequiredForDrag)) {
+        view->setControlDrag(profile->property<bool>(Profile::CtrlRequiredForDrag));
+    }
+    if (apply.shouldApply(Profile::DropUrlsAsText)) {
+        view->setDropUrlsAsText(profile->property<bool>(Profile::DropUrlsAsText));
+    }
+    if (apply.shouldApply(Profile::BidiRenderingEnabled)) {
+        view->setBidiEnabled(profile->bidiRenderingEnabled());
+        redraw = true;
+    }
+    if (apply.shouldApply(Profile::TrimLeadingSpacesInSelectedText)) {
+        view->setTrimLeadingSpaces(profile->property<bool>(Profile::TrimLeadingSpacesInSelectedText));
+    }
+    if (apply.shouldApply(Profile::TrimTrailingSpacesInSelectedText)) {
+        view->setTrimTrailingSpaces(profile->property<bool>(Profile::TrimTrailingSpacesInSelectedText));
+    }
+    if (apply.shouldApply(Profile::OpenLinksByDirectClickEnabled)) {
+        view->setOpenLinksByDirectClick(profile->property<bool>(Profile::OpenLinksByDirectClickEnabled));
+    }
+    if (apply.shouldApply(Profile::UrlHintsModifiers)) {
+        view->setUrlHintsModifiers(profile->property<int>(Profile::UrlHintsModifiers));
+    }
+    if (apply.shouldApply(Profile::ReverseUrlHints)) {
+        view->setReverseUrlHintsEnabled(profile->property<int>(Profile::ReverseUrlHints));
+    }
+    if (apply.shouldApply(Profile::MiddleClickPasteMode)) {
+        view->setMiddleClickPasteMode(Enum::MiddleClickPasteModeEnum(profile->property<int>(Profile::MiddleClickPasteMode)));
+    }
+    if (apply.shouldApply(Profile::CopyTextAsHTML)) {
+        view->setCopyTextAsHTML(profile->property<bool>(Profile::CopyTextAsHTML));
+    }
 
     // margin/center
-    view->setMargin(profile->property<int>(Profile::TerminalMargin));
-    view->setCenterContents(profile->property<bool>(Profile::TerminalCenter));
+    if (apply.shouldApply(Profile::TerminalMargin)) {
+        view->setMargin(profile->property<int>(Profile::TerminalMargin));
+    }
+    if (apply.shouldApply(Profile::TerminalCenter)) {
+        view->setCenterContents(profile->property<bool>(Profile::TerminalCenter));
+    }
 
     // cursor shape
-    view->setKeyboardCursorShape(Enum::CursorShapeEnum(profile->property<int>(Profile::CursorShape)));
+    if (apply.shouldApply(Profile::CursorShape)) {
+        view->setKeyboardCursorShape(Enum::CursorShapeEnum(profile->property<int>(Profile::CursorShape)));
+        redraw = true;
+    }
 
     // cursor color
     // an invalid QColor is used to inform the view widget to
     // draw the cursor using the default color( matching the text)
-    view->setKeyboardCursorColor(profile->useCustomCursorColor() ? profile->customCursorColor() : QColor());
+    if (apply.shouldApply(Profile::UseCustomCursorColor) || apply.shouldApply(Profile::CustomCursorColor)) {
+        view->setKeyboardCursorColor(profile->useCustomCursorColor() ? profile->customCursorColor() : QColor());
+        redraw = true;
+    }
 
     // word characters
-    view->setWordCharacters(profile->wordCharacters());
+    if (apply.shouldApply(Profile::WordCharacters)) {
+        view->setWordCharacters(profile->wordCharacters());
+    }
 
     // bell mode
-    view->setBellMode(profile->property<int>(Profile::BellMode));
+    if (apply.shouldApply(Profile::BellMode)) {
+        view->setBellMode(profile->property<int>(Profile::BellMode));
+    }
 
     // mouse wheel zoom
-    view->setMouseWheelZoom(profile->mouseWheelZoomEnabled());
-    view->setAlternateScrolling(profile->property<bool>(Profile::AlternateScrolling));
+    if (apply.shouldApply(Profile::MouseWheelZoomEnabled)) {
+        view->setMouseWheelZoom(profile->mouseWheelZoomEnabled());
+    }
+    if (apply.shouldApply(Profile::AlternateScrolling)) {
+        view->setAlternateScrolling(profile->property<bool>(Profile::AlternateScrolling));
+    }
+
+    if (redraw) {
+        view->redraw();
+    }
 }
 
 void ViewManager::updateViewsForSession(Session *session)
@@ -1069,9 +1166,15 @@ void ViewManager::updateViewsForSession(Session *session)
     }
 }
 
-void ViewManager::profileChanged(Profile::Ptr profile)
+void ViewManager::profilePropertiesChanged(Profile::Ptr profile,
+                                           const QSet<Profile::Property> &properties)
 {
-    // update all views associated with this profile
+    // the changes are applied to the views once control returns to the
+    // event loop, so that a view which is changed several times in a row,
+    // as when the profiles of a group are changed, is re-laid out once,
+    // and all views are painted in the same pass
+    const bool scheduled = !_pendingProfileChanges.isEmpty();
+
     QHashIterator<TerminalDisplay *, Session *> iter(_sessionMap);
     while (iter.hasNext()) {
         iter.next();
@@ -1080,9 +1183,30 @@ void ViewManager::profileChanged(Profile::Ptr profile)
         if (iter.key() != nullptr
             && iter.value() != nullptr
             && SessionManager::instance()->sessionProfile(iter.value()) == profile) {
-            applyProfileToView(iter.key(), profile);
+            _pendingProfileChanges[iter.key()].unite(properties);
+        }
+    }
+
+    if (!scheduled && !_pendingProfileChanges.isEmpty()) {
+        QTimer::singleShot(0, this, &Konsole::ViewManager::applyPendingProfileChanges);
+    }
+}
+
+void ViewManager::applyPendingProfileChanges()
+{
+    QHashIterator<TerminalDisplay *, QSet<Profile::Property> > iter(_pendingProfileChanges);
+    while (iter.hasNext()) {
+        iter.next();
+
+        // skip views which have been closed in the meantime
+        Session *session = _sessionMap.value(iter.key());
+        if (session != nullptr) {
+            applyProfileToView(iter.key(), SessionManager::instance()->sessionProfile(session),
+                               ShouldApplyProperty(iter.value()));
         }
     }
+
+    _pendingProfileChanges.clear();
 }
 
 QList<ViewProperties *> ViewManager::viewProperties() const
@@ -1160,6 +1284,7 @@ void ViewManager::restoreSessions(const KConfigGroup &group)
     QList<int> ids = group.readEntry("Sessions", QList<int>());
     int activeTab = group.readEntry("Active", 0);
     TerminalDisplay *display = nullptr;
+    QList<Session *> sessions;
 
     int tab = 1;
     foreach (int id, ids) {
@@ -1173,9 +1298,7 @@ void ViewManager::restoreSessions(const KConfigGroup &group)
         }
 
         createView(session);
-        if (!session->isRunning()) {
-            session->run();
-        }
+        sessions << session;
         if (tab++ == activeTab) {
             display = qobject_cast<TerminalDisplay *>(activeView());
         }
@@ -1190,10 +1313,48 @@ void ViewManager::restoreSessions(const KConfigGroup &group)
         Profile::Ptr profile = ProfileManager::instance()->defaultProfile();
         Session *session = SessionManager::instance()->createSession(profile);
         createView(session);
+        sessions << session;
+    }
+
+    // all tabs exist now, start their programs together
+    startSessionsLater(sessions);
+}
+
+void ViewManager::startSessionsLater(const QList<Session *> &sessions)
+{
+    if (_sessionsToStart.isEmpty()) {
+        QTimer::singleShot(0, this, &Konsole::ViewManager::startPendingSessions);
+    }
+    foreach (Session *session, sessions) {
+        _sessionsToStart << session;
+    }
+}
+
+SessionPool *ViewManager::sessionPool() const
+{
+    return _sessionPool;
+}
+
+void ViewManager::startPendingSessions()
+{
+    const auto activeDisplay = qobject_cast<TerminalDisplay *>(activeView());
+    const bool haveActiveSize = activeDisplay != nullptr
+                                && activeDisplay->lines() > 1 && activeDisplay->columns() > 1;
+
+    foreach (const QPointer<Session> &session, _sessionsToStart) {
+        if (session.isNull() || session->isRunning()) {
+            continue;
+        }
+
+        // giving the emulation its first size runs the session
+        if (haveActiveSize) {
+            session->emulation()->setImageSize(activeDisplay->lines(), activeDisplay->columns());
+        }
         if (!session->isRunning()) {
             session->run();
         }
     }
+    _sessionsToStart.clear();
 }
 
 int ViewManager::sessionCount()
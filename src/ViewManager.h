@@ -24,6 +24,7 @@
 #include <QHash>
 #include <QObject>
 #include <QPointer>
+#include <QSet>
 
 // Konsole
 #include "Profile.h"
@@ -38,6 +39,8 @@ class Session;
 class TerminalDisplay;
 class TabbedViewContainer;
 class SessionController;
+class SessionPool;
+class ShouldApplyProperty;
 class ViewProperties;
 class ViewSplitter;
 
@@ -187,6 +190,20 @@ public:
     void saveSessions(KConfigGroup &group);
     void restoreSessions(const KConfigGroup &group);
 
+    /**
+     * Starts the programs of @p sessions, whose views have already been
+     * created with createView(), once control returns to the event loop.
+     *
+     * By then the window has been shown and the active view has its size.
+     * The views in background tabs are only laid out when they are first
+     * shown, so their sessions are started with the size of the active
+     * view.  None of the sessions waits for the others' programs to start.
+     */
+    void startSessionsLater(const QList<Session *> &sessions);
+
+    /** Returns the pool of idle sessions which new tabs can adopt */
+    SessionPool *sessionPool() const;
+
     void setNavigationBehavior(int behavior);
     int managerId() const;
 
@@ -381,8 +398,10 @@ private Q_SLOTS:
     // changes
     void containerViewsChanged(TabbedViewContainer *container);
 
-    // called when a profile changes
-    void profileChanged(Profile::Ptr profile);
+    // called when properties of a profile change
+    void profilePropertiesChanged(Profile::Ptr profile, const QSet<Profile::Property> &properties);
+    // applies the profile changes collected by profilePropertiesChanged()
+    void applyPendingProfileChanges();
 
     void updateViewsForSession(Session *session);
 
@@ -406,6 +425,9 @@ private Q_SLOTS:
 
     QList<TerminalDisplay *> getTerminalsFromContainer(TabbedViewContainer *container) const;
 
+    // starts the sessions queued by startSessionsLater()
+    void startPendingSessions();
+
 private:
     Q_DISABLE_COPY(ViewManager)
 
@@ -416,6 +438,10 @@ private:
 
     static const ColorScheme *colorSchemeForProfile(const Profile::Ptr profile);
 
+    // applies the settings of @p profile for which @p apply returns true
+    void applyProfileToView(TerminalDisplay *view, const Profile::Ptr profile,
+                            const ShouldApplyProperty &apply);
+
     void setupActions();
 
     // takes a view from a view container owned by a different manager and places it in
@@ -444,6 +470,9 @@ private:
     QPointer<SessionController> _pluggedController;
 
     QHash<TerminalDisplay *, Session *> _sessionMap;
+    // the changed profile properties waiting to be applied to each view
+    QHash<TerminalDisplay *, QSet<Profile::Property> > _pendingProfileChanges;
+    QList<QPointer<Session> > _sessionsToStart;
 
     KActionCollection *_actionCollection;
 
@@ -454,6 +483,7 @@ private:
     static int lastManagerId;
 
     MultiTerminalDisplayManager* _mtdManager;
+    SessionPool *_sessionPool;
 };
 }
 
@@ -37,11 +37,13 @@
 
 // Konsole
 #include "KeyboardTranslator.h"
-#include "SessionController.h"
-#include "TerminalDisplay.h"
 
 using Konsole::Vt102Emulation;
 
+// mouse motion is reported at most once per this many milliseconds,
+// which is about once per frame
+static const int MOUSE_MOTION_INTERVAL = 16;
+
 /*
    The VT100 has 32 special graphical characters. The usual vt100 extended
    xterm fonts have these at 0x00..0x1f.
@@ -70,12 +72,25 @@ Vt102Emulation::Vt102Emulation() :
     _savedModes(TerminalState()),
     _pendingSessionAttributesUpdates(QHash<int, QString>()),
     _sessionAttributesUpdateTimer(new QTimer(this)),
-    _reportFocusEvents(false)
+    _reportFocusEvents(false),
+    _mouseMotionTimer(new QTimer(this)),
+    _mouseMotionPending(false),
+    _pendingMotionButton(0),
+    _pendingMotionColumn(0),
+    _pendingMotionLine(0),
+    _lastMotionButton(-1),
+    _lastMotionColumn(0),
+    _lastMotionLine(0)
 {
     _sessionAttributesUpdateTimer->setSingleShot(true);
     QObject::connect(_sessionAttributesUpdateTimer, &QTimer::timeout, this,
                      &Konsole::Vt102Emulation::updateSessionAttributes);
 
+    _mouseMotionTimer->setSingleShot(true);
+    _mouseMotionTimer->setInterval(MOUSE_MOTION_INTERVAL);
+    QObject::connect(_mouseMotionTimer, &QTimer::timeout, this,
+                     &Konsole::Vt102Emulation::sendPendingMouseMotion);
+
     initTokenizer();
     reset();
 }
@@ -1037,6 +1052,61 @@ void Vt102Emulation::sendMouseEvent(int cb, int cx, int cy, int eventType)
         return;
     }
 
+    if (eventType == 1) {
+        // A mouse polled at a high rate moves many times per frame and
+        // mostly within the same cell.  Only motion to another cell is
+        // reported, and at most once per frame, with the latest position.
+        const bool pending = _mouseMotionPending;
+        if (cb == (pending ? _pendingMotionButton : _lastMotionButton)
+                && cx == (pending ? _pendingMotionColumn : _lastMotionColumn)
+                && cy == (pending ? _pendingMotionLine : _lastMotionLine)) {
+            _suppressedMouseEvents++;
+            return;
+        }
+
+        if (pending) {
+            _suppressedMouseEvents++;
+        }
+        _mouseMotionPending = true;
+        _pendingMotionButton = cb;
+        _pendingMotionColumn = cx;
+        _pendingMotionLine = cy;
+        if (!_mouseMotionTimer->isActive()) {
+            sendPendingMouseMotion();
+        }
+        return;
+    }
+
+    // presses and releases are reported right away, after the motion
+    // which led to them
+    if (_mouseMotionPending) {
+        sendPendingMouseMotion();
+    }
+    _mouseMotionTimer->stop();
+    _lastMotionButton = cb;
+    _lastMotionColumn = cx;
+    _lastMotionLine = cy;
+
+    reportMouseEvent(cb, cx, cy, eventType);
+}
+
+void Vt102Emulation::sendPendingMouseMotion()
+{
+    if (!_mouseMotionPending) {
+        return;
+    }
+
+    _mouseMotionPending = false;
+    _lastMotionButton = _pendingMotionButton;
+    _lastMotionColumn = _pendingMotionColumn;
+    _lastMotionLine = _pendingMotionLine;
+    _mouseMotionTimer->start();
+
+    reportMouseEvent(_pendingMotionButton, _pendingMotionColumn, _pendingMotionLine, 1);
+}
+
+void Vt102Emulation::reportMouseEvent(int cb, int cx, int cy, int eventType)
+{
     // With the exception of the 1006 mode, button release is encoded in cb.
     // Note that if multiple extensions are enabled, the 1006 is used, so it's okay to check for only that.
     if (eventType == 2 && !getMode(MODE_Mouse1006)) {
@@ -1124,11 +1194,7 @@ void Vt102Emulation::sendKeyEvent(QKeyEvent *event)
     const Qt::KeyboardModifiers modifiers = event->modifiers();
     KeyboardTranslator::States states = KeyboardTranslator::NoState;
 
-    TerminalDisplay * currentView = _currentScreen->currentTerminalDisplay();
-    bool isReadOnly = false;
-    if (currentView != nullptr && currentView->sessionController() != nullptr) {
-        isReadOnly = currentView->sessionController()->isReadOnly();
-    }
+    const bool readOnly = isReadOnly();
 
     // get current states
     if (getMode(MODE_NewLine)) {
@@ -1147,7 +1213,7 @@ void Vt102Emulation::sendKeyEvent(QKeyEvent *event)
         states |= KeyboardTranslator::ApplicationKeypadState;
     }
 
-    if (!isReadOnly) {
+    if (!readOnly) {
         // check flow control state
         if ((modifiers &Qt::ControlModifier) != 0u) {
             switch (event->key()) {
@@ -1219,11 +1285,11 @@ void Vt102Emulation::sendKeyEvent(QKeyEvent *event)
             textToSend += _codec->fromUnicode(event->text());
         }
 
-        if (!isReadOnly) {
+        if (!readOnly) {
             emit sendData(textToSend);
         }
     } else {
-        if (!isReadOnly) {
+        if (!readOnly) {
             // print an error message to the terminal if no key translator has been
             // set
             QString translatorError =  i18n("No keyboard translator available.  "
@@ -1438,6 +1504,8 @@ void Vt102Emulation::resetMode(int m)
     case MODE_Mouse1001:
     case MODE_Mouse1002:
     case MODE_Mouse1003:
+        // the program no longer expects the motion held back
+        _mouseMotionPending = false;
         emit programRequestsMouseTracking(false);
         break;
     case MODE_Mouse1007:
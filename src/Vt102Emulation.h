@@ -73,7 +73,7 @@ struct CharCodes {
  * sequences.
  *
  */
-class Vt102Emulation : public Emulation
+class KONSOLEEMULATION_EXPORT Vt102Emulation : public Emulation
 {
     Q_OBJECT
 
@@ -108,6 +108,9 @@ private Q_SLOTS:
     // Used to buffer multiple attribute updates in the current session
     void updateSessionAttributes();
 
+    // Reports the mouse motion held back by sendMouseEvent(), if any
+    void sendPendingMouseMotion();
+
 private:
     unsigned int applyCharset(uint c);
     void setCharset(int n, int cs);
@@ -159,6 +162,7 @@ private:
     void reportAnswerBack();
     void reportCursorPosition();
     void reportTerminalParms(int p);
+    void reportMouseEvent(int cb, int cx, int cy, int eventType);
 
     // clears the screen and resizes it to the specified
     // number of columns
@@ -189,6 +193,19 @@ private:
     QTimer *_sessionAttributesUpdateTimer;
 
     bool _reportFocusEvents;
+
+    // Mouse motion is reported at most once per frame, see sendMouseEvent().
+    // The timer runs for a frame after each reported motion, and a motion
+    // arriving meanwhile waits for it in _pendingMotion*.
+    QTimer *_mouseMotionTimer;
+    bool _mouseMotionPending;
+    int _pendingMotionButton;
+    int _pendingMotionColumn;
+    int _pendingMotionLine;
+    // the last motion reported, to skip motion within the same cell
+    int _lastMotionButton;
+    int _lastMotionColumn;
+    int _lastMotionLine;
 };
 }
 
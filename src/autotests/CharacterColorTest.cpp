@@ -209,4 +209,38 @@ void CharacterColorTest::testColor256()
     QCOMPARE(result, expected);
 }
 
+void CharacterColorTest::testPalette_data()
+{
+    QTest::addColumn<int>("colorSpace");
+    QTest::addColumn<int>("colorValue");
+    QTest::addColumn<bool>("intensive");
+
+    QTest::newRow("default 0") << COLOR_SPACE_DEFAULT << 0 << false;
+    QTest::newRow("default 1 intensive") << COLOR_SPACE_DEFAULT << 1 << true;
+    QTest::newRow("system 3") << COLOR_SPACE_SYSTEM << 3 << false;
+    QTest::newRow("system 7 intensive") << COLOR_SPACE_SYSTEM << 7 << true;
+    for (const int i : {0, 15, 16, 100, 231, 232, 255}) {
+        const QString name = QString::fromLatin1("color256 color %1").arg(i);
+        QTest::newRow(qPrintable(name)) << COLOR_SPACE_256 << i << false;
+    }
+    QTest::newRow("rgb") << COLOR_SPACE_RGB << 0x12ab34 << false;
+}
+
+void CharacterColorTest::testPalette()
+{
+    QFETCH(int, colorSpace);
+    QFETCH(int, colorValue);
+    QFETCH(bool, intensive);
+
+    QRgb palette[PALETTE_COLORS];
+    fillPalette(DefaultColorTable, palette);
+
+    CharacterColor charColor(colorSpace, colorValue);
+    if (intensive) {
+        charColor.setIntensive();
+    }
+
+    QCOMPARE(charColor.rgb(palette), charColor.color(DefaultColorTable).rgba());
+}
+
 QTEST_GUILESS_MAIN(CharacterColorTest)
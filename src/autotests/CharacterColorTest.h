@@ -46,6 +46,8 @@ private Q_SLOTS:
     void testColorSpaceRGB();
     void testColor256_data();
     void testColor256();
+    void testPalette_data();
+    void testPalette();
 
 private:
     static const ColorEntry DefaultColorTable[];
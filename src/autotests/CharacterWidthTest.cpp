@@ -24,7 +24,7 @@
 #include <qtest.h>
 
 #include "../Character.h"
-#include "konsoleprivate_export.h"
+#include "konsoleemulation_export.h"
 
 using namespace Konsole;
 
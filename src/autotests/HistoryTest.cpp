@@ -23,8 +23,7 @@
 #include "qtest.h"
 
 // Konsole
-#include "../Session.h"
-#include "../Emulation.h"
+#include "../Vt102Emulation.h"
 #include "../History.h"
 
 using namespace Konsole;
@@ -64,8 +63,7 @@ void HistoryTest::testCompactHistory()
 
 void HistoryTest::testEmulationHistory()
 {
-    auto session = new Session();
-    Emulation *emulation = session->emulation();
+    auto emulation = new Vt102Emulation();
 
     const HistoryType &historyTypeDefault = emulation->history();
     QCOMPARE(historyTypeDefault.isEnabled(), false);
@@ -90,7 +88,7 @@ void HistoryTest::testEmulationHistory()
     QCOMPARE(compactHistoryType.isUnlimited(), false);
     QCOMPARE(compactHistoryType.maximumLineCount(), 42);
 
-    delete session;
+    delete emulation;
 }
 
 void HistoryTest::testHistoryScroll()
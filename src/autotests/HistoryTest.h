@@ -20,7 +20,7 @@
 #ifndef HISTORYTEST_H
 #define HISTORYTEST_H
 
-#include <kde_terminal_interface.h>
+#include <QObject>
 
 namespace Konsole
 {
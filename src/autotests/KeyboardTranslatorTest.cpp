@@ -96,5 +96,58 @@ void KeyboardTranslatorTest::testEntryTextWildcards()
     QCOMPARE(entry.text(wildcards, modifiers), result);
 }
 
+void KeyboardTranslatorTest::testFindEntry()
+{
+    KeyboardTranslator translator(QStringLiteral("test"));
+
+    KeyboardTranslator::Entry up;
+    up.setKeyCode(Qt::Key_Up);
+    up.setModifierMask(Qt::ShiftModifier);
+    up.setStateMask(KeyboardTranslator::AnsiState);
+    up.setState(KeyboardTranslator::AnsiState);
+    up.setText("\\E[A");
+    translator.addEntry(up);
+
+    KeyboardTranslator::Entry shiftUp = up;
+    shiftUp.setModifiers(Qt::ShiftModifier);
+    shiftUp.setText("\\E[1;2A");
+    translator.addEntry(shiftUp);
+
+    KeyboardTranslator::Entry anyModifierUp;
+    anyModifierUp.setKeyCode(Qt::Key_Up);
+    anyModifierUp.setModifierMask(Qt::ShiftModifier);
+    anyModifierUp.setStateMask(KeyboardTranslator::AnsiState | KeyboardTranslator::AnyModifierState);
+    anyModifierUp.setState(KeyboardTranslator::AnsiState | KeyboardTranslator::AnyModifierState);
+    anyModifierUp.setText("\\E[1;*A");
+    translator.addEntry(anyModifierUp);
+
+    // a key beyond the keys which are looked up directly
+    KeyboardTranslator::Entry hangul;
+    hangul.setKeyCode(Qt::Key_Hangul);
+    hangul.setText("hangul");
+    translator.addEntry(hangul);
+
+    QCOMPARE(translator.findEntry(Qt::Key_Up, Qt::NoModifier, KeyboardTranslator::AnsiState).text(),
+             QByteArray("\033[A"));
+    QCOMPARE(translator.findEntry(Qt::Key_Up, Qt::ShiftModifier, KeyboardTranslator::AnsiState).text(),
+             QByteArray("\033[1;2A"));
+    QCOMPARE(translator.findEntry(Qt::Key_Up, Qt::ControlModifier, KeyboardTranslator::AnsiState).text(),
+             QByteArray("\033[1;*A"));
+    QVERIFY(translator.findEntry(Qt::Key_Up, Qt::NoModifier, KeyboardTranslator::NoState).isNull());
+    QVERIFY(translator.findEntry(Qt::Key_Down, Qt::NoModifier, KeyboardTranslator::AnsiState).isNull());
+    QCOMPARE(translator.findEntry(Qt::Key_Hangul, Qt::NoModifier).text(), QByteArray("hangul"));
+    QVERIFY(translator.findEntry(Qt::Key_Hangul_Start, Qt::NoModifier).isNull());
+
+    // changes of the entries are found
+    KeyboardTranslator::Entry newShiftUp = shiftUp;
+    newShiftUp.setText("shift up");
+    translator.replaceEntry(shiftUp, newShiftUp);
+    QCOMPARE(translator.findEntry(Qt::Key_Up, Qt::ShiftModifier, KeyboardTranslator::AnsiState).text(),
+             QByteArray("shift up"));
+
+    translator.removeEntry(hangul);
+    QVERIFY(translator.findEntry(Qt::Key_Hangul, Qt::NoModifier).isNull());
+}
+
 QTEST_GUILESS_MAIN(KeyboardTranslatorTest)
 
@@ -33,6 +33,7 @@ class KeyboardTranslatorTest : public QObject
 private Q_SLOTS:
     void testEntryTextWildcards();
     void testEntryTextWildcards_data();
+    void testFindEntry();
 };
 
 }
@@ -0,0 +1,80 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "LatencyProbeTest.h"
+
+#include "qtest.h"
+
+// Konsole
+#include "../LatencyProbe.h"
+
+using namespace Konsole;
+
+void LatencyProbeTest::testMatching()
+{
+    LatencyProbe probe;
+
+    // a paint without a preceding key press is not a sample
+    probe.contentChanged(100);
+    QVERIFY(!probe.painted(200));
+
+    // a paint before the echo arrived does not end the measurement
+    probe.keyPressed(1000);
+    QVERIFY(!probe.painted(1500));
+    probe.contentChanged(3000);
+    QVERIFY(probe.painted(4000));
+    QCOMPARE(probe.samples(), QVector<qint64>() << 3000);
+
+    // both keys are answered by the same repaint
+    probe.keyPressed(5000);
+    probe.keyPressed(6000);
+    probe.contentChanged(7000);
+    QVERIFY(probe.painted(8000));
+    QCOMPARE(probe.samples(), QVector<qint64>() << 3000 << 3000 << 2000);
+
+    probe.reset();
+    QVERIFY(probe.samples().isEmpty());
+}
+
+void LatencyProbeTest::testUnansweredKeys()
+{
+    LatencyProbe probe;
+
+    // the echo for the first key never came
+    probe.keyPressed(0);
+    probe.keyPressed(Q_INT64_C(2000000000));
+    probe.contentChanged(Q_INT64_C(2000001000));
+    QVERIFY(probe.painted(Q_INT64_C(2000002000)));
+    QCOMPARE(probe.samples(), QVector<qint64>() << 2000);
+}
+
+void LatencyProbeTest::testPercentile()
+{
+    QCOMPARE(LatencyProbe::percentile(QVector<qint64>(), 50), qint64(0));
+
+    QVector<qint64> samples;
+    for (int i = 100; i > 0; i--) {
+        samples << i;
+    }
+    QCOMPARE(LatencyProbe::percentile(samples, 50), qint64(50));
+    QCOMPARE(LatencyProbe::percentile(samples, 99), qint64(99));
+    QCOMPARE(LatencyProbe::percentile(samples, 100), qint64(100));
+    QCOMPARE(LatencyProbe::percentile(samples, 0), qint64(1));
+}
+
+QTEST_GUILESS_MAIN(LatencyProbeTest)
@@ -0,0 +1,148 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "LineGlyphCacheTest.h"
+
+#include "qtest.h"
+
+// Qt
+#include <QImage>
+#include <QPainter>
+
+// Konsole
+#include "../LineGlyphCache.h"
+
+using namespace Konsole;
+
+namespace {
+const QSize CELL_SIZE(10, 20);
+const int SCREEN_COLUMNS = 200;
+const int SCREEN_LINES = 60;
+}
+
+void LineGlyphCacheTest::testCanDraw()
+{
+    QVERIFY(LineGlyphCache::canDraw(0x2500)); // BOX DRAWINGS LIGHT HORIZONTAL
+    QVERIFY(LineGlyphCache::canDraw(0x256D)); // BOX DRAWINGS LIGHT ARC DOWN AND RIGHT
+    QVERIFY(LineGlyphCache::canDraw(0x2588)); // FULL BLOCK
+    QVERIFY(LineGlyphCache::canDraw(0x259F)); // QUADRANT UPPER RIGHT AND LOWER LEFT AND LOWER RIGHT
+    QVERIFY(LineGlyphCache::canDraw(0x28FF)); // BRAILLE PATTERN DOTS-12345678
+
+    QVERIFY(!LineGlyphCache::canDraw('a'));
+    QVERIFY(!LineGlyphCache::canDraw(0x2504)); // triple and quadruple dashes use the font
+    QVERIFY(!LineGlyphCache::canDraw(0x25A0)); // BLACK SQUARE
+    QVERIFY(!LineGlyphCache::canDraw(0x2900));
+}
+
+void LineGlyphCacheTest::testCaching()
+{
+    LineGlyphCache cache;
+    const QRgb red = qRgb(255, 0, 0);
+    const QRgb blue = qRgb(0, 0, 255);
+
+    const QPixmap first = cache.glyph(0x2500, CELL_SIZE, 1.0, red, false);
+    QCOMPARE(first.size(), CELL_SIZE);
+    QCOMPARE(cache.size(), 1);
+
+    // the same glyph is not drawn again
+    QCOMPARE(cache.glyph(0x2500, CELL_SIZE, 1.0, red, false).cacheKey(), first.cacheKey());
+    QCOMPARE(cache.size(), 1);
+
+    // colors and bold lines are separate glyphs, bold blocks are not
+    cache.glyph(0x2500, CELL_SIZE, 1.0, blue, false);
+    cache.glyph(0x2500, CELL_SIZE, 1.0, red, true);
+    QCOMPARE(cache.size(), 3);
+    cache.glyph(0x2588, CELL_SIZE, 1.0, red, false);
+    cache.glyph(0x2588, CELL_SIZE, 1.0, red, true);
+    QCOMPARE(cache.size(), 4);
+
+    // a new cell size or device pixel ratio drops the cached glyphs
+    const QPixmap scaled = cache.glyph(0x2500, CELL_SIZE, 2.0, red, false);
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(scaled.size(), CELL_SIZE * 2);
+    cache.glyph(0x2500, CELL_SIZE + QSize(1, 1), 2.0, red, false);
+    QCOMPARE(cache.size(), 1);
+
+    cache.clear();
+    QCOMPARE(cache.size(), 0);
+}
+
+void LineGlyphCacheTest::testBlockElements()
+{
+    LineGlyphCache cache;
+    const QRgb green = qRgb(0, 255, 0);
+
+    // FULL BLOCK covers the cell
+    QImage full = cache.glyph(0x2588, CELL_SIZE, 1.0, green, false).toImage();
+    QCOMPARE(full.pixel(0, 0), green);
+    QCOMPARE(full.pixel(CELL_SIZE.width() - 1, CELL_SIZE.height() - 1), green);
+
+    // UPPER HALF BLOCK covers the top of the cell only
+    QImage upper = cache.glyph(0x2580, CELL_SIZE, 1.0, green, false).toImage();
+    QCOMPARE(upper.pixel(0, 0), green);
+    QCOMPARE(qAlpha(upper.pixel(0, CELL_SIZE.height() - 1)), 0);
+
+    // QUADRANT LOWER RIGHT
+    QImage quadrant = cache.glyph(0x2597, CELL_SIZE, 1.0, green, false).toImage();
+    QCOMPARE(qAlpha(quadrant.pixel(0, 0)), 0);
+    QCOMPARE(qAlpha(quadrant.pixel(0, CELL_SIZE.height() - 1)), 0);
+    QCOMPARE(quadrant.pixel(CELL_SIZE.width() - 1, CELL_SIZE.height() - 1), green);
+}
+
+void LineGlyphCacheTest::benchmarkBoxScreen_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("direct") << false;
+    QTest::newRow("cached") << true;
+}
+
+void LineGlyphCacheTest::benchmarkBoxScreen()
+{
+    QFETCH(bool, cached);
+
+    // a screen of frames, shades and graphs in a few colors
+    const uint codePoints[] = { 0x2500, 0x2502, 0x250C, 0x2510, 0x2514, 0x2518, 0x253C,
+                                0x2550, 0x2551, 0x256D, 0x2588, 0x2592, 0x2584, 0x28FF };
+    const int codePointCount = sizeof(codePoints) / sizeof(codePoints[0]);
+    const QRgb colors[] = { qRgb(0xb2, 0x18, 0x18), qRgb(0x18, 0xb2, 0x18), qRgb(0xff, 0xff, 0xff) };
+
+    QImage screen(CELL_SIZE.width() * SCREEN_COLUMNS, CELL_SIZE.height() * SCREEN_LINES,
+                  QImage::Format_ARGB32_Premultiplied);
+    screen.fill(Qt::black);
+    LineGlyphCache cache;
+
+    QBENCHMARK {
+        QPainter painter(&screen);
+        for (int line = 0; line < SCREEN_LINES; line++) {
+            for (int column = 0; column < SCREEN_COLUMNS; column++) {
+                const uint codePoint = codePoints[(line + column) % codePointCount];
+                const QRgb color = colors[line % 3];
+                const QPoint position(column * CELL_SIZE.width(), line * CELL_SIZE.height());
+                if (cached) {
+                    painter.drawPixmap(position, cache.glyph(codePoint, CELL_SIZE, 1.0, color, false));
+                } else {
+                    painter.setPen(QColor::fromRgba(color));
+                    LineGlyphCache::drawGlyph(painter, QRect(position, CELL_SIZE), codePoint, false);
+                }
+            }
+        }
+    }
+}
+
+QTEST_MAIN(LineGlyphCacheTest)
@@ -0,0 +1,104 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "PasteJobTest.h"
+
+// Qt
+#include <QSignalSpy>
+#include <QTextCodec>
+
+#include "qtest.h"
+
+// Konsole
+#include "../PasteJob.h"
+#include "../Pty.h"
+#include "../Vt102Emulation.h"
+
+using namespace Konsole;
+
+static QByteArray sentData(const QSignalSpy &spy)
+{
+    QByteArray data;
+    for (int i = 0; i < spy.count(); i++) {
+        data += spy.at(i).at(0).toByteArray();
+    }
+    return data;
+}
+
+void PasteJobTest::testBracketedPaste()
+{
+    Vt102Emulation emulation;
+    emulation.setCodec(QTextCodec::codecForName("UTF-8"));
+    Pty pty;
+
+    QSignalSpy dataSpy(&emulation, SIGNAL(sendData(QByteArray)));
+    auto job = new PasteJob(&emulation, &pty, QStringLiteral("ls -l\r"), true);
+    QSignalSpy finishedSpy(job, SIGNAL(finished(bool)));
+
+    // the pty is not running, so nothing waits to be written
+    job->start();
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.at(0).at(0).toBool(), false);
+    QCOMPARE(sentData(dataSpy), QByteArrayLiteral("\033[200~ls -l\r\033[201~"));
+}
+
+void PasteJobTest::testSurrogatePairs()
+{
+    Vt102Emulation emulation;
+    emulation.setCodec(QTextCodec::codecForName("UTF-8"));
+    Pty pty;
+
+    // place a surrogate pair across every chunk boundary
+    QString text;
+    for (int i = 0; i < 100000; i++) {
+        text += (i % 2 == 0) ? QStringLiteral("a") : QString::fromUtf8("\xF0\x9F\x98\x80");
+    }
+
+    QSignalSpy dataSpy(&emulation, SIGNAL(sendData(QByteArray)));
+    auto job = new PasteJob(&emulation, &pty, text, false);
+    job->start();
+
+    QVERIFY(dataSpy.count() > 1);
+    QCOMPARE(sentData(dataSpy), text.toUtf8());
+}
+
+void PasteJobTest::testCancel()
+{
+    Vt102Emulation emulation;
+    emulation.setCodec(QTextCodec::codecForName("UTF-8"));
+    Pty pty;
+
+    QSignalSpy dataSpy(&emulation, SIGNAL(sendData(QByteArray)));
+    auto job = new PasteJob(&emulation, &pty, QStringLiteral("text"), true);
+    QSignalSpy finishedSpy(job, SIGNAL(finished(bool)));
+
+    // canceling a job which has not been started does nothing
+    job->cancel();
+    QCOMPARE(finishedSpy.count(), 0);
+    QVERIFY(!job->isRunning());
+
+    job->start();
+    QVERIFY(!job->isRunning());
+    job->cancel();
+    QCOMPARE(finishedSpy.count(), 1);
+
+    // the end of paste sequence was sent exactly once
+    QCOMPARE(sentData(dataSpy), QByteArrayLiteral("\033[200~text\033[201~"));
+}
+
+QTEST_GUILESS_MAIN(PasteJobTest)
@@ -22,14 +22,59 @@
 
 // KDE
 #include <qtest.h>
+#include <QDir>
 #include <QFileInfo>
+#include <QStandardPaths>
+#include <QTemporaryDir>
 
 // Konsole
 #include "../Profile.h"
+#include "../ProfileManager.h"
+#include "../ProfileReader.h"
 #include "../ProfileWriter.h"
 
 using namespace Konsole;
 
+namespace {
+// number of profiles read by benchmarkReadProfiles(), as many as a
+// user with a profile per host or project might have
+const int PROFILE_COUNT = 200;
+
+bool writeProfileFile(const QString &path, const QString &name)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write("[General]\n"
+               "Name=" + name.toUtf8() + "\n"
+               "Parent=FALLBACK/\n"
+               "Command=/bin/bash -l\n"
+               "Directory=/tmp\n"
+               "Icon=utilities-terminal\n"
+               "StartInCurrentSessionDir=false\n"
+               "\n"
+               "[Appearance]\n"
+               "ColorScheme=DarkPastels\n"
+               "AntiAliasFonts=true\n"
+               "\n"
+               "[Scrolling]\n"
+               "HistoryMode=2\n"
+               "HistorySize=5000\n"
+               "\n"
+               "[Terminal Features]\n"
+               "BlinkingCursorEnabled=true\n"
+               "UrlHintsModifiers=67108864\n");
+    return true;
+}
+}
+
+void ProfileTest::initTestCase()
+{
+    // keep the profile cache out of the user's cache directory
+    QStandardPaths::setTestModeEnabled(true);
+}
+
 void ProfileTest::testProfile()
 {
     // create a new profile
@@ -239,4 +284,136 @@ void ProfileTest::testFallbackProfile()
     delete fallback;
 }
 
+void ProfileTest::testPropertyTypes()
+{
+    Profile::Ptr profile(new Profile);
+    QVERIFY(profile->isEmpty());
+
+    // values given as text, as by ProfileCommandParser, are stored with
+    // the type of the property
+    profile->setProperty(Profile::HistorySize, QStringLiteral("5000"));
+    profile->setProperty(Profile::BlinkingCursorEnabled, QStringLiteral("true"));
+    QCOMPARE(profile->property<QVariant>(Profile::HistorySize), QVariant(5000));
+    QCOMPARE(profile->property<QVariant>(Profile::BlinkingCursorEnabled), QVariant(true));
+
+    // values which cannot be converted are kept
+    profile->setProperty(Profile::TerminalColumns, QStringLiteral("wide"));
+    QCOMPARE(profile->property<QVariant>(Profile::TerminalColumns), QVariant(QStringLiteral("wide")));
+
+    QVERIFY(!profile->isEmpty());
+    QCOMPARE(profile->setProperties().count(), 3);
+    QVERIFY(profile->setProperties().contains(Profile::HistorySize));
+    QVERIFY(!profile->isPropertySet(Profile::Icon));
+}
+
+void ProfileTest::testChangedProperties()
+{
+    ProfileManager *manager = ProfileManager::instance();
+    Profile::Ptr profile(new Profile(manager->fallbackProfile()));
+    profile->setProperty(Profile::Name, QStringLiteral("Changed"));
+
+    QList<QSet<Profile::Property> > notifications;
+    const QMetaObject::Connection connection =
+        connect(manager, &ProfileManager::profilePropertiesChanged,
+                [&](Profile::Ptr changed, const QSet<Profile::Property> &properties) {
+                    if (changed == profile) {
+                        notifications.append(properties);
+                    }
+                });
+
+    // only properties which get a new value are reported
+    QHash<Profile::Property, QVariant> changes;
+    changes.insert(Profile::HistorySize, profile->historySize());
+    changes.insert(Profile::Icon, QStringLiteral("changed-icon"));
+    manager->changeProfile(profile, changes, false);
+    QCOMPARE(notifications.count(), 1);
+    QCOMPARE(notifications.first(), QSet<Profile::Property>() << Profile::Icon);
+
+    notifications.clear();
+    manager->changeProfile(profile, changes, false);
+    QVERIFY(notifications.isEmpty());
+
+    // key bindings of the same name may have been edited
+    changes.clear();
+    changes.insert(Profile::KeyBindings, profile->keyBindings());
+    manager->changeProfile(profile, changes, false);
+    QCOMPARE(notifications.count(), 1);
+    QCOMPARE(notifications.first(), QSet<Profile::Property>() << Profile::KeyBindings);
+
+    disconnect(connection);
+}
+
+void ProfileTest::testProfileCache()
+{
+    QTemporaryDir dir;
+    const QString path = dir.path() + QStringLiteral("/Cached.profile");
+    QVERIFY(writeProfileFile(path, QStringLiteral("Cached")));
+
+    // the first reader parses the file, the second one uses the cache
+    ProfileReader parser;
+    Profile::Ptr parsed(new Profile);
+    QString parsedParent;
+    QVERIFY(parser.readProfile(path, parsed, parsedParent));
+
+    ProfileReader reader;
+    Profile::Ptr cached(new Profile);
+    QString cachedParent;
+    QVERIFY(reader.readProfile(path, cached, cachedParent));
+
+    QCOMPARE(cachedParent, QStringLiteral("FALLBACK/"));
+    QCOMPARE(cachedParent, parsedParent);
+    QCOMPARE(cached->setProperties(), parsed->setProperties());
+    QCOMPARE(cached->name(), QStringLiteral("Cached"));
+    QCOMPARE(cached->command(), QStringLiteral("/bin/bash"));
+    QCOMPARE(cached->arguments(), QStringList() << QStringLiteral("/bin/bash") << QStringLiteral("-l"));
+    QCOMPARE(cached->historySize(), 5000);
+    QVERIFY(cached->blinkingCursorEnabled());
+
+    // a changed file is parsed again
+    QVERIFY(writeProfileFile(path, QStringLiteral("Changed Name")));
+    Profile::Ptr changed(new Profile);
+    QString changedParent;
+    QVERIFY(reader.readProfile(path, changed, changedParent));
+    QCOMPARE(changed->name(), QStringLiteral("Changed Name"));
+}
+
+void ProfileTest::benchmarkReadProfiles_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    // without the cache, the time includes saving the cache, as when
+    // Konsole starts for the first time
+    QTest::newRow("parsed") << false;
+    QTest::newRow("cached") << true;
+}
+
+void ProfileTest::benchmarkReadProfiles()
+{
+    QFETCH(bool, cached);
+
+    QTemporaryDir dir;
+    QStringList paths;
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        const QString name = QStringLiteral("Profile %1").arg(i);
+        paths.append(dir.path() + QLatin1Char('/') + name + QStringLiteral(".profile"));
+        QVERIFY(writeProfileFile(paths.last(), name));
+    }
+
+    // reading all profiles is what populating the profile menus and
+    // the profile list of the settings dialog amounts to
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                             + QStringLiteral("/konsole/profiles");
+    ProfileReader reader;
+    QBENCHMARK {
+        if (!cached) {
+            QDir(cacheDir).removeRecursively();
+        }
+        foreach (const QString &path, paths) {
+            Profile::Ptr profile(new Profile);
+            QString parent;
+            reader.readProfile(path, profile, parent);
+        }
+    }
+}
+
 QTEST_GUILESS_MAIN(ProfileTest)
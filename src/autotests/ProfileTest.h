@@ -30,11 +30,17 @@ class ProfileTest : public QObject
     Q_OBJECT
 
 private Q_SLOTS:
+    void initTestCase();
     void testProfile();
     void testClone();
     void testProfileGroup();
     void testProfileFileNames();
     void testFallbackProfile();
+    void testPropertyTypes();
+    void testChangedProperties();
+    void testProfileCache();
+    void benchmarkReadProfiles_data();
+    void benchmarkReadProfiles();
 };
 
 }
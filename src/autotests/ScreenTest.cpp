@@ -0,0 +1,161 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "ScreenTest.h"
+
+// Qt
+#include <QTextStream>
+
+#include "qtest.h"
+
+// Konsole
+#include "../Screen.h"
+#include "../History.h"
+#include "../TerminalCharacterDecoder.h"
+
+using namespace Konsole;
+
+static void writeLines(Screen *screen, int count)
+{
+    for (int i = 0; i < count; i++) {
+        const QString text = QStringLiteral("line %1").arg(i);
+        foreach (const QChar &c, text) {
+            screen->displayCharacter(c.unicode());
+        }
+        screen->nextLine();
+    }
+}
+
+void ScreenTest::testSelectionInParts_data()
+{
+    QTest::addColumn<bool>("blockSelection");
+
+    QTest::newRow("stream") << false;
+    QTest::newRow("block") << true;
+}
+
+void ScreenTest::testSelectionInParts()
+{
+    QFETCH(bool, blockSelection);
+
+    Screen screen(5, 10);
+    screen.setScroll(CompactHistoryType(100));
+    writeLines(&screen, 20);
+
+    screen.setSelectionStart(2, 3, blockSelection);
+    screen.setSelectionEnd(4, 17);
+
+    const QString full = screen.selectedText(Screen::PreserveLineBreaks);
+    QVERIFY(!full.isEmpty());
+
+    QString parts;
+    QTextStream stream(&parts);
+    PlainTextDecoder decoder;
+    decoder.begin(&stream);
+    // the ranges may start before and end after the selection
+    for (int line = 0; line <= 20; line += 4) {
+        screen.writeSelectionToStream(&decoder, Screen::PreserveLineBreaks, line, line + 3);
+    }
+    decoder.end();
+
+    QCOMPARE(parts, full);
+}
+
+void ScreenTest::testSelectedTextMaxLines()
+{
+    Screen screen(5, 10);
+    screen.setScroll(CompactHistoryType(100));
+    writeLines(&screen, 20);
+
+    screen.setSelectionStart(0, 0, false);
+    screen.setSelectionEnd(9, 19);
+
+    const QString full = screen.selectedText(Screen::PreserveLineBreaks);
+    const QString start = screen.selectedText(Screen::PreserveLineBreaks, 2);
+    QCOMPARE(start.count(QLatin1Char('\n')), 2);
+    QVERIFY(full.startsWith(start));
+}
+
+void ScreenTest::testLongLines()
+{
+    Screen screen(2, 2000);
+    screen.setScroll(CompactHistoryType(10));
+
+    const QString a(1500, QLatin1Char('a'));
+    const QString b(1800, QLatin1Char('b'));
+    foreach (const QString &text, QStringList() << a << b << a) {
+        foreach (const QChar &c, text) {
+            screen.displayCharacter(c.unicode());
+        }
+        screen.nextLine();
+    }
+
+    // the first two lines are in the history, the third one on the screen
+    QCOMPARE(screen.getHistLines(), 2);
+
+    TerminalLine line;
+    screen.readLine(1, line);
+    QCOMPARE(line.cells.size(), b.length());
+    screen.readLine(2, line);
+    QVERIFY(line.cells.size() >= a.length());
+
+    QString text;
+    QTextStream stream(&text);
+    PlainTextDecoder decoder;
+    decoder.setTrailingWhitespace(false);
+    decoder.begin(&stream);
+    screen.writeLinesToStream(&decoder, 0, 2);
+    decoder.end();
+
+    QCOMPARE(text.split(QLatin1Char('\n')).mid(0, 3), QStringList() << a << b << a);
+}
+
+void ScreenTest::testSharedImage()
+{
+    Screen screen(5, 10);
+    screen.setScroll(CompactHistoryType(100));
+    writeLines(&screen, 20);
+
+    // windows showing the same lines share the snapshot
+    const ScreenImagePtr image = screen.sharedImage(3, 5);
+    QCOMPARE(image->startLine(), 3);
+    QCOMPARE(image->lines(), 5);
+    QCOMPARE(image->columns(), 10);
+    QCOMPARE(screen.sharedImage(3, 5), image);
+    QVERIFY(screen.sharedImage(4, 5) != image);
+    QVERIFY(screen.sharedImage(3, 4) != image);
+
+    // the text is decoded with a newline after each line
+    QCOMPARE(image->linePositions().count(), 5);
+    QCOMPARE(image->linePositions().at(1), 11);
+    QVERIFY(image->text().startsWith(QLatin1String("line 3    \nline 4    \n")));
+
+    // lines beyond the end of the screen are blank
+    const ScreenImagePtr tail = screen.sharedImage(screen.getHistLines() + 3, 5);
+    QCOMPARE(tail->characters()[4 * 10].character, quint32(' '));
+
+    // new snapshots are taken after the screen or the selection changed
+    screen.discardSharedImages();
+    const ScreenImagePtr changed = screen.sharedImage(3, 5);
+    QVERIFY(changed != image);
+
+    screen.setSelectionStart(0, 3, false);
+    QVERIFY(screen.sharedImage(3, 5) != changed);
+}
+
+QTEST_GUILESS_MAIN(ScreenTest)
@@ -0,0 +1,87 @@
+/*
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301  USA.
+*/
+
+// Own
+#include "SessionRecorderTest.h"
+
+// Qt
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include "qtest.h"
+
+// Konsole
+#include "../SessionRecorder.h"
+
+using namespace Konsole;
+
+void SessionRecorderTest::testRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.path() + QStringLiteral("/test.cast");
+
+    const QByteArray utf8Block("\033[1mbold\033[0m \xc3\xa9\r\n");
+    const QByteArray binaryBlock("\xff\xfe\x00\x01", 4);
+
+    SessionRecorder recorder;
+    QVERIFY(recorder.open(fileName, 80, 24));
+    recorder.recordData(utf8Block.constData(), utf8Block.length());
+    recorder.recordResize(100, 30);
+    recorder.recordData(binaryBlock.constData(), binaryBlock.length());
+    recorder.close();
+
+    SessionReplayer replayer;
+    QVERIFY(replayer.load(fileName));
+    QCOMPARE(replayer.size(), QSize(80, 24));
+    QCOMPARE(replayer.eventCount(), 3);
+
+    QList<QByteArray> received;
+    connect(&replayer, &Konsole::SessionReplayer::dataReady, [&received](const char *data, int length) {
+        received.append(QByteArray(data, length));
+    });
+    QSignalSpy resizeSpy(&replayer, &Konsole::SessionReplayer::resizeRequest);
+    QSignalSpy finishedSpy(&replayer, &Konsole::SessionReplayer::finished);
+
+    replayer.start(SessionReplayer::AsFastAsPossible);
+    QVERIFY(replayer.isRunning());
+    QVERIFY(finishedSpy.wait());
+    QVERIFY(!replayer.isRunning());
+
+    QCOMPARE(received.count(), 2);
+    QCOMPARE(received.at(0), utf8Block);
+    QCOMPARE(received.at(1), binaryBlock);
+    QCOMPARE(resizeSpy.count(), 1);
+    QCOMPARE(resizeSpy.at(0).at(0).toSize(), QSize(100, 30));
+}
+
+void SessionRecorderTest::testInvalidFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    SessionReplayer replayer;
+    QVERIFY(!replayer.load(dir.path() + QStringLiteral("/missing.cast")));
+
+    QFile file(dir.path() + QStringLiteral("/invalid.cast"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("not a recording\n");
+    file.close();
+    QVERIFY(!replayer.load(file.fileName()));
+}
+
+QTEST_GUILESS_MAIN(SessionRecorderTest)
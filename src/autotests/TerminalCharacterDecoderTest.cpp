@@ -33,6 +33,8 @@
 
 using namespace Konsole;
 
+Q_DECLARE_METATYPE(Konsole::CharacterColor)
+
 Character* TerminalCharacterDecoderTest::convertToCharacter(QString text, QVector<RenditionFlags> renditions)
 {
     auto charResult = new Character[text.size()];
@@ -120,4 +122,83 @@ void TerminalCharacterDecoderTest::testHTMLDecoder()
     delete decoder;
 }
 
+void TerminalCharacterDecoderTest::testHTMLDecoderStyleClasses()
+{
+    const CharacterColor red(COLOR_SPACE_SYSTEM, 1);
+    const CharacterColor back(COLOR_SPACE_DEFAULT, DEFAULT_BACK_COLOR);
+    const Character line[] = {
+        Character('a', red, back), Character('b', red, back), Character('c')
+    };
+
+    HTMLDecoder decoder;
+    decoder.setStyleClasses(true);
+    QString outputString;
+    QTextStream outputStream(&outputString);
+    decoder.begin(&outputStream);
+    decoder.decodeLine(line, 3, LINE_DEFAULT);
+    decoder.decodeLine(line, 3, LINE_DEFAULT);
+    decoder.end();
+
+    // each appearance is described once and then referred to by its class
+    const QString firstLine = QStringLiteral(R"(<style>.c0{color:#b21818;background-color:#ffffff;}</style><span class="c0">ab</span>)"
+                                             R"(<style>.c1{color:#000000;background-color:#ffffff;}</style><span class="c1">c</span><br>)");
+    const QString secondLine = QStringLiteral(R"(<span class="c0">ab</span><span class="c1">c</span><br>)");
+    QCOMPARE(outputString, QStringLiteral(R"(<span style="font-family:monospace">)") + firstLine + secondLine + QStringLiteral("</span>"));
+}
+
+void TerminalCharacterDecoderTest::testANSIDecoder_data()
+{
+    QTest::addColumn<CharacterColor>("foreColor");
+    QTest::addColumn<CharacterColor>("backColor");
+    QTest::addColumn<RenditionFlags>("rendition");
+    QTest::addColumn<QString>("result");
+
+    const CharacterColor defaultFore(COLOR_SPACE_DEFAULT, DEFAULT_FORE_COLOR);
+    const CharacterColor defaultBack(COLOR_SPACE_DEFAULT, DEFAULT_BACK_COLOR);
+    CharacterColor intenseRed(COLOR_SPACE_SYSTEM, 1);
+    intenseRed.setIntensive();
+
+    QTest::newRow("default") << defaultFore << defaultBack << DEFAULT_RENDITION << "ab\nc";
+    QTest::newRow("bold and underline") << defaultFore << defaultBack << RenditionFlags(RE_BOLD | RE_UNDERLINE)
+                                        << "\033[0;1;4mab\033[0m\nc";
+    QTest::newRow("system colors") << CharacterColor(COLOR_SPACE_SYSTEM, 1) << CharacterColor(COLOR_SPACE_SYSTEM, 4)
+                                   << DEFAULT_RENDITION << "\033[0;31;44mab\033[0m\nc";
+    QTest::newRow("intense color") << intenseRed << defaultBack << DEFAULT_RENDITION << "\033[0;91mab\033[0m\nc";
+    QTest::newRow("intense color of bold text") << intenseRed << defaultBack << RE_BOLD << "\033[0;1;31mab\033[0m\nc";
+    QTest::newRow("intense color of bold faint text") << intenseRed << defaultBack << RenditionFlags(RE_BOLD | RE_FAINT)
+                                                      << "\033[0;1;2;91mab\033[0m\nc";
+    QTest::newRow("intense background of bold text") << defaultFore << intenseRed << RE_BOLD
+                                                     << "\033[0;1;101mab\033[0m\nc";
+    QTest::newRow("reverse default colors") << defaultBack << defaultFore << RE_REVERSE << "\033[0;7mab\033[0m\nc";
+    QTest::newRow("reverse color") << defaultBack << CharacterColor(COLOR_SPACE_SYSTEM, 1) << RE_REVERSE
+                                   << "\033[0;7;31mab\033[0m\nc";
+    QTest::newRow("256 colors") << CharacterColor(COLOR_SPACE_256, 208) << CharacterColor(COLOR_SPACE_256, 17)
+                                << DEFAULT_RENDITION << "\033[0;38;5;208;48;5;17mab\033[0m\nc";
+    QTest::newRow("rgb colors") << CharacterColor(COLOR_SPACE_RGB, 0x102030) << defaultBack
+                                << DEFAULT_RENDITION << "\033[0;38;2;16;32;48mab\033[0m\nc";
+}
+
+void TerminalCharacterDecoderTest::testANSIDecoder()
+{
+    QFETCH(CharacterColor, foreColor);
+    QFETCH(CharacterColor, backColor);
+    QFETCH(RenditionFlags, rendition);
+    QFETCH(QString, result);
+
+    const Character line[] = {
+        Character('a', foreColor, backColor, rendition),
+        Character('b', foreColor, backColor, rendition),
+        Character('\n'),
+        Character('c')
+    };
+
+    ANSIDecoder decoder;
+    QString outputString;
+    QTextStream outputStream(&outputString);
+    decoder.begin(&outputStream);
+    decoder.decodeLine(line, 4, LINE_DEFAULT);
+    decoder.end();
+    QCOMPARE(outputString, result);
+}
+
 QTEST_GUILESS_MAIN(TerminalCharacterDecoderTest)
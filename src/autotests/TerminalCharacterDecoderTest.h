@@ -38,6 +38,9 @@ private Q_SLOTS:
     void testPlainTextDecoder_data();
     void testHTMLDecoder();
     void testHTMLDecoder_data();
+    void testHTMLDecoderStyleClasses();
+    void testANSIDecoder();
+    void testANSIDecoder_data();
 };
 
 }
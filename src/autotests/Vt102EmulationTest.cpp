@@ -22,6 +22,9 @@
 
 #include "qtest.h"
 
+// Konsole
+#include "../Vt102Emulation.h"
+
 // The below is to verify the old #defines match the new constexprs
 // Just copy/paste for now from Vt102Emulation.cpp
 #define TY_CONSTRUCT(T,A,N) ( ((((int)(N)) & 0xffff) << 16) | ((((int)(A)) & 0xff) << 8) | (((int)(T)) & 0xff) )
@@ -112,4 +115,71 @@ void Vt102EmulationTest::testTokenFunctions()
 
 }
 
+void Vt102EmulationTest::testAlternateScreenResize()
+{
+    Vt102Emulation emulation;
+    emulation.setImageSize(24, 80);
+    QCOMPARE(emulation.imageSize(), QSize(80, 24));
+
+    // resize while the alternate screen is active
+    const QByteArray enterAlternateScreen("\033[?1049h");
+    emulation.receiveData(enterAlternateScreen.constData(), enterAlternateScreen.length());
+    emulation.setImageSize(30, 100);
+    QCOMPARE(emulation.imageSize(), QSize(100, 30));
+
+    // the primary screen gets the new size when it is shown again
+    const QByteArray leaveAlternateScreen("\033[?1049l");
+    emulation.receiveData(leaveAlternateScreen.constData(), leaveAlternateScreen.length());
+    QCOMPARE(emulation.imageSize(), QSize(100, 30));
+
+    // and so does the alternate screen
+    emulation.setImageSize(20, 60);
+    emulation.receiveData(enterAlternateScreen.constData(), enterAlternateScreen.length());
+    QCOMPARE(emulation.imageSize(), QSize(60, 20));
+}
+
+void Vt102EmulationTest::testMouseMotionCoalescing()
+{
+    Vt102Emulation emulation;
+    QList<QByteArray> sent;
+    connect(&emulation, &Emulation::sendData, this, [&sent](const QByteArray &data) {
+        sent.append(data);
+    });
+
+    const QByteArray anyEventMouse("\033[?1003h\033[?1006h");
+    emulation.receiveData(anyEventMouse.constData(), anyEventMouse.length());
+
+    emulation.sendMouseEvent(0, 5, 5, 0);
+    QCOMPARE(sent.count(), 1);
+    QCOMPARE(sent.last(), QByteArray("\033[<0;5;5M"));
+
+    // motion within the cell of the press is not reported
+    emulation.sendMouseEvent(0, 5, 5, 1);
+    QCOMPARE(sent.count(), 1);
+
+    // the first motion to another cell is reported right away,
+    // the motion following it within the frame is held back
+    emulation.sendMouseEvent(0, 6, 5, 1);
+    QCOMPARE(sent.count(), 2);
+    QCOMPARE(sent.last(), QByteArray("\033[<32;6;5M"));
+    emulation.sendMouseEvent(0, 7, 5, 1);
+    emulation.sendMouseEvent(0, 8, 5, 1);
+    emulation.sendMouseEvent(0, 8, 5, 1);
+    QCOMPARE(sent.count(), 2);
+
+    // a release is reported right away, after the latest motion
+    emulation.sendMouseEvent(0, 9, 5, 2);
+    QCOMPARE(sent.count(), 4);
+    QCOMPARE(sent.at(2), QByteArray("\033[<32;8;5M"));
+    QCOMPARE(sent.at(3), QByteArray("\033[<0;9;5m"));
+    QCOMPARE(emulation.suppressedMouseEvents(), quint64(3));
+
+    // held back motion is reported once the frame has passed
+    emulation.sendMouseEvent(0, 10, 5, 1);
+    emulation.sendMouseEvent(0, 11, 5, 1);
+    QCOMPARE(sent.count(), 5);
+    QTRY_COMPARE(sent.count(), 6);
+    QCOMPARE(sent.last(), QByteArray("\033[<32;11;5M"));
+}
+
 QTEST_GUILESS_MAIN(Vt102EmulationTest)
@@ -31,6 +31,8 @@ class Vt102EmulationTest : public QObject
 
 private Q_SLOTS:
     void testTokenFunctions();
+    void testAlternateScreenResize();
+    void testMouseMotionCoalescing();
 
 private:
 };
@@ -10,3 +10,6 @@
 
 /* If defined, remove public access to dbus sendInput/runCommand */
 #cmakedefine REMOVE_SENDTEXT_RUNCOMMAND_DBUS_METHODS
+
+/* Set to 1 to compile in the output pipeline trace points */
+#cmakedefine01 KONSOLE_ENABLE_TRACING
@@ -22,6 +22,7 @@
 #include "MainWindow.h"
 #include "config-konsole.h" //krazy:exclude=includes
 #include "KonsoleSettings.h"
+#include "StartupTrace.h"
 
 // OS specific
 #include <qplatformdefs.h>
@@ -38,6 +39,7 @@
 #include <kdbusservice.h>
 
 using Konsole::Application;
+using Konsole::StartupTrace;
 
 // fill the KAboutData structure with information about contributors to Konsole.
 void fillAboutData(KAboutData &aboutData);
@@ -65,6 +67,8 @@ void deleteQApplication()
 // ***
 extern "C" int Q_DECL_EXPORT kdemain(int argc, char *argv[])
 {
+    StartupTrace::start();
+
     // Check if any of the arguments makes it impossible to re-use an existing process.
     // We need to do this manually and before creating a QApplication, because
     // QApplication takes/removes the Qt specific arguments that are incompatible.
@@ -85,6 +89,7 @@ extern "C" int Q_DECL_EXPORT kdemain(int argc, char *argv[])
 #endif
 
     auto app = new QApplication(argc, argv);
+    StartupTrace::phaseFinished("QApplication");
 
 #if defined(Q_OS_LINUX) && (QT_VERSION < QT_VERSION_CHECK(5, 11, 2))
     if (qtUseGLibOld.isNull()) {
@@ -137,6 +142,8 @@ extern "C" int Q_DECL_EXPORT kdemain(int argc, char *argv[])
 
     parser->process(args);
     about.processCommandLine(parser.data());
+    StartupTrace::setEnabled(parser->isSet(QStringLiteral("startup-trace")));
+    StartupTrace::phaseFinished("command line");
 
     // Enable user to force multiple instances, unless a new tab is requested
     if (!Konsole::KonsoleSettings::useSingleInstance()
@@ -150,6 +157,7 @@ extern "C" int Q_DECL_EXPORT kdemain(int argc, char *argv[])
     KDBusService dbusService(startupOption | KDBusService::NoExitOnFailure);
 
     needToDeleteQApplication = false;
+    StartupTrace::phaseFinished("D-Bus service");
 
     Kdelibs4ConfigMigrator migrate(QStringLiteral("konsole"));
     migrate.setConfigFiles(QStringList() << QStringLiteral("konsolerc")
@@ -180,6 +188,8 @@ extern "C" int Q_DECL_EXPORT kdemain(int argc, char *argv[])
         }
     }
 
+    StartupTrace::phaseFinished("configuration migration");
+
     // If we reach this location, there was no existing copy of Konsole
     // running, so create a new instance.
     Application konsoleApp(parser, customCommand);
@@ -264,6 +274,11 @@ bool shouldUseNewProcess(int argc, char *argv[])
         return true;
     }
 
+    // the startup of an existing process can not be traced
+    if (arguments.contains(QStringLiteral("--startup-trace"))) {
+        return true;
+    }
+
     // the only way to create new tab is to reuse existing Konsole process.
     if (arguments.contains(QStringLiteral("--new-tab"))) {
         return false;